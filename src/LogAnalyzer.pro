@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += core gui svg sql printsupport network
+QT       += core gui svg sql printsupport network concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -20,12 +20,42 @@ SOURCES += main.cpp \
         mainwindow.cpp \
         qtexteditsearchwidget.cpp \
         libraries/simplecrypt/simplecrypt.cpp \
-        libraries/miniz/tinfl.c \
+        libraries/miniz/miniz.c \
         services/cryptoservice.cpp \
         services/ezpublishservice.cpp \
         utils/misc.cpp \
+        utils/gzip.cpp \
+        utils/zip.cpp \
+        utils/timestamp.cpp \
+        utils/logrotation.cpp \
+        utils/logformat.cpp \
+        utils/jsonlines.cpp \
+        utils/tokennormalizer.cpp \
+        helpers/gzipindex.cpp \
+        helpers/logstore.cpp \
+        helpers/timeindex.cpp \
+        helpers/logmerger.cpp \
+        helpers/logtable.cpp \
+        helpers/logtablemodel.cpp \
+        helpers/filterplan.cpp \
+        helpers/frequencysketch.cpp \
+        helpers/quantilesketch.cpp \
+        helpers/reportcube.cpp \
+        helpers/templateminer.cpp \
+        helpers/timehistogram.cpp \
+        helpers/duplicateindex.cpp \
+        helpers/hashjoin.cpp \
+        helpers/logcorrelator.cpp \
+        helpers/reportresult.cpp \
+        helpers/reportresultmodel.cpp \
+        helpers/documentprinter.cpp \
+        helpers/logfileset.cpp \
         services/databaseservice.cpp \
+        services/logloaderservice.cpp \
+        services/logfilterservice.cpp \
         entities/logfilesource.cpp \
+        entities/cachedlogfile.cpp \
+        entities/logfileindex.cpp \
         dialogs/filedialog.cpp \
         dialogs/settingsdialog.cpp
 
@@ -35,8 +65,39 @@ HEADERS  += mainwindow.h \
         services/cryptoservice.h \
         services/ezpublishservice.h \
         utils/misc.h \
+        utils/gzip.h \
+        utils/zip.h \
+        utils/timestamp.h \
+        utils/logrotation.h \
+        utils/logformat.h \
+        utils/jsonlines.h \
+        utils/tokennormalizer.h \
+        libraries/miniz/miniz.h \
+        helpers/gzipindex.h \
+        helpers/logstore.h \
+        helpers/timeindex.h \
+        helpers/logmerger.h \
+        helpers/logtable.h \
+        helpers/logtablemodel.h \
+        helpers/filterplan.h \
+        helpers/frequencysketch.h \
+        helpers/quantilesketch.h \
+        helpers/reportcube.h \
+        helpers/templateminer.h \
+        helpers/timehistogram.h \
+        helpers/duplicateindex.h \
+        helpers/hashjoin.h \
+        helpers/logcorrelator.h \
+        helpers/reportresult.h \
+        helpers/reportresultmodel.h \
+        helpers/documentprinter.h \
+        helpers/logfileset.h \
         services/databaseservice.h \
+        services/logloaderservice.h \
+        services/logfilterservice.h \
         entities/logfilesource.h \
+        entities/cachedlogfile.h \
+        entities/logfileindex.h \
         dialogs/filedialog.h \
         dialogs/settingsdialog.h
 
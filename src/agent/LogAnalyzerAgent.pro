@@ -0,0 +1,42 @@
+#-------------------------------------------------
+#
+# LogAnalyzer agent, serves log files to LogAnalyzer
+#
+#-------------------------------------------------
+
+QT       += core network concurrent
+QT       -= gui
+
+TARGET = LogAnalyzerAgent
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+INCLUDEPATH += ..
+
+SOURCES += main.cpp \
+        agentserver.cpp \
+        ../helpers/gzipindex.cpp \
+        ../utils/gzip.cpp \
+        ../libraries/miniz/miniz.c
+
+HEADERS  += agentserver.h \
+        ../version.h \
+        ../helpers/gzipindex.h \
+        ../utils/gzip.h \
+        ../libraries/miniz/miniz.h
+
+unix {
+
+  isEmpty(PREFIX) {
+    PREFIX = /usr
+  }
+
+  isEmpty(BINDIR) {
+    BINDIR = $$PREFIX/bin
+  }
+
+  INSTALLS += target
+
+  target.path = $$INSTROOT$$BINDIR
+}
@@ -0,0 +1,514 @@
+#include "agentserver.h"
+#include <QDebug>
+#include <QUrl>
+#include <QUrlQuery>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QRegularExpression>
+#include <QCryptographicHash>
+#include <stdexcept>
+#include <helpers/gzipindex.h>
+
+// we don't accept requests with headers that are larger than that
+#define MAX_REQUEST_SIZE (1024 * 1024)
+
+// amount of data that is read at once when a log file is filtered or the
+// end of a line is searched
+#define AGENT_READ_CHUNK_SIZE (16 * 1024 * 1024)
+#define AGENT_LINE_SEARCH_CHUNK_SIZE (64 * 1024)
+
+namespace {
+    /**
+     * Compares two values in a time that doesn't depend on where they
+     * differ, the hashes are compared, so their length isn't revealed either
+     */
+    bool constantTimeEquals(const QByteArray &value,
+                            const QByteArray &other) {
+        QByteArray hash = QCryptographicHash::hash(
+                value, QCryptographicHash::Sha256);
+        QByteArray otherHash = QCryptographicHash::hash(
+                other, QCryptographicHash::Sha256);
+        char difference = 0;
+
+        for (int i = 0; i < hash.size(); i++) {
+            difference |= hash.at(i) ^ otherHash.at(i);
+        }
+
+        return difference == 0;
+    }
+}
+
+const QString AgentServer::rootPath =
+        "/ezjscore/call/loganalyzer::";
+
+AgentServer::AgentServer(QString logPath, QString username,
+                         QString password, QObject *parent)
+        : QTcpServer(parent) {
+    logFileListPath = rootPath + "get_log_file_list";
+    logFileDownloadPath = rootPath + "get_log_file";
+    connectionTestPath = rootPath + "connection_test";
+
+    _logDir = QDir(logPath);
+    _username = username;
+    _password = password;
+
+    QObject::connect(this, SIGNAL(newConnection()),
+                     this, SLOT(slotNewConnection()));
+}
+
+void AgentServer::slotNewConnection() {
+    while (hasPendingConnections()) {
+        QTcpSocket *socket = nextPendingConnection();
+
+        QObject::connect(socket, SIGNAL(readyRead()),
+                         this, SLOT(slotReadyRead()));
+        QObject::connect(socket, SIGNAL(disconnected()),
+                         this, SLOT(slotDisconnected()));
+
+        _requestBuffers.insert(socket, QByteArray());
+    }
+}
+
+void AgentServer::slotDisconnected() {
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+
+    if (socket == NULL) {
+        return;
+    }
+
+    _requestBuffers.remove(socket);
+    socket->deleteLater();
+}
+
+/**
+ * Collects the request data until the header is complete
+ */
+void AgentServer::slotReadyRead() {
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+
+    if (socket == NULL || !_requestBuffers.contains(socket)) {
+        return;
+    }
+
+    QByteArray &buffer = _requestBuffers[socket];
+    buffer += socket->readAll();
+
+    int headerEnd = buffer.indexOf("\r\n\r\n");
+
+    if (headerEnd == -1) {
+        if (buffer.size() > MAX_REQUEST_SIZE) {
+            stopReading(socket);
+            sendResponse(socket, 413, "Request too large");
+        }
+
+        return;
+    }
+
+    QByteArray request = buffer.left(headerEnd);
+
+    // we only handle one request per connection
+    stopReading(socket);
+    handleRequest(socket, request);
+}
+
+/**
+ * Forgets the request data of a socket and ignores the data that is still
+ * sent
+ */
+void AgentServer::stopReading(QTcpSocket *socket) {
+    _requestBuffers.remove(socket);
+    QObject::disconnect(socket, SIGNAL(readyRead()),
+                        this, SLOT(slotReadyRead()));
+}
+
+void AgentServer::handleRequest(QTcpSocket *socket,
+                                const QByteArray &request) {
+    QList<QByteArray> lines = request.split('\n');
+    QList<QByteArray> requestLine = lines.takeFirst().trimmed().split(' ');
+
+    if (requestLine.count() < 2 || requestLine.at(0) != "GET") {
+        sendResponse(socket, 405, "Only GET requests are supported");
+        return;
+    }
+
+    QByteArray authorizationHeader;
+
+    Q_FOREACH(QByteArray line, lines) {
+            int colon = line.indexOf(':');
+
+            if (colon > 0 && line.left(colon).trimmed().toLower() ==
+                                     "authorization") {
+                authorizationHeader = line.mid(colon + 1).trimmed();
+            }
+        }
+
+    if (!isAuthorized(authorizationHeader)) {
+        QHash<QByteArray, QByteArray> headers;
+        headers.insert("WWW-Authenticate", "Basic realm=\"LogAnalyzer\"");
+        sendResponse(socket, 401, "Unauthorized", headers);
+        return;
+    }
+
+    QUrl url(QString::fromUtf8(requestLine.at(1)));
+    QUrlQuery query(url);
+    QString path = url.path();
+
+    qDebug() << __func__ << " - 'path': " << path;
+
+    if (path.endsWith(connectionTestPath)) {
+        sendResponse(socket, 200, "successfully connected");
+    } else if (path.endsWith(logFileListPath)) {
+        QHash<QByteArray, QByteArray> headers;
+        headers.insert("Content-Type", "application/json");
+        sendResponse(socket, 200, logFileList(), headers);
+    } else if (path.endsWith(logFileDownloadPath)) {
+        sendLogFile(socket,
+                    query.queryItemValue("file_name",
+                                         QUrl::FullyDecoded),
+                    query.allQueryItemValues("ignore_pattern",
+                                             QUrl::FullyDecoded),
+                    query.queryItemValue("offset").toLongLong(),
+                    query.queryItemValue("length").toLongLong());
+    } else {
+        // use the same error message as the ezjscore router
+        sendResponse(socket, 404, "Not a valid ezjscServerRouter argument: "
+                                  + path.toUtf8());
+    }
+}
+
+/**
+ * Checks the basic authentication header if a username was set
+ */
+bool AgentServer::isAuthorized(const QByteArray &authorizationHeader) {
+    if (_username.isEmpty()) {
+        return true;
+    }
+
+    QByteArray expected = "Basic " +
+            QString(_username + ":" + _password).toLocal8Bit().toBase64();
+
+    return constantTimeEquals(authorizationHeader, expected);
+}
+
+void AgentServer::sendResponse(QTcpSocket *socket, int statusCode,
+                               const QByteArray &body,
+                               QHash<QByteArray, QByteArray> headers) {
+    QByteArray statusText;
+
+    switch (statusCode) {
+        case 200:
+            statusText = "OK";
+            break;
+        case 401:
+            statusText = "Unauthorized";
+            break;
+        case 404:
+            statusText = "Not Found";
+            break;
+        case 405:
+            statusText = "Method Not Allowed";
+            break;
+        case 413:
+            statusText = "Payload Too Large";
+            break;
+        default:
+            statusText = "Internal Server Error";
+    }
+
+    if (!headers.contains("Content-Type")) {
+        headers.insert("Content-Type", "text/plain; charset=utf-8");
+    }
+
+    headers.insert("Content-Length", QByteArray::number(body.size()));
+    headers.insert("Connection", "close");
+
+    QByteArray response = "HTTP/1.1 " + QByteArray::number(statusCode) + " "
+                          + statusText + "\r\n";
+
+    QHashIterator<QByteArray, QByteArray> i(headers);
+    while (i.hasNext()) {
+        i.next();
+        response += i.key() + ": " + i.value() + "\r\n";
+    }
+
+    response += "\r\n";
+
+    socket->write(response);
+    socket->write(body);
+
+    // the socket will be closed after all pending data was written
+    socket->disconnectFromHost();
+}
+
+/**
+ * Returns the names of all log files in the log directory
+ */
+QStringList AgentServer::logFileNames() {
+    QStringList filters;
+    filters << "*.log*";
+
+    return _logDir.entryList(filters, QDir::Files, QDir::Name);
+}
+
+/**
+ * Returns the json encoded list of log files like the eZ Publish extension
+ */
+QByteArray AgentServer::logFileList() {
+    QJsonArray list;
+
+    Q_FOREACH(QString fileName, logFileNames()) {
+            QFileInfo fileInfo(_logDir.absoluteFilePath(fileName));
+
+            QJsonObject obj;
+            obj.insert("file_name", fileName);
+            obj.insert("file_size", fileInfo.size());
+            obj.insert("file_mtime",
+                       static_cast<qint64>(fileInfo.lastModified()
+                                                   .toTime_t()));
+            list.append(obj);
+        }
+
+    return QJsonDocument(list).toJson(QJsonDocument::Compact);
+}
+
+/**
+ * Sends a log file, optionally only a line aligned range of it with all lines
+ * matching one of the ignore patterns removed
+ *
+ * Ranges of gzipped files are decompressed from the nearest checkpoint of
+ * their index, which is built the first time a range is requested. Files
+ * that are filtered without range are read in chunks.
+ */
+void AgentServer::sendLogFile(QTcpSocket *socket, QString fileName,
+                              QStringList ignorePatterns, qint64 offset,
+                              qint64 length) {
+    // only serve files from the listing, so no path can be injected
+    if (!logFileNames().contains(fileName)) {
+        sendResponse(socket, 404, "File not found");
+        return;
+    }
+
+    QString filePath = _logDir.absoluteFilePath(fileName);
+    QFile file(filePath);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << file.errorString();
+        sendResponse(socket, 500, file.errorString().toUtf8());
+        return;
+    }
+
+    bool hasRange = offset > 0 || length > 0;
+    bool isCompressed = fileName.endsWith(".gz");
+    QByteArray data;
+    QHash<QByteArray, QByteArray> headers;
+    headers.insert("X-FILE-NAME", fileName.toUtf8());
+
+    if (!hasRange && ignorePatterns.isEmpty()) {
+        // send the file like the eZ Publish extension does
+        data = file.readAll();
+        file.close();
+
+        headers.insert("X-FILE-SIZE", QByteArray::number(data.size()));
+        sendResponse(socket, 200, data, headers);
+        return;
+    }
+
+    int removedLineCount = 0;
+    QByteArray remainder;
+
+    // filters the complete lines of the data and keeps the incomplete last
+    // line for the next data
+    auto filterData = [&](const char *buffer, int size) {
+        remainder.append(buffer, size);
+        int end = remainder.lastIndexOf('\n') + 1;
+
+        if (end > 0) {
+            data += filterLines(remainder.left(end), ignorePatterns,
+                                &removedLineCount);
+            remainder.remove(0, end);
+        }
+    };
+
+    try {
+        if (hasRange) {
+            QByteArray range;
+
+            if (isCompressed) {
+                GzipIndex gzipIndex = GzipIndex::fetch(filePath);
+
+                if (!gzipIndex.isCurrent()) {
+                    gzipIndex = GzipIndex::build(filePath);
+                    gzipIndex.store();
+                }
+
+                range = readLineAlignedRange(
+                        [&gzipIndex](qint64 start, qint64 count) {
+                            return gzipIndex.read(start, count);
+                        },
+                        gzipIndex.getUncompressedSize(), offset, length);
+            } else {
+                range = readLineAlignedRange(
+                        [&file](qint64 start, qint64 count) {
+                            return file.seek(start) ?
+                                   file.read(count) : QByteArray();
+                        },
+                        file.size(), offset, length);
+            }
+
+            filterData(range.constData(), range.size());
+        } else if (isCompressed) {
+            GzipIndex::uncompressFile(filePath, filterData);
+        } else {
+            while (!file.atEnd()) {
+                QByteArray chunk = file.read(AGENT_READ_CHUNK_SIZE);
+
+                if (file.error() != QFileDevice::NoError) {
+                    throw std::runtime_error(
+                            file.errorString().toStdString());
+                }
+
+                filterData(chunk.constData(), chunk.size());
+            }
+        }
+    } catch (std::exception const &e) {
+        sendResponse(socket, 500, e.what());
+        return;
+    }
+
+    file.close();
+
+    // the last line doesn't need to end with a line break
+    if (!remainder.isEmpty()) {
+        data += filterLines(remainder, ignorePatterns, &removedLineCount);
+    }
+
+    // the client must not decompress the data again
+    if (isCompressed) {
+        headers.insert("X-FILE-DECOMPRESSED", "1");
+    }
+
+    headers.insert("X-REMOVED-LINE-COUNT",
+                   QByteArray::number(removedLineCount));
+    headers.insert("X-FILE-SIZE", QByteArray::number(data.size()));
+    sendResponse(socket, 200, data, headers);
+}
+
+/**
+ * Reads all lines that start in the byte range from offset to
+ * offset + length of a file with a size, the data of the file is read with
+ * a function
+ *
+ * A line that starts in the range is always returned completely, so that
+ * consecutive ranges return every line exactly once. A length of 0 reads
+ * until the end of the file.
+ */
+QByteArray AgentServer::readLineAlignedRange(RangeReader read, qint64 size,
+                                             qint64 offset,
+                                             qint64 length) {
+    qint64 start = offset;
+    qint64 end = length > 0 ? qMin(offset + length, size) : size;
+
+    // skip the line that started before the range
+    if (start > 0 && read(start - 1, 1) != "\n") {
+        start = nextLineStart(read, size, start);
+    }
+
+    if (start >= end) {
+        return QByteArray();
+    }
+
+    QByteArray data = read(start, end - start);
+
+    // complete the last line
+    if (!data.endsWith('\n') && end < size) {
+        data += read(end, nextLineStart(read, size, end) - end);
+    }
+
+    return data;
+}
+
+/**
+ * Returns the offset after the next line break from offset on or the size
+ * if there is none
+ */
+qint64 AgentServer::nextLineStart(RangeReader read, qint64 size,
+                                  qint64 offset) {
+    while (offset < size) {
+        QByteArray chunk = read(offset, AGENT_LINE_SEARCH_CHUNK_SIZE);
+        int index = chunk.indexOf('\n');
+
+        if (index != -1) {
+            return offset + index + 1;
+        }
+
+        if (chunk.isEmpty()) {
+            break;
+        }
+
+        offset += chunk.size();
+    }
+
+    return size;
+}
+
+/**
+ * Removes all lines that are matching one of the ignore patterns and all
+ * empty lines, like LogAnalyzer does when filtering the text, the removed
+ * lines are added to removedLineCount
+ */
+QByteArray AgentServer::filterLines(const QByteArray &data,
+                                    QStringList ignorePatterns,
+                                    int *removedLineCount) {
+    QList<QRegularExpression> expressions;
+
+    Q_FOREACH(QString pattern, ignorePatterns) {
+            QRegularExpression expression(pattern + "$");
+
+            if (!expression.isValid()) {
+                qWarning() << __func__ << " - 'invalid pattern': " << pattern;
+                continue;
+            }
+
+            expressions.append(expression);
+        }
+
+    QByteArray result;
+    result.reserve(data.size());
+    int start = 0;
+
+    while (start < data.size()) {
+        int end = data.indexOf('\n', start);
+
+        if (end == -1) {
+            end = data.size();
+        }
+
+        QString line = QString::fromUtf8(data.constData() + start,
+                                         end - start);
+
+        if (line.endsWith('\r')) {
+            line.chop(1);
+        }
+
+        bool ignore = line.isEmpty();
+
+        for (int i = 0; !ignore && i < expressions.count(); i++) {
+            ignore = expressions.at(i).match(line).hasMatch();
+        }
+
+        if (ignore) {
+            (*removedLineCount)++;
+        } else {
+            result.append(data.constData() + start, end - start);
+            result.append('\n');
+        }
+
+        start = end + 1;
+    }
+
+    return result;
+}
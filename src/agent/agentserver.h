@@ -0,0 +1,78 @@
+#pragma once
+
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QDir>
+#include <QHash>
+#include <QStringList>
+#include <functional>
+
+
+/**
+ * A small HTTP server that serves the log files of a directory with the same
+ * api as the `loganalyzer` eZ Publish extension
+ *
+ * Additionally the active ignore patterns (`ignore_pattern`) and a byte range
+ * (`offset` and `length`) can be passed to `get_log_file`, so that only the
+ * lines that survive the filtering are sent over the network. The ranges of
+ * gzipped files are offsets into the uncompressed data.
+ */
+class AgentServer : public QTcpServer {
+Q_OBJECT
+
+public:
+
+    explicit AgentServer(QString logPath, QString username = "",
+                         QString password = "", QObject *parent = 0);
+
+private:
+
+    static const QString rootPath;
+    QString logFileListPath;
+    QString logFileDownloadPath;
+    QString connectionTestPath;
+    QDir _logDir;
+    QString _username;
+    QString _password;
+    QHash<QTcpSocket *, QByteArray> _requestBuffers;
+
+    typedef std::function<QByteArray(qint64 offset, qint64 length)>
+            RangeReader;
+
+    void stopReading(QTcpSocket *socket);
+
+    void handleRequest(QTcpSocket *socket, const QByteArray &request);
+
+    bool isAuthorized(const QByteArray &authorizationHeader);
+
+    void sendResponse(QTcpSocket *socket, int statusCode,
+                      const QByteArray &body,
+                      QHash<QByteArray, QByteArray> headers =
+                              QHash<QByteArray, QByteArray>());
+
+    QStringList logFileNames();
+
+    QByteArray logFileList();
+
+    void sendLogFile(QTcpSocket *socket, QString fileName,
+                     QStringList ignorePatterns, qint64 offset,
+                     qint64 length);
+
+    static QByteArray readLineAlignedRange(RangeReader read, qint64 size,
+                                           qint64 offset, qint64 length);
+
+    static qint64 nextLineStart(RangeReader read, qint64 size,
+                                qint64 offset);
+
+    static QByteArray filterLines(const QByteArray &data,
+                                  QStringList ignorePatterns,
+                                  int *removedLineCount);
+
+private slots:
+
+    void slotNewConnection();
+
+    void slotReadyRead();
+
+    void slotDisconnected();
+};
@@ -0,0 +1,76 @@
+#include "agentserver.h"
+#include "version.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QHostAddress>
+#include <QDir>
+#include <QDebug>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QCoreApplication::setOrganizationDomain("PBE");
+    QCoreApplication::setOrganizationName("PBE");
+    QCoreApplication::setApplicationName("LogAnalyzerAgent");
+    QCoreApplication::setApplicationVersion(QString(VERSION));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+            "Serves the log files of a directory to LogAnalyzer and filters "
+            "them on the server side");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption pathOption(
+            QStringList() << "d" << "log-path",
+            "Directory with the log files to serve.", "path");
+    parser.addOption(pathOption);
+
+    QCommandLineOption addressOption(
+            QStringList() << "a" << "address",
+            "Address to listen on (default: 127.0.0.1).", "address",
+            "127.0.0.1");
+    parser.addOption(addressOption);
+
+    QCommandLineOption portOption(
+            QStringList() << "p" << "port",
+            "Port to listen on (default: 8080).", "port", "8080");
+    parser.addOption(portOption);
+
+    QCommandLineOption usernameOption(
+            QStringList() << "u" << "username",
+            "Username for the basic authentication.", "username");
+    parser.addOption(usernameOption);
+
+    QCommandLineOption passwordOption(
+            QStringList() << "password",
+            "Password for the basic authentication.", "password");
+    parser.addOption(passwordOption);
+
+    parser.process(a);
+
+    QString logPath = parser.value(pathOption);
+
+    if (logPath.isEmpty() || !QDir(logPath).exists()) {
+        qWarning() << "Please set an existing log directory with --log-path";
+        return 1;
+    }
+
+    AgentServer server(logPath, parser.value(usernameOption),
+                       parser.value(passwordOption));
+
+    QHostAddress address(parser.value(addressOption));
+    quint16 port = parser.value(portOption).toUShort();
+
+    if (!server.listen(address, port)) {
+        qWarning() << "Could not listen on" << address.toString() << port
+                   << ":" << server.errorString();
+        return 1;
+    }
+
+    qDebug() << "Serving log files from" << logPath << "on"
+             << address.toString() << port;
+
+    return a.exec();
+}
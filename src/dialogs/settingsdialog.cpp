@@ -246,6 +246,10 @@ void SettingsDialog::on_logFileSourceListWidget_currentItemChanged(
                 _selectedLogFileSource.getType() - 1);
         ui->logFileSourceAddDownloadedFilePrefixCheckBox->setChecked(
                 _selectedLogFileSource.getAddDownloadedFilePrefix());
+        ui->logFileSourceServerSideFilteringCheckBox->setChecked(
+                _selectedLogFileSource.getServerSideFiltering());
+        ui->logFileSourceCompressDownloadsCheckBox->setChecked(
+                _selectedLogFileSource.getCompressDownloads());
 
         const QSignalBlocker blocker(ui->logFileSourceActiveCheckBox);
         Q_UNUSED(blocker);
@@ -263,6 +267,18 @@ void SettingsDialog::on_logFileSourceAddDownloadedFilePrefixCheckBox_toggled(
     _selectedLogFileSource.store();
 }
 
+void SettingsDialog::on_logFileSourceServerSideFilteringCheckBox_toggled(
+        bool checked) {
+    _selectedLogFileSource.setServerSideFiltering(checked);
+    _selectedLogFileSource.store();
+}
+
+void SettingsDialog::on_logFileSourceCompressDownloadsCheckBox_toggled(
+        bool checked) {
+    _selectedLogFileSource.setCompressDownloads(checked);
+    _selectedLogFileSource.store();
+}
+
 /**
  * Starts a connection test to the eZ Publish server
  */
@@ -53,6 +53,10 @@ private slots:
 
     void on_logFileSourceAddDownloadedFilePrefixCheckBox_toggled(bool checked);
 
+    void on_logFileSourceServerSideFilteringCheckBox_toggled(bool checked);
+
+    void on_logFileSourceCompressDownloadsCheckBox_toggled(bool checked);
+
     void on_connectionTestButton_clicked();
 
     void on_saveDebugInfoButton_clicked();
@@ -0,0 +1,311 @@
+#include "cachedlogfile.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QSqlError>
+#include <QFileInfo>
+#include <QCryptographicHash>
+
+
+CachedLogFile::CachedLogFile() {
+    id = 0;
+    logFileSourceId = 0;
+    remotePath = "";
+    remoteSize = 0;
+    remoteMTime = 0;
+    filterHash = "";
+    contentHash = "";
+    localPath = "";
+}
+
+int CachedLogFile::getId() {
+    return this->id;
+}
+
+int CachedLogFile::getLogFileSourceId() {
+    return this->logFileSourceId;
+}
+
+QString CachedLogFile::getRemotePath() {
+    return this->remotePath;
+}
+
+qint64 CachedLogFile::getRemoteSize() {
+    return this->remoteSize;
+}
+
+uint CachedLogFile::getRemoteMTime() {
+    return this->remoteMTime;
+}
+
+QString CachedLogFile::getFilterHash() {
+    return this->filterHash;
+}
+
+QString CachedLogFile::getContentHash() {
+    return this->contentHash;
+}
+
+QString CachedLogFile::getLocalPath() {
+    return this->localPath;
+}
+
+QDateTime CachedLogFile::getCreated() {
+    return this->created;
+}
+
+void CachedLogFile::setLogFileSourceId(int id) {
+    this->logFileSourceId = id;
+}
+
+void CachedLogFile::setRemotePath(QString text) {
+    this->remotePath = text;
+}
+
+void CachedLogFile::setRemoteSize(qint64 size) {
+    this->remoteSize = size;
+}
+
+void CachedLogFile::setRemoteMTime(uint mTime) {
+    this->remoteMTime = mTime;
+}
+
+void CachedLogFile::setFilterHash(QString text) {
+    this->filterHash = text;
+}
+
+void CachedLogFile::setContentHash(QString text) {
+    this->contentHash = text;
+}
+
+void CachedLogFile::setLocalPath(QString text) {
+    this->localPath = text;
+}
+
+/**
+ * Returns the hash that is used to address the content of a log file
+ */
+QByteArray CachedLogFile::hashContent(const QByteArray &content) {
+    return QCryptographicHash::hash(content, QCryptographicHash::Sha1)
+            .toHex();
+}
+
+CachedLogFile CachedLogFile::fetch(int id) {
+    QSqlDatabase db = QSqlDatabase::database("disk");
+    QSqlQuery query(db);
+
+    CachedLogFile cachedLogFile;
+
+    query.prepare("SELECT * FROM downloadCache WHERE id = :id");
+    query.bindValue(":id", id);
+
+    if (!query.exec()) {
+        qWarning() << __func__ << ": " << query.lastError();
+    } else if (query.first()) {
+        cachedLogFile.fillFromQuery(query);
+    }
+
+    return cachedLogFile;
+}
+
+/**
+ * Fetches the cache entry of a remote file in the state it was downloaded
+ */
+CachedLogFile CachedLogFile::fetchByRemoteFile(
+        int logFileSourceId, QString remotePath, qint64 remoteSize,
+        uint remoteMTime, QString filterHash) {
+    QSqlDatabase db = QSqlDatabase::database("disk");
+    QSqlQuery query(db);
+
+    CachedLogFile cachedLogFile;
+
+    query.prepare("SELECT * FROM downloadCache WHERE "
+                          "log_file_source_id = :logFileSourceId AND "
+                          "remote_path = :remotePath AND "
+                          "remote_size = :remoteSize AND "
+                          "remote_mtime = :remoteMTime AND "
+                          "filter_hash = :filterHash");
+    query.bindValue(":logFileSourceId", logFileSourceId);
+    query.bindValue(":remotePath", remotePath);
+    query.bindValue(":remoteSize", remoteSize);
+    query.bindValue(":remoteMTime", remoteMTime);
+    query.bindValue(":filterHash", filterHash);
+
+    if (!query.exec()) {
+        qWarning() << __func__ << ": " << query.lastError();
+    } else if (query.first()) {
+        cachedLogFile.fillFromQuery(query);
+    }
+
+    return cachedLogFile;
+}
+
+/**
+ * Fetches the cache entries of the remote files of a log file source that
+ * were downloaded with a filter
+ */
+QList<CachedLogFile> CachedLogFile::fetchAllByLogFileSource(
+        int logFileSourceId, QString filterHash) {
+    QSqlDatabase db = QSqlDatabase::database("disk");
+    QSqlQuery query(db);
+
+    QList<CachedLogFile> cachedLogFileList;
+
+    query.prepare("SELECT * FROM downloadCache WHERE "
+                          "log_file_source_id = :logFileSourceId AND "
+                          "filter_hash = :filterHash");
+    query.bindValue(":logFileSourceId", logFileSourceId);
+    query.bindValue(":filterHash", filterHash);
+
+    if (!query.exec()) {
+        qWarning() << __func__ << ": " << query.lastError();
+    } else {
+        while (query.next()) {
+            cachedLogFileList.append(cachedLogFileFromQuery(query));
+        }
+    }
+
+    return cachedLogFileList;
+}
+
+/**
+ * Fetches a cache entry with a certain content whose local file still exists
+ */
+CachedLogFile CachedLogFile::fetchByContentHash(QString contentHash) {
+    QSqlDatabase db = QSqlDatabase::database("disk");
+    QSqlQuery query(db);
+
+    query.prepare("SELECT * FROM downloadCache WHERE "
+                          "content_hash = :contentHash ORDER BY id ASC");
+    query.bindValue(":contentHash", contentHash);
+
+    if (!query.exec()) {
+        qWarning() << __func__ << ": " << query.lastError();
+    } else {
+        while (query.next()) {
+            CachedLogFile cachedLogFile = cachedLogFileFromQuery(query);
+
+            if (cachedLogFile.localFileExists()) {
+                return cachedLogFile;
+            }
+        }
+    }
+
+    return CachedLogFile();
+}
+
+bool CachedLogFile::remove() {
+    QSqlDatabase db = QSqlDatabase::database("disk");
+    QSqlQuery query(db);
+
+    query.prepare("DELETE FROM downloadCache WHERE id = :id");
+    query.bindValue(":id", this->id);
+
+    if (!query.exec()) {
+        qWarning() << __func__ << ": " << query.lastError();
+        return false;
+    } else {
+        return true;
+    }
+}
+
+CachedLogFile CachedLogFile::cachedLogFileFromQuery(QSqlQuery query) {
+    CachedLogFile cachedLogFile;
+    cachedLogFile.fillFromQuery(query);
+    return cachedLogFile;
+}
+
+bool CachedLogFile::fillFromQuery(QSqlQuery query) {
+    this->id = query.value("id").toInt();
+    this->logFileSourceId = query.value("log_file_source_id").toInt();
+    this->remotePath = query.value("remote_path").toString();
+    this->remoteSize = query.value("remote_size").toLongLong();
+    this->remoteMTime = query.value("remote_mtime").toUInt();
+    this->filterHash = query.value("filter_hash").toString();
+    this->contentHash = query.value("content_hash").toString();
+    this->localPath = query.value("local_path").toString();
+    this->created = query.value("created").toDateTime();
+
+    return true;
+}
+
+/**
+ * Inserts or updates a CachedLogFile object in the database
+ *
+ * An older entry for the same remote file state will be replaced
+ */
+bool CachedLogFile::store() {
+    QSqlDatabase db = QSqlDatabase::database("disk");
+    QSqlQuery query(db);
+
+    if (this->id > 0) {
+        query.prepare(
+                "UPDATE downloadCache SET "
+                        "log_file_source_id = :logFileSourceId, "
+                        "remote_path = :remotePath, "
+                        "remote_size = :remoteSize, "
+                        "remote_mtime = :remoteMTime, "
+                        "filter_hash = :filterHash, "
+                        "content_hash = :contentHash, "
+                        "local_path = :localPath "
+                        "WHERE id = :id");
+        query.bindValue(":id", this->id);
+    } else {
+        CachedLogFile oldCachedLogFile = fetchByRemoteFile(
+                logFileSourceId, remotePath, remoteSize, remoteMTime,
+                filterHash);
+
+        if (oldCachedLogFile.isFetched()) {
+            oldCachedLogFile.remove();
+        }
+
+        query.prepare(
+                "INSERT INTO downloadCache (log_file_source_id, remote_path, "
+                        "remote_size, remote_mtime, filter_hash, "
+                        "content_hash, local_path) VALUES "
+                        "(:logFileSourceId, :remotePath, :remoteSize, "
+                        ":remoteMTime, :filterHash, :contentHash, "
+                        ":localPath)");
+    }
+
+    query.bindValue(":logFileSourceId", this->logFileSourceId);
+    query.bindValue(":remotePath", this->remotePath);
+    query.bindValue(":remoteSize", this->remoteSize);
+    query.bindValue(":remoteMTime", this->remoteMTime);
+    query.bindValue(":filterHash", this->filterHash);
+    query.bindValue(":contentHash", this->contentHash);
+    query.bindValue(":localPath", this->localPath);
+
+    if (!query.exec()) {
+        // on error
+        qWarning() << __func__ << ": " << query.lastError();
+        return false;
+    } else if (this->id == 0) {
+        // on insert
+        this->id = query.lastInsertId().toInt();
+    }
+
+    return true;
+}
+
+bool CachedLogFile::isFetched() {
+    return (this->id > 0);
+}
+
+/**
+ * Checks if the local file of the cache entry still exists
+ */
+bool CachedLogFile::localFileExists() {
+    QFileInfo fileInfo(localPath);
+    return !localPath.isEmpty() && fileInfo.isFile();
+}
+
+QDebug operator<<(QDebug dbg, const CachedLogFile &cachedLogFile) {
+    dbg.nospace() << "CachedLogFile: <id>" << cachedLogFile.id <<
+            " <remotePath>" << cachedLogFile.remotePath <<
+            " <remoteSize>" << cachedLogFile.remoteSize <<
+            " <remoteMTime>" << cachedLogFile.remoteMTime <<
+            " <contentHash>" << cachedLogFile.contentHash <<
+            " <localPath>" << cachedLogFile.localPath;
+    return dbg.space();
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QSqlQuery>
+#include <QDebug>
+#include <QDateTime>
+#include <QList>
+
+/**
+ * An entry of the download cache, it maps a remote log file (by log file
+ * source, path, size and modification time) to the hash of the downloaded
+ * content and the local file the content is stored in
+ */
+class CachedLogFile
+{
+public:
+    explicit CachedLogFile();
+
+    int getId();
+    static CachedLogFile fetch(int id);
+    static CachedLogFile fetchByRemoteFile(
+            int logFileSourceId, QString remotePath, qint64 remoteSize,
+            uint remoteMTime, QString filterHash = "");
+    static CachedLogFile fetchByContentHash(QString contentHash);
+    static QList<CachedLogFile> fetchAllByLogFileSource(
+            int logFileSourceId, QString filterHash = "");
+    static CachedLogFile cachedLogFileFromQuery(QSqlQuery query);
+    static QByteArray hashContent(const QByteArray &content);
+    bool store();
+    friend QDebug operator<<(QDebug dbg, const CachedLogFile &cachedLogFile);
+    bool fillFromQuery(QSqlQuery query);
+    bool remove();
+    bool isFetched();
+    bool localFileExists();
+    int getLogFileSourceId();
+    QString getRemotePath();
+    qint64 getRemoteSize();
+    uint getRemoteMTime();
+    QString getFilterHash();
+    QString getContentHash();
+    QString getLocalPath();
+    QDateTime getCreated();
+    void setLogFileSourceId(int id);
+    void setRemotePath(QString text);
+    void setRemoteSize(qint64 size);
+    void setRemoteMTime(uint mTime);
+    void setFilterHash(QString text);
+    void setContentHash(QString text);
+    void setLocalPath(QString text);
+
+private:
+    int id;
+    int logFileSourceId;
+    QString remotePath;
+    qint64 remoteSize;
+    uint remoteMTime;
+    QString filterHash;
+    QString contentHash;
+    QString localPath;
+    QDateTime created;
+};
@@ -0,0 +1,391 @@
+#include "logfileindex.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QSqlError>
+#include <QFile>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <utils/zip.h>
+
+
+LogFileIndex::LogFileIndex() {
+    id = 0;
+    filePath = "";
+    fileSize = 0;
+    fileMTime = 0;
+    contentHash = "";
+    lineCount = 0;
+}
+
+int LogFileIndex::getId() {
+    return this->id;
+}
+
+QString LogFileIndex::getFilePath() {
+    return this->filePath;
+}
+
+qint64 LogFileIndex::getFileSize() {
+    return this->fileSize;
+}
+
+uint LogFileIndex::getFileMTime() {
+    return this->fileMTime;
+}
+
+QString LogFileIndex::getContentHash() {
+    return this->contentHash;
+}
+
+qint64 LogFileIndex::getLineCount() {
+    return this->lineCount;
+}
+
+QDateTime LogFileIndex::getCreated() {
+    return this->created;
+}
+
+bool LogFileIndex::hasPatternBitmap(QString pattern) {
+    return patternBitmaps.contains(pattern);
+}
+
+/**
+ * Returns the lines of the file a pattern matched, one bit per line
+ */
+QBitArray LogFileIndex::getPatternBitmap(QString pattern) {
+    return patternBitmaps.value(pattern);
+}
+
+void LogFileIndex::setPatternBitmap(QString pattern, QBitArray bitmap) {
+    patternBitmaps[pattern] = bitmap;
+}
+
+/**
+ * Returns the file that holds the data of a log file, for members of zip
+ * archives this is the archive
+ */
+QString LogFileIndex::statFilePath(QString filePath) {
+    return Utils::Zip::isMemberPath(filePath) ?
+           Utils::Zip::archivePath(filePath) : filePath;
+}
+
+/**
+ * Returns a hash of the size, the head and the tail of a file, so changes
+ * are noticed even if the modification time is kept
+ */
+QString LogFileIndex::hashFile(QString filePath) {
+    QFile file(statFilePath(filePath));
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return "";
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(file.size()));
+    hash.addData(file.read(LOG_FILE_INDEX_HASH_SIZE));
+
+    if (file.size() > LOG_FILE_INDEX_HASH_SIZE) {
+        file.seek(qMax(static_cast<qint64>(LOG_FILE_INDEX_HASH_SIZE),
+                       file.size() - LOG_FILE_INDEX_HASH_SIZE));
+        hash.addData(file.readAll());
+    }
+
+    file.close();
+
+    return hash.result().toHex();
+}
+
+/**
+ * Builds the index of a log file from the number of its lines
+ */
+LogFileIndex LogFileIndex::build(QString filePath, qint64 lineCount) {
+    LogFileIndex logFileIndex;
+    QFileInfo fileInfo(statFilePath(filePath));
+
+    logFileIndex.filePath = filePath;
+    logFileIndex.fileSize = fileInfo.size();
+    logFileIndex.fileMTime = fileInfo.lastModified().toTime_t();
+    logFileIndex.contentHash = hashFile(filePath);
+
+    logFileIndex.lineCount = lineCount;
+
+    return logFileIndex;
+}
+
+/**
+ * Returns the lines of a text that are part of a match of an expression,
+ * one bit per line
+ */
+QBitArray LogFileIndex::buildPatternBitmap(
+        const QString &text, const QRegularExpression &expression) {
+    int lineCount = text.count('\n') + (text.endsWith('\n') ? 0 : 1);
+    QBitArray bitmap(text.isEmpty() ? 0 : lineCount);
+
+    // the matches are found in order, so the line of their start and end
+    // can be found by moving forward through the text
+    int pos = 0;
+    int line = 0;
+
+    QRegularExpressionMatchIterator iterator = expression.globalMatch(text);
+    while (iterator.hasNext()) {
+        QRegularExpressionMatch match = iterator.next();
+        int start = match.capturedStart();
+        int end = qMax(start, match.capturedEnd() - 1);
+
+        forever {
+            int lineEnd = text.indexOf('\n', pos);
+
+            if (lineEnd == -1 || lineEnd >= start) {
+                break;
+            }
+
+            pos = lineEnd + 1;
+            line++;
+        }
+
+        bitmap.setBit(line);
+
+        forever {
+            int lineEnd = text.indexOf('\n', pos);
+
+            if (lineEnd == -1 || lineEnd >= end) {
+                break;
+            }
+
+            pos = lineEnd + 1;
+            line++;
+            bitmap.setBit(line);
+        }
+    }
+
+    return bitmap;
+}
+
+/**
+ * Checks if the file still has the size, modification time and content
+ * the index was built from
+ */
+bool LogFileIndex::isCurrent() {
+    if (filePath.isEmpty()) {
+        return false;
+    }
+
+    QFileInfo fileInfo(statFilePath(filePath));
+
+    return fileInfo.isFile() &&
+            fileInfo.size() == fileSize &&
+            fileInfo.lastModified().toTime_t() == fileMTime &&
+            hashFile(filePath) == contentHash;
+}
+
+LogFileIndex LogFileIndex::fetch(int id) {
+    QSqlDatabase db = QSqlDatabase::database("disk");
+    QSqlQuery query(db);
+
+    LogFileIndex logFileIndex;
+
+    query.prepare("SELECT * FROM logFileIndex WHERE id = :id");
+    query.bindValue(":id", id);
+
+    if (!query.exec()) {
+        qWarning() << __func__ << ": " << query.lastError();
+    } else if (query.first()) {
+        logFileIndex.fillFromQuery(query);
+        logFileIndex.fetchPatternBitmaps();
+    }
+
+    return logFileIndex;
+}
+
+LogFileIndex LogFileIndex::fetchByFilePath(QString filePath) {
+    QSqlDatabase db = QSqlDatabase::database("disk");
+    QSqlQuery query(db);
+
+    LogFileIndex logFileIndex;
+
+    query.prepare("SELECT * FROM logFileIndex WHERE file_path = :filePath");
+    query.bindValue(":filePath", filePath);
+
+    if (!query.exec()) {
+        qWarning() << __func__ << ": " << query.lastError();
+    } else if (query.first()) {
+        logFileIndex.fillFromQuery(query);
+        logFileIndex.fetchPatternBitmaps();
+    }
+
+    return logFileIndex;
+}
+
+void LogFileIndex::fetchPatternBitmaps() {
+    QSqlDatabase db = QSqlDatabase::database("disk");
+    QSqlQuery query(db);
+
+    patternBitmaps.clear();
+
+    query.prepare("SELECT pattern, bitmap FROM logFilePatternBitmap WHERE "
+                          "log_file_index_id = :logFileIndexId");
+    query.bindValue(":logFileIndexId", this->id);
+
+    if (!query.exec()) {
+        qWarning() << __func__ << ": " << query.lastError();
+        return;
+    }
+
+    while (query.next()) {
+        QByteArray data = qUncompress(query.value("bitmap").toByteArray());
+        QDataStream in(&data, QIODevice::ReadOnly);
+        QBitArray bitmap;
+        in >> bitmap;
+
+        patternBitmaps[query.value("pattern").toString()] = bitmap;
+    }
+}
+
+bool LogFileIndex::remove() {
+    QSqlDatabase db = QSqlDatabase::database("disk");
+    QSqlQuery query(db);
+
+    query.prepare("DELETE FROM logFilePatternBitmap WHERE "
+                          "log_file_index_id = :id");
+    query.bindValue(":id", this->id);
+
+    if (!query.exec()) {
+        qWarning() << __func__ << ": " << query.lastError();
+        return false;
+    }
+
+    query.prepare("DELETE FROM logFileIndex WHERE id = :id");
+    query.bindValue(":id", this->id);
+
+    if (!query.exec()) {
+        qWarning() << __func__ << ": " << query.lastError();
+        return false;
+    } else {
+        return true;
+    }
+}
+
+LogFileIndex LogFileIndex::logFileIndexFromQuery(QSqlQuery query) {
+    LogFileIndex logFileIndex;
+    logFileIndex.fillFromQuery(query);
+    return logFileIndex;
+}
+
+bool LogFileIndex::fillFromQuery(QSqlQuery query) {
+    this->id = query.value("id").toInt();
+    this->filePath = query.value("file_path").toString();
+    this->fileSize = query.value("file_size").toLongLong();
+    this->fileMTime = query.value("file_mtime").toUInt();
+    this->contentHash = query.value("content_hash").toString();
+    this->lineCount = query.value("line_count").toLongLong();
+    this->created = query.value("created").toDateTime();
+
+    return true;
+}
+
+/**
+ * Inserts or updates a LogFileIndex object and its pattern bitmaps in the
+ * database
+ *
+ * An older index of the same file will be replaced
+ */
+bool LogFileIndex::store() {
+    QSqlDatabase db = QSqlDatabase::database("disk");
+    QSqlQuery query(db);
+
+    if (this->id > 0) {
+        query.prepare(
+                "UPDATE logFileIndex SET "
+                        "file_path = :filePath, "
+                        "file_size = :fileSize, "
+                        "file_mtime = :fileMTime, "
+                        "content_hash = :contentHash, "
+                        "line_count = :lineCount "
+                        "WHERE id = :id");
+        query.bindValue(":id", this->id);
+    } else {
+        LogFileIndex oldLogFileIndex = fetchByFilePath(filePath);
+
+        if (oldLogFileIndex.isFetched()) {
+            oldLogFileIndex.remove();
+        }
+
+        query.prepare(
+                "INSERT INTO logFileIndex (file_path, file_size, file_mtime, "
+                        "content_hash, line_count) VALUES "
+                        "(:filePath, :fileSize, :fileMTime, :contentHash, "
+                        ":lineCount)");
+    }
+
+    query.bindValue(":filePath", this->filePath);
+    query.bindValue(":fileSize", this->fileSize);
+    query.bindValue(":fileMTime", this->fileMTime);
+    query.bindValue(":contentHash", this->contentHash);
+    query.bindValue(":lineCount", this->lineCount);
+
+    if (!query.exec()) {
+        // on error
+        qWarning() << __func__ << ": " << query.lastError();
+        return false;
+    } else if (this->id == 0) {
+        // on insert
+        this->id = query.lastInsertId().toInt();
+    }
+
+    return storePatternBitmaps();
+}
+
+bool LogFileIndex::storePatternBitmaps() {
+    QSqlDatabase db = QSqlDatabase::database("disk");
+    QSqlQuery query(db);
+
+    query.prepare("DELETE FROM logFilePatternBitmap WHERE "
+                          "log_file_index_id = :logFileIndexId");
+    query.bindValue(":logFileIndexId", this->id);
+
+    if (!query.exec()) {
+        qWarning() << __func__ << ": " << query.lastError();
+        return false;
+    }
+
+    QHashIterator<QString, QBitArray> iterator(patternBitmaps);
+    while (iterator.hasNext()) {
+        iterator.next();
+
+        QByteArray data;
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out << iterator.value();
+
+        query.prepare("INSERT INTO logFilePatternBitmap (log_file_index_id, "
+                              "pattern, match_count, bitmap) VALUES "
+                              "(:logFileIndexId, :pattern, :matchCount, "
+                              ":bitmap)");
+        query.bindValue(":logFileIndexId", this->id);
+        query.bindValue(":pattern", iterator.key());
+        query.bindValue(":matchCount", iterator.value().count(true));
+        query.bindValue(":bitmap", qCompress(data));
+
+        if (!query.exec()) {
+            qWarning() << __func__ << ": " << query.lastError();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool LogFileIndex::isFetched() {
+    return (this->id > 0);
+}
+
+QDebug operator<<(QDebug dbg, const LogFileIndex &logFileIndex) {
+    dbg.nospace() << "LogFileIndex: <id>" << logFileIndex.id <<
+            " <filePath>" << logFileIndex.filePath <<
+            " <fileSize>" << logFileIndex.fileSize <<
+            " <fileMTime>" << logFileIndex.fileMTime <<
+            " <lineCount>" << logFileIndex.lineCount <<
+            " <patternBitmaps>" << logFileIndex.patternBitmaps.count();
+    return dbg.space();
+}
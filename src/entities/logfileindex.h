@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QSqlQuery>
+#include <QDebug>
+#include <QDateTime>
+#include <QBitArray>
+#include <QHash>
+#include <QRegularExpression>
+
+// amount of data at the start and the end of a file that is hashed
+#define LOG_FILE_INDEX_HASH_SIZE (64 * 1024)
+
+/**
+ * A persistent index of a log file, it holds the line count and the lines
+ * matched by patterns, so the patterns don't need to be matched again as
+ * long as the file doesn't change
+ *
+ * The file itself is still read completely when it is loaded. The bitmaps
+ * are only used to filter a file that wasn't filtered since it was loaded
+ * and has at most INT_MAX lines.
+ *
+ * The file is identified by its path, size, modification time and a hash of
+ * its head and tail. The index doesn't use the database, so it can be built
+ * and checked in worker threads, only fetch, store and remove do.
+ */
+class LogFileIndex
+{
+public:
+    explicit LogFileIndex();
+
+    int getId();
+    static LogFileIndex fetch(int id);
+    static LogFileIndex fetchByFilePath(QString filePath);
+    static LogFileIndex logFileIndexFromQuery(QSqlQuery query);
+    static LogFileIndex build(QString filePath, qint64 lineCount);
+    static QString hashFile(QString filePath);
+    static QBitArray buildPatternBitmap(const QString &text,
+                                        const QRegularExpression &expression);
+    bool store();
+    friend QDebug operator<<(QDebug dbg, const LogFileIndex &logFileIndex);
+    bool fillFromQuery(QSqlQuery query);
+    bool remove();
+    bool isFetched();
+    bool isCurrent();
+    QString getFilePath();
+    qint64 getFileSize();
+    uint getFileMTime();
+    QString getContentHash();
+    qint64 getLineCount();
+    QDateTime getCreated();
+    bool hasPatternBitmap(QString pattern);
+    QBitArray getPatternBitmap(QString pattern);
+    void setPatternBitmap(QString pattern, QBitArray bitmap);
+
+private:
+    int id;
+    QString filePath;
+    qint64 fileSize;
+    uint fileMTime;
+    QString contentHash;
+    qint64 lineCount;
+    QDateTime created;
+    QHash<QString, QBitArray> patternBitmaps;
+
+    static QString statFilePath(QString filePath);
+    void fetchPatternBitmaps();
+    bool storePatternBitmaps();
+};
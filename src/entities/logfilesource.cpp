@@ -17,6 +17,9 @@ LogFileSource::LogFileSource() {
     ezpUsername = "";
     ezpPassword = "";
     priority = 0;
+    addDownloadedFilePrefix = false;
+    serverSideFiltering = false;
+    compressDownloads = false;
 }
 
 int LogFileSource::getId() {
@@ -48,6 +51,14 @@ bool LogFileSource::getAddDownloadedFilePrefix() {
     return this->addDownloadedFilePrefix;
 }
 
+bool LogFileSource::getServerSideFiltering() {
+    return this->serverSideFiltering;
+}
+
+bool LogFileSource::getCompressDownloads() {
+    return this->compressDownloads;
+}
+
 QString LogFileSource::getName() {
     return this->name;
 }
@@ -68,6 +79,14 @@ void LogFileSource::setAddDownloadedFilePrefix(bool state) {
     this->addDownloadedFilePrefix = state;
 }
 
+void LogFileSource::setServerSideFiltering(bool state) {
+    this->serverSideFiltering = state;
+}
+
+void LogFileSource::setCompressDownloads(bool state) {
+    this->compressDownloads = state;
+}
+
 void LogFileSource::setLocalPath(QString text) {
     this->localPath = text;
 }
@@ -159,6 +178,9 @@ bool LogFileSource::fillFromQuery(QSqlQuery query) {
     this->priority = query.value("priority").toInt();
     this->addDownloadedFilePrefix = query.value("add_downloaded_file_prefix")
             .toBool();
+    this->serverSideFiltering = query.value("server_side_filtering")
+            .toBool();
+    this->compressDownloads = query.value("compress_downloads").toBool();
 
     return true;
 }
@@ -198,17 +220,21 @@ bool LogFileSource::store() {
                         "ezp_username = :ezpUsername, "
                         "ezp_password = :ezpPassword, "
                         "priority = :priority, "
-                        "add_downloaded_file_prefix = :addDownloadedFilePrefix "
+                        "add_downloaded_file_prefix = :addDownloadedFilePrefix, "
+                        "server_side_filtering = :serverSideFiltering, "
+                        "compress_downloads = :compressDownloads "
                         "WHERE id = :id");
         query.bindValue(":id", this->id);
     } else {
         query.prepare(
                 "INSERT INTO logFileSource (name, type, local_path, "
                         "ezp_server_url, ezp_username, ezp_password, "
-                        "priority, add_downloaded_file_prefix) VALUES "
+                        "priority, add_downloaded_file_prefix, "
+                        "server_side_filtering, compress_downloads) VALUES "
                         "(:name, :type, :localPath, :ezpServerUrl, "
                         ":ezpUsername, :ezpPassword, :priority, "
-                        ":addDownloadedFilePrefix)");
+                        ":addDownloadedFilePrefix, :serverSideFiltering, "
+                        ":compressDownloads)");
     }
 
     query.bindValue(":name", this->name);
@@ -219,6 +245,8 @@ bool LogFileSource::store() {
     query.bindValue(":ezpPassword", this->ezpPassword);
     query.bindValue(":priority", this->priority);
     query.bindValue(":addDownloadedFilePrefix", this->addDownloadedFilePrefix);
+    query.bindValue(":serverSideFiltering", this->serverSideFiltering);
+    query.bindValue(":compressDownloads", this->compressDownloads);
 
     if (!query.exec()) {
         // on error
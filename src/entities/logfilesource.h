@@ -47,6 +47,10 @@ public:
     bool isEzPublishTypeValid();
     void setAddDownloadedFilePrefix(bool state);
     bool getAddDownloadedFilePrefix();
+    void setServerSideFiltering(bool state);
+    bool getServerSideFiltering();
+    void setCompressDownloads(bool state);
+    bool getCompressDownloads();
 
 private:
     int id;
@@ -58,4 +62,6 @@ private:
     QString ezpPassword;
     int priority;
     bool addDownloadedFilePrefix;
+    bool serverSideFiltering;
+    bool compressDownloads;
 };
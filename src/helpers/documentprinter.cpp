@@ -0,0 +1,295 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#include "documentprinter.h"
+#include <QtConcurrent>
+#include <QAbstractTextDocumentLayout>
+#include <QFile>
+#include <QPainter>
+#include <QTextFrame>
+#include <climits>
+
+DocumentPrinter::DocumentPrinter(QObject *parent) : QObject(parent) {
+}
+
+/**
+ * Cancels a running job and waits for it, the printer must not outlive
+ * the window
+ */
+DocumentPrinter::~DocumentPrinter() {
+    cancel();
+    wait();
+}
+
+/**
+ * Starts to print the parts of the html, takes the ownership of the printer
+ *
+ * The document head opens every chunk with its styles, the chunks are
+ * closed by the printer. Returns false if a job is still running, the
+ * printer is deleted anyway.
+ */
+bool DocumentPrinter::start(const QString &documentHead,
+                            const QStringList &parts, QPrinter *printer) {
+    if (isRunning()) {
+        delete printer;
+        return false;
+    }
+
+    canceled.store(0);
+    future = QtConcurrent::run(this, &DocumentPrinter::run, documentHead,
+                               parts, printer);
+
+    return true;
+}
+
+bool DocumentPrinter::isRunning() const {
+    return future.isRunning();
+}
+
+void DocumentPrinter::wait() {
+    future.waitForFinished();
+}
+
+/**
+ * Stops the job after the current page, the pages that were printed are
+ * discarded
+ */
+void DocumentPrinter::cancel() {
+    canceled.store(1);
+}
+
+/**
+ * Lays out the chunks of the html for the printer and prints their pages
+ * one by one, runs in a worker thread
+ *
+ * Like QTextDocument::print() the pages get a margin of 2cm and a page
+ * number, and the copies are printed by the printer itself if it supports
+ * them. The page numbers count through all chunks. With the last page first
+ * every chunk is laid out once more to count its pages before printing.
+ * QPainter can be used on a QPrinter outside of the GUI thread.
+ */
+void DocumentPrinter::run(QString documentHead, QStringList parts,
+                          QPrinter *printer) {
+    QStringList htmlChunks = chunks(parts);
+    parts.clear();
+    int chunkCount = htmlChunks.count();
+    emit progress(0, chunkCount, 0);
+
+    QPainter painter;
+    if (!painter.begin(printer)) {
+        qWarning() << __func__ << " - 'printer couldn't be opened': " <<
+                printer->outputFileName();
+        delete printer;
+        emit finished(false, 0);
+        return;
+    }
+
+    int dpiY = printer->logicalDpiY();
+    int margin = static_cast<int>(DOCUMENT_PRINTER_MARGIN / 2.54 * dpiY);
+    QRectF body(0, 0, printer->width(), printer->height());
+    QPointF pageNumberPos(
+            body.width() - margin,
+            body.height() - margin +
+                    QFontMetrics(QTextDocument().defaultFont(), printer)
+                            .ascent() + 5 * dpiY / 72.0);
+
+    int firstPage = 1;
+    int lastPage = INT_MAX;
+
+    if (printer->printRange() == QPrinter::PageRange) {
+        firstPage = qMax(firstPage, printer->fromPage());
+        lastPage = printer->toPage() > 0 ? printer->toPage() : lastPage;
+    }
+
+    // the same as QTextDocument::print()
+    int documentCopies;
+    int pageCopies;
+
+    if (printer->collateCopies()) {
+        documentCopies = 1;
+        pageCopies = printer->supportsMultipleCopies() ?
+                     1 : printer->copyCount();
+    } else {
+        documentCopies = printer->supportsMultipleCopies() ?
+                         1 : printer->copyCount();
+        pageCopies = 1;
+    }
+
+    // the pages of the chunks are only needed to be known before they are
+    // printed if the last page comes first
+    bool reversed = printer->pageOrder() == QPrinter::LastPageFirst;
+    QVector<int> chunkPageCounts;
+    int totalPageCount = 0;
+
+    for (int i = 0; reversed && i < chunkCount && !canceled.load(); i++) {
+        QTextDocument document;
+        layoutChunk(&document, documentHead, htmlChunks.at(i), printer,
+                    body, margin);
+        chunkPageCounts.append(document.pageCount());
+        totalPageCount += chunkPageCounts.last();
+
+        emit progress(i + 1, chunkCount, 0);
+    }
+
+    int printedCount = 0;
+
+    for (int copy = 0; copy < documentCopies && !canceled.load(); copy++) {
+        // the number of the pages before the chunk
+        int pageOffset = reversed ? totalPageCount : 0;
+
+        for (int c = 0; c < chunkCount && !canceled.load(); c++) {
+            int chunk = reversed ? chunkCount - 1 - c : c;
+
+            if (!reversed && pageOffset >= lastPage) {
+                break;
+            }
+
+            // the chunks are created in the worker, so the html never needs
+            // to be laid out on the GUI thread
+            QTextDocument document;
+            layoutChunk(&document, documentHead, htmlChunks.at(chunk),
+                        printer, body, margin);
+            int pageCount = document.pageCount();
+
+            if (reversed) {
+                pageOffset -= chunkPageCounts.at(chunk);
+            }
+
+            emit progress(c + 1, chunkCount, printedCount);
+
+            for (int i = 0; i < pageCount && !canceled.load(); i++) {
+                int documentPage = reversed ? pageCount - i : i + 1;
+                int page = pageOffset + documentPage;
+
+                if (page < firstPage || page > lastPage) {
+                    continue;
+                }
+
+                for (int j = 0; j < pageCopies && !canceled.load(); j++) {
+                    if (printedCount > 0) {
+                        printer->newPage();
+                    }
+
+                    printPage(&painter, &document, body, pageNumberPos,
+                              documentPage, page);
+                    printedCount++;
+                }
+
+                emit progress(c + 1, chunkCount, printedCount);
+            }
+
+            if (!reversed) {
+                pageOffset += pageCount;
+            }
+        }
+    }
+
+    bool completed = !canceled.load();
+
+    // a canceled print job isn't sent to the printer, a canceled export
+    // doesn't leave a partial file
+    if (!completed) {
+        printer->abort();
+    }
+
+    painter.end();
+
+    if (!completed && printer->outputFormat() == QPrinter::PdfFormat) {
+        QFile::remove(printer->outputFileName());
+    }
+
+    delete printer;
+    emit finished(completed, printedCount);
+}
+
+/**
+ * Puts consecutive parts together into chunks of about
+ * DOCUMENT_PRINTER_CHUNK_SIZE characters, larger parts are chunks of their
+ * own
+ */
+QStringList DocumentPrinter::chunks(const QStringList &parts) {
+    QStringList result;
+    QString chunk;
+
+    Q_FOREACH(QString part, parts) {
+            if (!chunk.isEmpty() &&
+                    chunk.size() + part.size() > DOCUMENT_PRINTER_CHUNK_SIZE) {
+                result.append(chunk);
+                chunk.clear();
+            }
+
+            chunk += part;
+        }
+
+    if (!chunk.isEmpty() || result.isEmpty()) {
+        result.append(chunk);
+    }
+
+    return result;
+}
+
+/**
+ * Lays out a chunk of the html as paginated document with the metrics of
+ * the printer
+ */
+void DocumentPrinter::layoutChunk(QTextDocument *document,
+                                  const QString &documentHead,
+                                  const QString &chunk, QPrinter *printer,
+                                  const QRectF &body, int margin) {
+    document->setHtml(documentHead + chunk + "</body></html>");
+    document->documentLayout()->setPaintDevice(printer);
+
+    QTextFrameFormat frameFormat = document->rootFrame()->frameFormat();
+    frameFormat.setMargin(margin);
+    document->rootFrame()->setFrameFormat(frameFormat);
+    document->setPageSize(body.size());
+}
+
+/**
+ * Paints a page of a paginated document with the number of the page in the
+ * whole print job
+ */
+void DocumentPrinter::printPage(QPainter *painter, QTextDocument *document,
+                                const QRectF &body,
+                                const QPointF &pageNumberPos,
+                                int documentPage, int page) {
+    painter->save();
+    painter->translate(body.left(),
+                       body.top() - (documentPage - 1) * body.height());
+    QRectF view(0, (documentPage - 1) * body.height(), body.width(),
+                body.height());
+
+    QAbstractTextDocumentLayout::PaintContext context;
+    painter->setClipRect(view);
+    context.clip = view;
+    context.palette.setColor(QPalette::Text, Qt::black);
+    document->documentLayout()->draw(painter, context);
+
+    QString pageText = QString::number(page);
+    painter->setClipping(false);
+    painter->setFont(document->defaultFont());
+    painter->drawText(
+            qRound(pageNumberPos.x() -
+                           painter->fontMetrics().width(pageText)),
+            qRound(pageNumberPos.y() + view.top()), pageText);
+    painter->restore();
+}
+
+QDebug operator<<(QDebug dbg, const DocumentPrinter &documentPrinter) {
+    dbg.nospace() << "DocumentPrinter: <isRunning>" <<
+            documentPrinter.isRunning() << " <canceled>" <<
+            documentPrinter.canceled.load();
+    return dbg.space();
+}
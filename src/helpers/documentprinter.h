@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#pragma once
+
+#include <QObject>
+#include <QFuture>
+#include <QAtomicInt>
+#include <QPrinter>
+#include <QStringList>
+#include <QTextDocument>
+#include <QDebug>
+
+// margin of the printed pages in centimeters, like QTextDocument::print()
+#define DOCUMENT_PRINTER_MARGIN 2.0
+
+// number of characters of html that are laid out at once
+#define DOCUMENT_PRINTER_CHUNK_SIZE (256 * 1024)
+
+/**
+ * Prints html or exports it as PDF on a worker thread, so large reports
+ * don't block the window
+ *
+ * The html is given as parts, like the sections of a report. Consecutive
+ * parts are put together into chunks of about 256KB, every chunk is laid out
+ * for the printer as its own document and starts on a new page. Every page
+ * is painted and handed to the printer before the next one, the printer
+ * writes it out, so only the layout of one chunk is kept in memory. The
+ * page range, the page order and the copies of the printer are respected,
+ * the job can be canceled between two pages or chunks.
+ */
+class DocumentPrinter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DocumentPrinter(QObject *parent = 0);
+    ~DocumentPrinter();
+
+    bool start(const QString &documentHead, const QStringList &parts,
+               QPrinter *printer);
+    bool isRunning() const;
+    void wait();
+    friend QDebug operator<<(QDebug dbg,
+                             const DocumentPrinter &documentPrinter);
+
+public slots:
+    void cancel();
+
+signals:
+    /**
+     * Is emitted after every chunk that was laid out and every page that
+     * was printed
+     */
+    void progress(int chunk, int chunkCount, int pageCount);
+
+    /**
+     * Is emitted when the job is done, pageCount is the number of printed
+     * pages
+     */
+    void finished(bool completed, int pageCount);
+
+private:
+    QFuture<void> future;
+    QAtomicInt canceled;
+
+    void run(QString documentHead, QStringList parts, QPrinter *printer);
+    static QStringList chunks(const QStringList &parts);
+    static void layoutChunk(QTextDocument *document,
+                            const QString &documentHead,
+                            const QString &chunk, QPrinter *printer,
+                            const QRectF &body, int margin);
+    static void printPage(QPainter *painter, QTextDocument *document,
+                          const QRectF &body, const QPointF &pageNumberPos,
+                          int documentPage, int page);
+};
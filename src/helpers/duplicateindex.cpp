@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#include "duplicateindex.h"
+#include <utils/tokennormalizer.h>
+
+namespace {
+    /**
+     * Returns the length of the line at a position of data without its line
+     * break and sets next to the position of the following line
+     */
+    int lineLength(const QByteArray &data, int pos, int *next) {
+        int end = data.indexOf('\n', pos);
+
+        if (end == -1) {
+            end = data.size();
+            *next = end;
+        } else {
+            *next = end + 1;
+        }
+
+        if (end > pos && data.at(end - 1) == '\r') {
+            end--;
+        }
+
+        return end - pos;
+    }
+}
+
+DuplicateIndex::DuplicateIndex() {
+    lineCount = 0;
+}
+
+/**
+ * Builds the index of a log store, the blocks are hashed in parallel and
+ * appended to the index in their order
+ */
+DuplicateIndex DuplicateIndex::build(LogStore &logStore) {
+    std::function<DuplicateIndex(const QByteArray &block)> indexBlock =
+            [](const QByteArray &block) -> DuplicateIndex {
+                DuplicateIndex blockIndex;
+                blockIndex.addLines(block);
+                return blockIndex;
+            };
+    std::function<void(DuplicateIndex &duplicateIndex,
+                       const DuplicateIndex &blockIndex)> appendBlockIndex =
+            [](DuplicateIndex &duplicateIndex,
+               const DuplicateIndex &blockIndex) {
+                duplicateIndex.append(blockIndex);
+            };
+
+    return logStore.mapReduceBlocks<DuplicateIndex, DuplicateIndex>(
+            indexBlock, appendBlockIndex, QtConcurrent::OrderedReduce);
+}
+
+/**
+ * Returns a 64 bit hash of the normalized content of a line (FNV-1a with a
+ * final mix of the bits)
+ */
+quint64 DuplicateIndex::hashLine(const char *line, int length) {
+    QByteArray normalized = Utils::TokenNormalizer::normalize(line, length);
+    const uchar *data =
+            reinterpret_cast<const uchar *>(normalized.constData());
+    quint64 value = Q_UINT64_C(14695981039346656037);
+
+    for (int i = 0; i < normalized.size(); i++) {
+        value ^= data[i];
+        value *= Q_UINT64_C(1099511628211);
+    }
+
+    value ^= value >> 33;
+    value *= Q_UINT64_C(0xff51afd7ed558ccd);
+    value ^= value >> 33;
+
+    return value;
+}
+
+/**
+ * Adds the lines of data after the lines that were already added
+ */
+void DuplicateIndex::addLines(const QByteArray &data) {
+    int pos = 0;
+
+    while (pos < data.size()) {
+        int next;
+        int length = lineLength(data, pos, &next);
+        quint64 hash = hashLine(data.constData() + pos, length);
+        int index = entryIndexes.value(hash, -1);
+
+        if (index < 0) {
+            Entry entry;
+            entry.line = data.mid(pos, length);
+            entry.hash = hash;
+            entry.firstLine = lineCount;
+            entry.lastLine = lineCount;
+            entry.count = 1;
+            addEntry(entry);
+        } else {
+            Entry &entry = entries[index];
+            entry.lastLine = lineCount;
+            entry.count++;
+        }
+
+        pos = next;
+        lineCount++;
+    }
+}
+
+/**
+ * Appends the index of the lines that follow the indexed lines, like the
+ * index of the next block
+ */
+void DuplicateIndex::append(const DuplicateIndex &other) {
+    Q_FOREACH(Entry entry, other.entries) {
+            entry.firstLine += lineCount;
+            entry.lastLine += lineCount;
+            addEntry(entry);
+        }
+
+    lineCount += other.lineCount;
+}
+
+bool DuplicateIndex::isEmpty() const {
+    return entries.isEmpty();
+}
+
+/**
+ * Returns the number of distinct lines
+ */
+int DuplicateIndex::getEntryCount() const {
+    return entries.count();
+}
+
+qint64 DuplicateIndex::getLineCount() const {
+    return lineCount;
+}
+
+/**
+ * Returns the entries in the order of their first occurrence
+ */
+DuplicateIndex::Entry DuplicateIndex::getEntry(int index) const {
+    return entries.at(index);
+}
+
+/**
+ * Returns the numbers and the texts of up to maxCount occurrences of an
+ * entry
+ *
+ * Only the blocks between its first and its last occurrence are scanned.
+ */
+QList<QPair<qint64, QByteArray>> DuplicateIndex::occurrences(
+        LogStore &logStore, int index, int maxCount) const {
+    QList<QPair<qint64, QByteArray>> result;
+
+    if (index < 0 || index >= entries.count()) {
+        return result;
+    }
+
+    const Entry &entry = entries.at(index);
+    int lastBlockIndex = logStore.blockIndexForLine(entry.lastLine);
+
+    for (int i = logStore.blockIndexForLine(entry.firstLine);
+         i <= lastBlockIndex && result.count() < maxCount; i++) {
+        QByteArray block = logStore.block(i);
+        qint64 line = logStore.getBlockFirstLine(i);
+        int pos = 0;
+
+        while (pos < block.size() && result.count() < maxCount &&
+                line <= entry.lastLine) {
+            int next;
+            int length = lineLength(block, pos, &next);
+
+            if (line >= entry.firstLine &&
+                    hashLine(block.constData() + pos, length) == entry.hash) {
+                result.append(qMakePair(line, block.mid(pos, length)));
+            }
+
+            pos = next;
+            line++;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Adds an entry or adds its occurrences to the entry of the same line, the
+ * occurrences have to follow the ones of that entry
+ */
+void DuplicateIndex::addEntry(const Entry &entry) {
+    int index = entryIndexes.value(entry.hash, -1);
+
+    if (index < 0) {
+        entryIndexes.insert(entry.hash, entries.count());
+        entries.append(entry);
+        return;
+    }
+
+    Entry &existingEntry = entries[index];
+    existingEntry.lastLine = entry.lastLine;
+    existingEntry.count += entry.count;
+}
+
+QDebug operator<<(QDebug dbg, const DuplicateIndex &duplicateIndex) {
+    dbg.nospace() << "DuplicateIndex: <lineCount>" <<
+            duplicateIndex.lineCount << " <entryCount>" <<
+            duplicateIndex.entries.count();
+    return dbg.space();
+}
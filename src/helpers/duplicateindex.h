@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QVector>
+#include <QDebug>
+#include <helpers/logstore.h>
+
+/**
+ * Groups the lines of a log store that are duplicates of each other, with
+ * their number of occurrences and the first and last line they occur in
+ *
+ * Lines are compared by a 64 bit hash of their normalized content, so lines
+ * that only differ by numbers (like their timestamps), hex ids, UUIDs or IP
+ * addresses are duplicates. Only the text of the first occurrence of a line
+ * is kept, the memory scales with the number of distinct lines.
+ */
+class DuplicateIndex
+{
+public:
+    struct Entry {
+        // text of the first occurrence without the line break
+        QByteArray line;
+        quint64 hash;
+        qint64 firstLine;
+        qint64 lastLine;
+        qint64 count;
+    };
+
+    explicit DuplicateIndex();
+
+    static DuplicateIndex build(LogStore &logStore);
+    static quint64 hashLine(const char *line, int length);
+    void addLines(const QByteArray &data);
+    void append(const DuplicateIndex &other);
+    bool isEmpty() const;
+    int getEntryCount() const;
+    qint64 getLineCount() const;
+    Entry getEntry(int index) const;
+    QList<QPair<qint64, QByteArray>> occurrences(LogStore &logStore,
+                                                 int index,
+                                                 int maxCount) const;
+    friend QDebug operator<<(QDebug dbg, const DuplicateIndex &duplicateIndex);
+
+private:
+    qint64 lineCount;
+    QVector<Entry> entries;
+    QHash<quint64, int> entryIndexes;
+
+    void addEntry(const Entry &entry);
+};
@@ -0,0 +1,943 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#include "filterplan.h"
+#include <QObject>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <algorithm>
+#include <iterator>
+#include <utils/timestamp.h>
+#include <utils/jsonlines.h>
+
+// marks a timestamp of a batch that wasn't parsed yet
+#define FILTER_PLAN_UNPARSED_TIMESTAMP -2
+
+namespace {
+    /**
+     * Returns the lines of a sorted selection that aren't in another one
+     */
+    QVector<int> difference(const QVector<int> &selection,
+                            const QVector<int> &removed) {
+        QVector<int> result;
+        result.reserve(selection.count() - removed.count());
+        std::set_difference(selection.constBegin(), selection.constEnd(),
+                            removed.constBegin(), removed.constEnd(),
+                            std::back_inserter(result));
+        return result;
+    }
+}
+
+/**
+ * The lines of a block that are filtered together, the timestamps and the
+ * fields of a line are only parsed when a predicate needs them
+ */
+struct FilterPlan::Batch {
+    const char *data;
+    QVector<int> offsets;
+    QVector<int> lengths;
+    Utils::LogFormat::Format format;
+    QVector<qint64> timestamps;
+    // the timestamp of the last line with one before the block
+    qint64 previousTimestamp;
+    // 0 if a line wasn't parsed yet, 1 if it was and 2 if it can't be
+    QVector<char> parsed;
+    QVector<QVector<int>> structurals;
+    QVector<QVector<QByteArray>> values;
+    QVector<QByteArray> names;
+
+    Batch(const QByteArray &block, Utils::LogFormat::Format format,
+          qint64 previousTimestamp = Utils::Timestamp::Invalid) {
+        data = block.constData();
+        this->format = format;
+        this->previousTimestamp = previousTimestamp;
+        int pos = 0;
+
+        while (pos < block.size()) {
+            int end = block.indexOf('\n', pos);
+            int next = end == -1 ? block.size() : end + 1;
+            end = end == -1 ? block.size() : end;
+
+            if (end > pos && block.at(end - 1) == '\r') {
+                end--;
+            }
+
+            offsets.append(pos);
+            lengths.append(end - pos);
+            pos = next;
+        }
+
+        int count = offsets.count();
+        timestamps.fill(FILTER_PLAN_UNPARSED_TIMESTAMP, count);
+        parsed.fill(0, count);
+
+        if (format == Utils::LogFormat::JsonLinesFormat) {
+            structurals.resize(count);
+        } else {
+            values.resize(count);
+        }
+    }
+
+    int count() const {
+        return offsets.count();
+    }
+
+    /**
+     * Returns the timestamp of a line, lines without one, like the lines of
+     * a stack trace, get the timestamp of the previous line with one
+     */
+    qint64 timestamp(int line) {
+        if (timestamps.at(line) != FILTER_PLAN_UNPARSED_TIMESTAMP) {
+            return timestamps.at(line);
+        }
+
+        int first = line;
+        qint64 timestamp = parseTimestamp(line);
+
+        while (timestamp == Utils::Timestamp::Invalid) {
+            if (first == 0) {
+                timestamp = previousTimestamp;
+                break;
+            }
+
+            first--;
+
+            if (timestamps.at(first) != FILTER_PLAN_UNPARSED_TIMESTAMP) {
+                timestamp = timestamps.at(first);
+                break;
+            }
+
+            timestamp = parseTimestamp(first);
+        }
+
+        // the lines in between have no timestamp of their own
+        for (int i = first; i <= line; i++) {
+            timestamps[i] = timestamp;
+        }
+
+        return timestamp;
+    }
+
+    qint64 parseTimestamp(int line) const {
+        return Utils::Timestamp::parse(data + offsets.at(line),
+                                       lengths.at(line));
+    }
+
+    /**
+     * Returns the value of a field of a line, JSON lines are only scanned
+     * once and only the requested value is extracted
+     */
+    bool field(int line, const QByteArray &name, int fieldIndex,
+               QByteArray &value) {
+        const char *text = data + offsets.at(line);
+        int length = lengths.at(line);
+
+        if (parsed.at(line) == 0) {
+            bool ok = format == Utils::LogFormat::JsonLinesFormat ?
+                      Utils::JsonLines::buildStructuralIndex(
+                              text, length, structurals[line]) :
+                      Utils::LogFormat::parseLine(format, text, length,
+                                                  values[line], names);
+            parsed[line] = ok ? 1 : 2;
+        }
+
+        if (parsed.at(line) != 1) {
+            return false;
+        }
+
+        if (format == Utils::LogFormat::JsonLinesFormat) {
+            return Utils::JsonLines::findField(text, structurals.at(line),
+                                               name, value);
+        }
+
+        if (fieldIndex < 0 || fieldIndex >= values.at(line).count()) {
+            return false;
+        }
+
+        value = values.at(line).at(fieldIndex);
+        return true;
+    }
+};
+
+/**
+ * A recursive descent parser of filter expressions
+ */
+class FilterPlanParser
+{
+public:
+    enum TokenType {
+        EndToken,
+        WordToken,
+        StringToken,
+        RegexToken,
+        OperatorToken,
+        OpenToken,
+        CloseToken
+    };
+
+    struct Token {
+        TokenType type;
+        QString text;
+    };
+
+    FilterPlanParser(FilterPlan *plan, const QString &expression) {
+        this->plan = plan;
+        this->expression = expression;
+        pos = 0;
+        next();
+    }
+
+    int parse() {
+        int index = parseOr();
+
+        if (index >= 0 && token.type != EndToken) {
+            return fail(QObject::tr("Unexpected '%1'").arg(token.text));
+        }
+
+        // the tokenizer can fail without the parser noticing it
+        return plan->errorMessage.isEmpty() ? index : -1;
+    }
+
+private:
+    FilterPlan *plan;
+    QString expression;
+    int pos;
+    Token token;
+
+    int fail(const QString &message) {
+        if (plan->errorMessage.isEmpty()) {
+            plan->errorMessage = message;
+        }
+
+        return -1;
+    }
+
+    bool isKeyword(const QString &keyword) {
+        return token.type == WordToken &&
+                token.text.compare(keyword, Qt::CaseInsensitive) == 0;
+    }
+
+    /**
+     * Reads the next token of the expression
+     */
+    void next() {
+        while (pos < expression.length() && expression.at(pos).isSpace()) {
+            pos++;
+        }
+
+        token.text.clear();
+
+        if (pos >= expression.length()) {
+            token.type = EndToken;
+            return;
+        }
+
+        QChar c = expression.at(pos);
+
+        if (c == '(' || c == ')') {
+            token.type = c == '(' ? OpenToken : CloseToken;
+            token.text = c;
+            pos++;
+        } else if (c == '"' || c == '/') {
+            // strings and regular expressions end at the next unescaped
+            // delimiter, escapes of the delimiter are removed
+            token.type = c == '"' ? StringToken : RegexToken;
+            pos++;
+
+            while (pos < expression.length() && expression.at(pos) != c) {
+                if (expression.at(pos) == '\\' &&
+                        pos + 1 < expression.length() &&
+                        expression.at(pos + 1) == c) {
+                    pos++;
+                }
+
+                token.text += expression.at(pos++);
+            }
+
+            if (pos >= expression.length()) {
+                fail(c == '"' ?
+                     QObject::tr("Unterminated string \"%1").arg(token.text) :
+                     QObject::tr("Unterminated regular expression /%1")
+                             .arg(token.text));
+            }
+
+            pos++;
+        } else if (QString("=!~<>").contains(c)) {
+            token.type = OperatorToken;
+            token.text = c;
+            pos++;
+
+            if (pos < expression.length() && c != '=' && c != '~' &&
+                    QString("=~").contains(expression.at(pos))) {
+                token.text += expression.at(pos++);
+            }
+        } else {
+            token.type = WordToken;
+
+            while (pos < expression.length() &&
+                    !expression.at(pos).isSpace() &&
+                    !QString("()\"=!~<>").contains(expression.at(pos))) {
+                token.text += expression.at(pos++);
+            }
+        }
+    }
+
+    int addComposite(FilterPlan::NodeType type, const QList<int> &children) {
+        if (children.count() == 1 && type != FilterPlan::NotNode) {
+            return children.first();
+        }
+
+        FilterPlan::Node node;
+        node.type = type;
+        node.children = children;
+        node.subject = FilterPlan::LineSubject;
+        node.op = FilterPlan::EqualOperator;
+        node.negated = false;
+        node.fieldIndex = -1;
+        return plan->addNode(node);
+    }
+
+    int parseOr() {
+        QList<int> children;
+
+        forever {
+            int index = parseAnd();
+
+            if (index < 0) {
+                return -1;
+            }
+
+            children.append(index);
+
+            if (!isKeyword("OR")) {
+                return addComposite(FilterPlan::OrNode, children);
+            }
+
+            next();
+        }
+    }
+
+    int parseAnd() {
+        QList<int> children;
+
+        forever {
+            int index = parseUnary();
+
+            if (index < 0) {
+                return -1;
+            }
+
+            children.append(index);
+
+            if (!isKeyword("AND")) {
+                return addComposite(FilterPlan::AndNode, children);
+            }
+
+            next();
+        }
+    }
+
+    int parseUnary() {
+        if (isKeyword("NOT")) {
+            next();
+            int index = parseUnary();
+
+            return index < 0 ? -1 : addComposite(FilterPlan::NotNode,
+                                                 QList<int>() << index);
+        }
+
+        if (token.type == OpenToken) {
+            next();
+            int index = parseOr();
+
+            if (index < 0) {
+                return -1;
+            }
+
+            if (token.type != CloseToken) {
+                return fail(QObject::tr("Missing ')'"));
+            }
+
+            next();
+            return index;
+        }
+
+        return parsePredicate();
+    }
+
+    /**
+     * Parses a predicate like `level = error`, a bare string or regular
+     * expression is matched against the text of the line
+     */
+    int parsePredicate() {
+        FilterPlan::Node node;
+        node.type = FilterPlan::PredicateNode;
+        node.subject = FilterPlan::LineSubject;
+        node.negated = false;
+        node.fieldIndex = -1;
+        node.number = 0;
+        node.isNumber = false;
+        node.timestamp = Utils::Timestamp::Invalid;
+
+        if (token.type == StringToken || token.type == RegexToken) {
+            node.op = token.type == StringToken ?
+                      FilterPlan::ContainsOperator :
+                      FilterPlan::MatchOperator;
+            node.description = QString(token.type == StringToken ?
+                                       "line contains \"%1\"" :
+                                       "line ~ /%1/").arg(token.text);
+            QString value = token.text;
+            next();
+            return addPredicate(node, value);
+        }
+
+        if (token.type != WordToken) {
+            return fail(token.type == EndToken ?
+                        QObject::tr("Unexpected end of the expression") :
+                        QObject::tr("Unexpected '%1'").arg(token.text));
+        }
+
+        QString subject = token.text;
+        next();
+
+        if (subject == "line") {
+            node.subject = FilterPlan::LineSubject;
+        } else if (subject == "time") {
+            node.subject = FilterPlan::TimeSubject;
+        } else {
+            node.subject = FilterPlan::FieldSubject;
+            node.field = subject.toUtf8();
+        }
+
+        QString op = token.text;
+
+        if (isKeyword("contains")) {
+            node.op = FilterPlan::ContainsOperator;
+        } else if (token.type != OperatorToken) {
+            return fail(QObject::tr("Missing operator after '%1'")
+                                .arg(subject));
+        } else if (op == "=" || op == "!=") {
+            node.op = FilterPlan::EqualOperator;
+        } else if (op == "~" || op == "!~") {
+            node.op = FilterPlan::MatchOperator;
+        } else if (op == "<") {
+            node.op = FilterPlan::LessOperator;
+        } else if (op == "<=") {
+            node.op = FilterPlan::LessOrEqualOperator;
+        } else if (op == ">") {
+            node.op = FilterPlan::GreaterOperator;
+        } else if (op == ">=") {
+            node.op = FilterPlan::GreaterOrEqualOperator;
+        } else {
+            return fail(QObject::tr("Unknown operator '%1'").arg(op));
+        }
+
+        node.negated = op.startsWith('!');
+        next();
+
+        if (token.type != WordToken && token.type != StringToken &&
+                token.type != RegexToken) {
+            return fail(QObject::tr("Missing value after '%1 %2'")
+                                .arg(subject, op));
+        }
+
+        QString value = token.text;
+        node.description = QString("%1 %2 %3").arg(
+                subject, op, token.type == RegexToken ? "/" + value + "/" :
+                             token.type == StringToken ?
+                             "\"" + value + "\"" : value);
+        next();
+
+        if (node.subject == FilterPlan::LineSubject &&
+                node.op != FilterPlan::ContainsOperator &&
+                node.op != FilterPlan::MatchOperator) {
+            return fail(QObject::tr("The line can only be compared with "
+                                            "'contains' and '~'"));
+        }
+
+        if (node.subject == FilterPlan::TimeSubject) {
+            if (node.op == FilterPlan::ContainsOperator ||
+                    node.op == FilterPlan::MatchOperator) {
+                return fail(QObject::tr("The time can only be compared "
+                                                "with =, <, <=, > and >="));
+            }
+
+            node.timestamp = parseTime(value);
+
+            if (node.timestamp == Utils::Timestamp::Invalid) {
+                return fail(QObject::tr("'%1' isn't a time").arg(value));
+            }
+        }
+
+        return addPredicate(node, value);
+    }
+
+    /**
+     * Parses the time of a time predicate, dates and times without seconds
+     * like "2016-06-14" and "2016-06-14 11:00" are allowed too
+     */
+    static qint64 parseTime(const QString &value) {
+        QByteArray text = value.trimmed().toUtf8();
+
+        if (text.size() == 10) {
+            text += " 00:00:00";
+        } else if (text.size() == 16) {
+            text += ":00";
+        }
+
+        return Utils::Timestamp::parse(text);
+    }
+
+    int addPredicate(FilterPlan::Node &node, const QString &value) {
+        node.literal = value.toUtf8();
+        node.matcher.setPattern(node.literal);
+        node.number = value.toDouble(&node.isNumber);
+
+        if (node.op == FilterPlan::MatchOperator) {
+            node.expression = QRegularExpression(value);
+
+            if (!node.expression.isValid()) {
+                return fail(QObject::tr("Invalid regular expression '%1': %2")
+                                    .arg(value,
+                                         node.expression.errorString()));
+            }
+        }
+
+        // estimated costs until the plan is measured on a sample
+        switch (node.subject) {
+            case FilterPlan::TimeSubject:
+                node.cost = 20;
+                break;
+            case FilterPlan::LineSubject:
+                node.cost = node.op == FilterPlan::MatchOperator ? 1000 : 50;
+                break;
+            default:
+                node.cost = node.op == FilterPlan::MatchOperator ? 1200 : 200;
+        }
+
+        return plan->addNode(node);
+    }
+};
+
+FilterPlan::FilterPlan() {
+    root = -1;
+    format = Utils::LogFormat::UnknownFormat;
+}
+
+/**
+ * Parses a filter expression into a plan, the predicates are ordered by
+ * their estimated costs until optimize() measures them
+ */
+bool FilterPlan::compile(const QString &expression) {
+    nodes.clear();
+    errorMessage.clear();
+
+    FilterPlanParser parser(this, expression);
+    root = parser.parse();
+
+    if (root < 0) {
+        nodes.clear();
+        return false;
+    }
+
+    measure(root, QByteArray());
+    return true;
+}
+
+bool FilterPlan::isValid() const {
+    return root >= 0;
+}
+
+/**
+ * Returns if a predicate of the plan compares the time of the lines
+ */
+bool FilterPlan::hasTimePredicate() const {
+    Q_FOREACH(const Node &node, nodes) {
+            if (node.type == PredicateNode && node.subject == TimeSubject) {
+                return true;
+            }
+        }
+
+    return false;
+}
+
+/**
+ * Returns the timestamp of the last line of a block with one
+ */
+qint64 FilterPlan::lastTimestamp(const QByteArray &block) {
+    int end = block.size();
+
+    while (end > 0) {
+        int start = end > 1 ? block.lastIndexOf('\n', end - 2) + 1 : 0;
+        qint64 timestamp = Utils::Timestamp::parse(block.constData() + start,
+                                                   end - start);
+
+        if (timestamp != Utils::Timestamp::Invalid) {
+            return timestamp;
+        }
+
+        end = start;
+    }
+
+    return Utils::Timestamp::Invalid;
+}
+
+QString FilterPlan::getErrorMessage() const {
+    return errorMessage;
+}
+
+int FilterPlan::addNode(const Node &node) {
+    Node newNode = node;
+    newNode.selectivity = 0.5;
+
+    if (newNode.type != PredicateNode) {
+        newNode.cost = 0;
+    }
+
+    nodes.append(newNode);
+    return nodes.count() - 1;
+}
+
+/**
+ * Detects the log format of a sample and orders the predicates by their
+ * selectivity and cost on the lines of the sample
+ */
+void FilterPlan::optimize(const QByteArray &sample) {
+    if (!isValid()) {
+        return;
+    }
+
+    format = Utils::LogFormat::detect(sample);
+    QStringList fieldNames = Utils::LogFormat::fieldNames(format);
+
+    for (int i = 0; i < nodes.count(); i++) {
+        Node &node = nodes[i];
+
+        if (node.type == PredicateNode && node.subject == FieldSubject) {
+            node.fieldIndex = fieldNames.indexOf(
+                    QString::fromUtf8(node.field));
+        }
+    }
+
+    // only the first lines of the sample are measured
+    int end = -1;
+    for (int line = 0; line < FILTER_PLAN_SAMPLE_LINE_COUNT; line++) {
+        int next = sample.indexOf('\n', end + 1);
+
+        if (next == -1) {
+            end = sample.size() - 1;
+            break;
+        }
+
+        end = next;
+    }
+
+    measure(root, sample.left(end + 1));
+}
+
+/**
+ * Measures the selectivity and the cost of the predicates of a node on a
+ * sample (or keeps their estimates without a sample) and orders the
+ * children of its AND and OR nodes
+ *
+ * The children of an AND are ordered by cost / (1 - selectivity), so the
+ * predicates that remove the most lines for their cost run first, the
+ * children of an OR by cost / selectivity.
+ */
+void FilterPlan::measure(int index, const QByteArray &sample) {
+    Node &node = nodes[index];
+
+    if (node.type == PredicateNode) {
+        if (sample.isEmpty()) {
+            return;
+        }
+
+        // every predicate gets its own batch, so it pays for the parsing
+        Batch batch(sample, format);
+        QVector<int> selection;
+        for (int line = 0; line < batch.count(); line++) {
+            selection.append(line);
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        int selectedCount = select(index, batch, selection).count();
+        qint64 nsecs = timer.nsecsElapsed();
+        int count = qMax(1, batch.count());
+
+        node.selectivity = static_cast<double>(selectedCount) / count;
+        node.cost = qMax(1.0, static_cast<double>(nsecs) / count);
+        return;
+    }
+
+    QList<int> children = node.children;
+    Q_FOREACH(int child, children) {
+            measure(child, sample);
+        }
+
+    NodeType type = node.type;
+    const QVector<Node> &measuredNodes = nodes;
+
+    std::stable_sort(children.begin(), children.end(),
+                     [type, &measuredNodes](int a, int b) -> bool {
+                         const Node &nodeA = measuredNodes.at(a);
+                         const Node &nodeB = measuredNodes.at(b);
+                         double passA = type == AndNode ?
+                                        1 - nodeA.selectivity :
+                                        nodeA.selectivity;
+                         double passB = type == AndNode ?
+                                        1 - nodeB.selectivity :
+                                        nodeB.selectivity;
+                         return nodeA.cost / qMax(passA, 1e-9) <
+                                 nodeB.cost / qMax(passB, 1e-9);
+                     });
+
+    // the later children only see the lines the earlier ones left
+    double remaining = 1;
+    double cost = 0;
+
+    Q_FOREACH(int child, children) {
+            const Node &childNode = nodes.at(child);
+            cost += remaining * childNode.cost;
+            remaining *= type == AndNode ? childNode.selectivity :
+                         1 - childNode.selectivity;
+        }
+
+    Node &measuredNode = nodes[index];
+    measuredNode.children = children;
+    measuredNode.cost = cost;
+
+    switch (type) {
+        case AndNode:
+            measuredNode.selectivity = remaining;
+            break;
+        case OrNode:
+            measuredNode.selectivity = 1 - remaining;
+            break;
+        default:
+            measuredNode.selectivity = 1 - nodes.at(children.first())
+                    .selectivity;
+    }
+}
+
+/**
+ * Returns the lines of a selection a node selects, the selections are
+ * sorted lists of the lines of the batch
+ */
+QVector<int> FilterPlan::select(int index, Batch &batch,
+                                const QVector<int> &selection) const {
+    const Node &node = nodes.at(index);
+    QVector<int> result;
+
+    switch (node.type) {
+        case PredicateNode:
+            result.reserve(selection.count());
+
+            for (int i = 0; i < selection.count(); i++) {
+                if (matches(node, batch, selection.at(i))) {
+                    result.append(selection.at(i));
+                }
+            }
+            break;
+        case AndNode:
+            result = selection;
+
+            Q_FOREACH(int child, node.children) {
+                    if (result.isEmpty()) {
+                        break;
+                    }
+
+                    result = select(child, batch, result);
+                }
+            break;
+        case OrNode: {
+            // every child only needs to check the lines that weren't
+            // selected yet
+            QVector<int> remaining = selection;
+
+            Q_FOREACH(int child, node.children) {
+                    if (remaining.isEmpty()) {
+                        break;
+                    }
+
+                    QVector<int> selected = select(child, batch, remaining);
+                    result += selected;
+                    remaining = difference(remaining, selected);
+                }
+
+            std::sort(result.begin(), result.end());
+            break;
+        }
+        case NotNode:
+            result = difference(selection, select(node.children.first(),
+                                                  batch, selection));
+            break;
+    }
+
+    return result;
+}
+
+/**
+ * Compares a value of a line with the value of a predicate
+ */
+template <typename T>
+bool FilterPlan::compare(Operator op, const T &value, const T &other) {
+    switch (op) {
+        case LessOperator:
+            return value < other;
+        case LessOrEqualOperator:
+            return value <= other;
+        case GreaterOperator:
+            return value > other;
+        case GreaterOrEqualOperator:
+            return value >= other;
+        default:
+            return value == other;
+    }
+}
+
+/**
+ * Returns if a predicate matches a line of a batch
+ */
+bool FilterPlan::matches(const Node &node, Batch &batch, int line) const {
+    bool result = false;
+
+    switch (node.subject) {
+        case LineSubject: {
+            const char *text = batch.data + batch.offsets.at(line);
+            int length = batch.lengths.at(line);
+
+            result = node.op == ContainsOperator ?
+                     node.matcher.indexIn(text, length) != -1 :
+                     node.expression.match(QString::fromUtf8(text, length))
+                             .hasMatch();
+            break;
+        }
+        case TimeSubject: {
+            qint64 timestamp = batch.timestamp(line);
+
+            result = timestamp != Utils::Timestamp::Invalid &&
+                    compare(node.op, timestamp, node.timestamp);
+            break;
+        }
+        case FieldSubject: {
+            QByteArray value;
+
+            if (!batch.field(line, node.field, node.fieldIndex, value)) {
+                break;
+            }
+
+            switch (node.op) {
+                case ContainsOperator:
+                    result = node.matcher.indexIn(value) != -1;
+                    break;
+                case MatchOperator:
+                    result = node.expression.match(QString::fromUtf8(value))
+                            .hasMatch();
+                    break;
+                default: {
+                    // numbers are compared by their value
+                    bool ok = false;
+                    double number = node.isNumber ? value.toDouble(&ok) : 0;
+
+                    result = ok ? compare(node.op, number, node.number) :
+                             compare(node.op, value, node.literal);
+                }
+            }
+            break;
+        }
+    }
+
+    return result != node.negated;
+}
+
+/**
+ * Returns the lines of a block the plan selects
+ *
+ * The lines at the start of the block without timestamp get the timestamp
+ * previousTimestamp of the last line with one before the block.
+ */
+QByteArray FilterPlan::filterBlock(const QByteArray &block,
+                                   qint64 previousTimestamp) const {
+    if (!isValid()) {
+        return block;
+    }
+
+    Batch batch(block, format, previousTimestamp);
+    QVector<int> selection;
+    selection.reserve(batch.count());
+
+    for (int line = 0; line < batch.count(); line++) {
+        selection.append(line);
+    }
+
+    selection = select(root, batch, selection);
+
+    // the lines are kept with their original line breaks, the last line of
+    // the block may not have one
+    QByteArray result;
+    Q_FOREACH(int line, selection) {
+            int offset = batch.offsets.at(line);
+            int next = line + 1 < batch.count() ?
+                       batch.offsets.at(line + 1) : block.size();
+            result.append(block.constData() + offset, next - offset);
+        }
+
+    return result;
+}
+
+/**
+ * Returns the plan as indented text with the selectivity and cost of its
+ * nodes in the order they are evaluated
+ */
+QString FilterPlan::explain() const {
+    return isValid() ? explainNode(root, 0) : errorMessage;
+}
+
+QString FilterPlan::explainNode(int index, int depth) const {
+    const Node &node = nodes.at(index);
+    QString name;
+
+    switch (node.type) {
+        case AndNode:
+            name = "AND";
+            break;
+        case OrNode:
+            name = "OR";
+            break;
+        case NotNode:
+            name = "NOT";
+            break;
+        default:
+            name = node.description;
+    }
+
+    QString text = QString("%1%2 (%3% selected, %4 ns/line)\n")
+            .arg(QString(depth * 2, ' '), name)
+            .arg(node.selectivity * 100, 0, 'f', 1)
+            .arg(node.cost, 0, 'f', 0);
+
+    Q_FOREACH(int child, node.children) {
+            text += explainNode(child, depth + 1);
+        }
+
+    return text;
+}
+
+QDebug operator<<(QDebug dbg, const FilterPlan &filterPlan) {
+    dbg.nospace() << "FilterPlan: <format>" << filterPlan.format <<
+            " <plan>\n" << filterPlan.explain().toUtf8().constData();
+    return dbg.space();
+}
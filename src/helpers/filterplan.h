@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayMatcher>
+#include <QString>
+#include <QList>
+#include <QVector>
+#include <QRegularExpression>
+#include <QDebug>
+#include <utils/logformat.h>
+#include <utils/timestamp.h>
+
+// maximum number of lines of a sample that are used to measure the
+// predicates
+#define FILTER_PLAN_SAMPLE_LINE_COUNT 2000
+
+/**
+ * A filter expression that is compiled into a plan to select lines
+ *
+ * Expressions combine predicates with AND, OR, NOT and parentheses, like
+ *     level = error AND path !~ /health/ AND time >= "2016-06-14 11:00"
+ * Predicates compare the time of a line, the text of a line (line contains
+ * "text", line ~ /regex/) or the value of a field of JSON lines or another
+ * detected log format. A bare string or regex matches the text of a line.
+ * Times can be given without seconds or as a date. Lines without timestamp
+ * have the time of the previous line with one.
+ *
+ * The lines of a block are evaluated as a batch with selection vectors,
+ * every predicate only looks at the lines the previous predicates of an AND
+ * selected. The predicates are ordered by their selectivity and cost that
+ * are measured on a sample, so cheap and selective predicates run before
+ * the expensive regular expressions.
+ */
+class FilterPlan
+{
+public:
+    explicit FilterPlan();
+
+    bool compile(const QString &expression);
+    bool isValid() const;
+    bool hasTimePredicate() const;
+    QString getErrorMessage() const;
+    void optimize(const QByteArray &sample);
+    QByteArray filterBlock(
+            const QByteArray &block,
+            qint64 previousTimestamp = Utils::Timestamp::Invalid) const;
+    static qint64 lastTimestamp(const QByteArray &block);
+    QString explain() const;
+    friend QDebug operator<<(QDebug dbg, const FilterPlan &filterPlan);
+
+private:
+    enum NodeType {
+        AndNode,
+        OrNode,
+        NotNode,
+        PredicateNode
+    };
+
+    enum Subject {
+        LineSubject,
+        TimeSubject,
+        FieldSubject
+    };
+
+    enum Operator {
+        EqualOperator,
+        ContainsOperator,
+        MatchOperator,
+        LessOperator,
+        LessOrEqualOperator,
+        GreaterOperator,
+        GreaterOrEqualOperator
+    };
+
+    struct Node {
+        NodeType type;
+        QList<int> children;
+        Subject subject;
+        Operator op;
+        bool negated;
+        QByteArray field;
+        int fieldIndex;
+        QByteArray literal;
+        QByteArrayMatcher matcher;
+        QRegularExpression expression;
+        double number;
+        bool isNumber;
+        qint64 timestamp;
+        QString description;
+        // measured fraction of the lines the node selects and its cost in
+        // nanoseconds per line
+        double selectivity;
+        double cost;
+    };
+
+    struct Batch;
+
+    QVector<Node> nodes;
+    int root;
+    QString errorMessage;
+    Utils::LogFormat::Format format;
+
+    int addNode(const Node &node);
+    QVector<int> select(int index, Batch &batch,
+                        const QVector<int> &selection) const;
+    bool matches(const Node &node, Batch &batch, int line) const;
+    template <typename T>
+    static bool compare(Operator op, const T &value, const T &other);
+    void measure(int index, const QByteArray &sample);
+    QString explainNode(int index, int depth) const;
+
+    friend class FilterPlanParser;
+};
@@ -0,0 +1,247 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#include "frequencysketch.h"
+#include <QStringList>
+#include <qmath.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+    inline int leadingZeros(quint64 value) {
+        if (value == 0) {
+            return 64;
+        }
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return 63 - static_cast<int>(index);
+#else
+        return __builtin_clzll(value);
+#endif
+    }
+}
+
+FrequencySketch::FrequencySketch(int capacity) {
+    this->capacity = capacity;
+    totalCount = 0;
+    countMin.fill(0, FREQUENCY_SKETCH_COUNT_MIN_DEPTH *
+                     FREQUENCY_SKETCH_COUNT_MIN_WIDTH);
+    registers.fill(0, 1 << FREQUENCY_SKETCH_HLL_PRECISION);
+}
+
+/**
+ * Returns a 64 bit hash of a key (FNV-1a with a final mix of the bits)
+ */
+quint64 FrequencySketch::hash(const QString &key) {
+    quint64 value = Q_UINT64_C(14695981039346656037);
+    const ushort *data = key.utf16();
+
+    for (int i = 0; i < key.length(); i++) {
+        value ^= data[i];
+        value *= Q_UINT64_C(1099511628211);
+    }
+
+    value ^= value >> 33;
+    value *= Q_UINT64_C(0xff51afd7ed558ccd);
+    value ^= value >> 33;
+    value *= Q_UINT64_C(0xc4ceb9fe1a85ec53);
+    value ^= value >> 33;
+
+    return value;
+}
+
+/**
+ * Adds occurrences of a key
+ */
+void FrequencySketch::add(const QString &key, quint64 count) {
+    quint64 keyHash = hash(key);
+    totalCount += count;
+    quint64 estimate = addToCountMin(keyHash, count);
+    addToRegisters(keyHash);
+
+    QHash<QString, Counter>::iterator iterator = counters.find(key);
+
+    if (iterator != counters.end()) {
+        removeKey(key, iterator->count);
+        iterator->count += count;
+        insertKey(key, iterator->count);
+        return;
+    }
+
+    Counter counter;
+    counter.count = count;
+    counter.error = 0;
+
+    // the key replaces the key with the lowest count, which it could have
+    // had occurrences of
+    if (counters.count() >= capacity) {
+        quint64 lowestCount = keysByCount.firstKey();
+        QString lowestKey = *keysByCount.first().constBegin();
+        counter.error = lowestCount;
+        counter.count += lowestCount;
+        counters.remove(lowestKey);
+        removeKey(lowestKey, lowestCount);
+    }
+
+    // the Count-Min sketch never underestimates, so it can only lower the
+    // inherited error
+    if (counter.count > estimate) {
+        counter.error -= qMin(counter.error, counter.count - estimate);
+        counter.count = estimate;
+    }
+
+    counters.insert(key, counter);
+    insertKey(key, counter.count);
+}
+
+void FrequencySketch::insertKey(const QString &key, quint64 count) {
+    keysByCount[count].insert(key);
+}
+
+/**
+ * Removes a key from the keys with its count, counts without keys are
+ * removed
+ */
+void FrequencySketch::removeKey(const QString &key, quint64 count) {
+    QMap<quint64, QSet<QString> >::iterator keys = keysByCount.find(count);
+
+    if (keys == keysByCount.end()) {
+        return;
+    }
+
+    keys->remove(key);
+
+    if (keys->isEmpty()) {
+        keysByCount.erase(keys);
+    }
+}
+
+/**
+ * Returns the keys with the highest counts, highest first, keys with the
+ * same count are ordered by their text
+ */
+QList<FrequencySketch::Entry> FrequencySketch::topEntries(int count) const {
+    QList<Entry> entries;
+    QMapIterator<quint64, QSet<QString> > iterator(keysByCount);
+    iterator.toBack();
+
+    while (iterator.hasPrevious() && entries.count() < count) {
+        iterator.previous();
+
+        QStringList keys = iterator.value().toList();
+        keys.sort();
+
+        Q_FOREACH(QString key, keys) {
+                if (entries.count() >= count) {
+                    break;
+                }
+
+                Entry entry;
+                entry.key = key;
+                entry.count = iterator.key();
+                entry.error = counters.value(key).error;
+                entries.append(entry);
+            }
+    }
+
+    return entries;
+}
+
+quint64 FrequencySketch::getTotalCount() const {
+    return totalCount;
+}
+
+/**
+ * Returns the amount the Count-Min sketch overestimates a count by at most
+ * (with a probability of about 98%)
+ */
+quint64 FrequencySketch::getCountMinErrorBound() const {
+    return static_cast<quint64>(qCeil(
+            M_E * totalCount / FREQUENCY_SKETCH_COUNT_MIN_WIDTH));
+}
+
+/**
+ * Returns the HyperLogLog estimate of the number of distinct keys
+ */
+double FrequencySketch::distinctCount() const {
+    int registerCount = registers.count();
+    double sum = 0;
+    int zeroCount = 0;
+
+    for (int i = 0; i < registerCount; i++) {
+        sum += qPow(2, -registers.at(i));
+
+        if (registers.at(i) == 0) {
+            zeroCount++;
+        }
+    }
+
+    double alpha = 0.7213 / (1 + 1.079 / registerCount);
+    double estimate = alpha * registerCount * registerCount / sum;
+
+    // linear counting is more accurate for small cardinalities
+    if (estimate <= 2.5 * registerCount && zeroCount > 0) {
+        estimate = registerCount * qLn(
+                static_cast<double>(registerCount) / zeroCount);
+    }
+
+    return estimate;
+}
+
+/**
+ * Adds a count to the cells of a key in every row and returns the new
+ * estimate of its count
+ */
+quint64 FrequencySketch::addToCountMin(quint64 keyHash, quint64 count) {
+    // the cells of the rows are derived from two halves of the hash
+    quint64 hash1 = keyHash & 0xffffffff;
+    quint64 hash2 = keyHash >> 32;
+    quint64 estimate = Q_UINT64_C(0xffffffffffffffff);
+
+    for (int row = 0; row < FREQUENCY_SKETCH_COUNT_MIN_DEPTH; row++) {
+        int column = static_cast<int>((hash1 + row * hash2) %
+                                      FREQUENCY_SKETCH_COUNT_MIN_WIDTH);
+        quint64 &cell = countMin[row * FREQUENCY_SKETCH_COUNT_MIN_WIDTH +
+                                 column];
+        cell += count;
+        estimate = qMin(estimate, cell);
+    }
+
+    return estimate;
+}
+
+void FrequencySketch::addToRegisters(quint64 keyHash) {
+    int index = static_cast<int>(
+            keyHash >> (64 - FREQUENCY_SKETCH_HLL_PRECISION));
+    quint64 remainingBits = keyHash << FREQUENCY_SKETCH_HLL_PRECISION;
+    quint8 rank = static_cast<quint8>(qMin(
+            leadingZeros(remainingBits) + 1,
+            64 - FREQUENCY_SKETCH_HLL_PRECISION + 1));
+
+    if (rank > registers.at(index)) {
+        registers[index] = rank;
+    }
+}
+
+QDebug operator<<(QDebug dbg, const FrequencySketch &sketch) {
+    dbg.nospace() << "FrequencySketch: <capacity>" << sketch.capacity <<
+            " <totalCount>" << sketch.totalCount << " <counters>" <<
+            sketch.counters.count() << " <distinctCount>" <<
+            sketch.distinctCount();
+    return dbg.space();
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#pragma once
+
+#include <QString>
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <QList>
+#include <QVector>
+#include <QDebug>
+
+// number of keys the Space-Saving summary keeps counters for
+#define FREQUENCY_SKETCH_DEFAULT_CAPACITY 1000
+
+// number of rows and columns of the Count-Min sketch
+#define FREQUENCY_SKETCH_COUNT_MIN_DEPTH 4
+#define FREQUENCY_SKETCH_COUNT_MIN_WIDTH 4096
+
+// number of index bits of the HyperLogLog registers (16384 registers with a
+// standard error of about 0.8%)
+#define FREQUENCY_SKETCH_HLL_PRECISION 14
+
+/**
+ * Counts the most frequent keys of a stream and its number of distinct keys
+ * in a fixed amount of memory
+ *
+ * A Space-Saving summary keeps counters for `capacity` keys. A new key
+ * replaces the key with the lowest count and inherits its count as error. A
+ * Count-Min sketch gives a second upper bound of every count, and the lower
+ * of both is reported. A HyperLogLog estimates the number of distinct keys.
+ */
+class FrequencySketch
+{
+public:
+    struct Entry {
+        QString key;
+        // upper bound of the number of occurrences of the key
+        quint64 count;
+        // the key occurred at least count - error times
+        quint64 error;
+    };
+
+    explicit FrequencySketch(int capacity = FREQUENCY_SKETCH_DEFAULT_CAPACITY);
+
+    void add(const QString &key, quint64 count = 1);
+    QList<Entry> topEntries(int count) const;
+    quint64 getTotalCount() const;
+    quint64 getCountMinErrorBound() const;
+    double distinctCount() const;
+    static quint64 hash(const QString &key);
+    friend QDebug operator<<(QDebug dbg, const FrequencySketch &sketch);
+
+private:
+    struct Counter {
+        quint64 count;
+        quint64 error;
+    };
+
+    int capacity;
+    quint64 totalCount;
+    QHash<QString, Counter> counters;
+    // the keys of the counters grouped by their count, to find the lowest
+    // count and to move a key to another count without scanning the keys
+    // that share its count
+    QMap<quint64, QSet<QString> > keysByCount;
+    QVector<quint64> countMin;
+    QVector<quint8> registers;
+
+    void insertKey(const QString &key, quint64 count);
+    void removeKey(const QString &key, quint64 count);
+    quint64 addToCountMin(quint64 keyHash, quint64 count);
+    void addToRegisters(quint64 keyHash);
+};
@@ -0,0 +1,628 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+#include "gzipindex.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QDataStream>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QtConcurrent>
+#include <QThread>
+#include <functional>
+#include <stdexcept>
+#include <climits>
+#include <string.h>
+#include <utils/gzip.h>
+
+#include "libraries/miniz/miniz.h"
+
+// magic number and version of the persisted index files
+#define GZIP_INDEX_MAGIC 0x4c41475a
+#define GZIP_INDEX_VERSION 3
+
+// amount of compressed data that is read from the file at once
+#define GZIP_INDEX_INPUT_CHUNK_SIZE (256 * 1024)
+
+// size of the crc32 and isize trailer of every gzip member
+#define GZIP_TRAILER_SIZE 8
+
+// maximum amount of uncompressed data that can be read into a QByteArray
+#define GZIP_INDEX_MAX_READ_SIZE (INT_MAX - 1024)
+
+namespace {
+    /**
+     * The complete state of an inflate run through a gzip file
+     */
+    struct InflateState {
+        tinfl_decompressor inflator;
+        mz_uint8 window[TINFL_LZ_DICT_SIZE];
+        size_t windowOffset;
+        qint64 inOffset;
+        qint64 outOffset;
+        bool atMemberStart;
+    };
+
+    // receives the uncompressed data, returning false stops inflating
+    typedef std::function<bool(const char *data, size_t size,
+                               const InflateState &state)> InflateSink;
+
+    QByteArray compressBlock(const QByteArray &block) {
+        return Utils::Gzip::compress(block);
+    }
+
+    void restoreCheckpoint(InflateState *state,
+                           const GzipIndex::Checkpoint &checkpoint) {
+        state->inOffset = checkpoint.inOffset;
+        state->outOffset = checkpoint.outOffset;
+        state->windowOffset = checkpoint.windowOffset;
+        state->atMemberStart = checkpoint.state.isEmpty();
+
+        if (!state->atMemberStart) {
+            if (checkpoint.state.size() != sizeof(tinfl_decompressor) ||
+                    checkpoint.window.size() != TINFL_LZ_DICT_SIZE) {
+                throw std::runtime_error("invalid gzip index checkpoint");
+            }
+
+            memcpy(&state->inflator, checkpoint.state.constData(),
+                   sizeof(tinfl_decompressor));
+            memcpy(state->window, checkpoint.window.constData(),
+                   TINFL_LZ_DICT_SIZE);
+        }
+    }
+
+    GzipIndex::Checkpoint createCheckpoint(const InflateState &state) {
+        GzipIndex::Checkpoint checkpoint;
+        checkpoint.inOffset = state.inOffset;
+        checkpoint.outOffset = state.outOffset;
+        checkpoint.windowOffset = static_cast<quint32>(state.windowOffset);
+
+        if (!state.atMemberStart) {
+            checkpoint.state = QByteArray(
+                    reinterpret_cast<const char *>(&state.inflator),
+                    sizeof(tinfl_decompressor));
+            checkpoint.window = QByteArray(
+                    reinterpret_cast<const char *>(state.window),
+                    TINFL_LZ_DICT_SIZE);
+        }
+
+        return checkpoint;
+    }
+
+    /**
+     * Inflates the gzip members of a device starting at the position of the
+     * state until the end of the data or until the sink returns false
+     *
+     * The sink is also called with no data at the start of every member, so
+     * the state can be saved there without a window.
+     */
+    void inflate(QIODevice *device, InflateState *state,
+                 const InflateSink &sink) {
+        QByteArray input;
+        int inputPos = 0;
+        bool inputAtEnd = false;
+
+        if (!device->seek(state->inOffset)) {
+            throw std::runtime_error("could not seek in gzip file");
+        }
+
+        forever {
+            if (state->atMemberStart) {
+                input = device->read(GZIP_INDEX_INPUT_CHUNK_SIZE);
+                inputAtEnd = device->atEnd();
+                int headerSize = Utils::Gzip::memberHeaderSize(input);
+
+                if (headerSize < 0) {
+                    // trailing garbage after the first member is ignored,
+                    // like gzip does
+                    if (state->inOffset == 0) {
+                        throw std::runtime_error("no valid gzip header found");
+                    }
+
+                    return;
+                }
+
+                if (!sink(NULL, 0, *state)) {
+                    return;
+                }
+
+                tinfl_init(&state->inflator);
+                state->windowOffset = 0;
+                state->atMemberStart = false;
+                state->inOffset += headerSize;
+                inputPos = headerSize;
+            } else if (inputPos == input.size() && !inputAtEnd) {
+                input = device->read(GZIP_INDEX_INPUT_CHUNK_SIZE);
+                inputPos = 0;
+                inputAtEnd = device->atEnd();
+            }
+
+            size_t inSize = static_cast<size_t>(input.size() - inputPos);
+            size_t outSize = TINFL_LZ_DICT_SIZE - state->windowOffset;
+            mz_uint8 *outPtr = state->window + state->windowOffset;
+
+            tinfl_status status = tinfl_decompress(
+                    &state->inflator,
+                    reinterpret_cast<const mz_uint8 *>(input.constData()) +
+                            inputPos,
+                    &inSize,
+                    state->window,
+                    outPtr,
+                    &outSize,
+                    inputAtEnd ? 0 : TINFL_FLAG_HAS_MORE_INPUT);
+
+            inputPos += static_cast<int>(inSize);
+            state->inOffset += inSize;
+            state->outOffset += outSize;
+            state->windowOffset = (state->windowOffset + outSize) &
+                                  (TINFL_LZ_DICT_SIZE - 1);
+
+            if (outSize > 0 &&
+                    !sink(reinterpret_cast<const char *>(outPtr), outSize,
+                          *state)) {
+                return;
+            }
+
+            switch (status) {
+                case TINFL_STATUS_DONE:
+                    // tinfl reads ahead into its bit buffer, the whole bytes
+                    // that are left there already belong to the trailer
+                    state->inOffset += GZIP_TRAILER_SIZE -
+                            static_cast<qint64>(
+                                    state->inflator.m_num_bits >> 3);
+                    state->atMemberStart = true;
+
+                    if (!device->seek(state->inOffset)) {
+                        return;
+                    }
+                    break;
+                case TINFL_STATUS_NEEDS_MORE_INPUT:
+                    if (inputAtEnd) {
+                        throw std::runtime_error("gzip file is truncated");
+                    }
+                    break;
+                case TINFL_STATUS_HAS_MORE_OUTPUT:
+                    break;
+                default:
+                    throw std::runtime_error(
+                            "error decompressing gzipped content");
+            }
+        }
+    }
+
+    /**
+     * Decompresses the region between two checkpoints, used to decompress
+     * the regions of a gzip file in parallel
+     */
+    struct RegionReader {
+        typedef QByteArray result_type;
+
+        GzipIndex *index;
+
+        explicit RegionReader(GzipIndex *index) : index(index) {}
+
+        QByteArray operator()(int checkpointIndex) {
+            return index->readRegion(checkpointIndex);
+        }
+    };
+}
+
+GzipIndex::GzipIndex() {
+    filePath = "";
+    fileSize = 0;
+    fileMTime = 0;
+    span = GZIP_INDEX_DEFAULT_SPAN;
+    uncompressedSize = 0;
+}
+
+QString GzipIndex::getFilePath() {
+    return this->filePath;
+}
+
+qint64 GzipIndex::getUncompressedSize() {
+    return this->uncompressedSize;
+}
+
+QList<GzipIndex::Checkpoint> GzipIndex::getCheckpoints() {
+    return this->checkpoints;
+}
+
+/**
+ * Decompresses a gzip file once and creates a checkpoint every span bytes
+ * of uncompressed data
+ *
+ * If an output function is set it is called with the uncompressed data
+ * piece by piece, so the file doesn't need to be decompressed a second time
+ * if its data is also needed.
+ * Throws a std::runtime_error if the file can't be decompressed.
+ */
+GzipIndex GzipIndex::build(QString filePath, Output output, qint64 span) {
+    QFile file(filePath);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw std::runtime_error(file.errorString().toStdString());
+    }
+
+    QFileInfo fileInfo(file);
+    GzipIndex gzipIndex;
+    gzipIndex.filePath = fileInfo.absoluteFilePath();
+    gzipIndex.fileSize = fileInfo.size();
+    gzipIndex.fileMTime = fileInfo.lastModified().toTime_t();
+    gzipIndex.span = span;
+
+    InflateState state;
+    state.inOffset = 0;
+    state.outOffset = 0;
+    state.windowOffset = 0;
+    state.atMemberStart = true;
+
+    qint64 nextCheckpointOffset = 0;
+
+    inflate(&file, &state,
+            [&](const char *buffer, size_t size,
+                const InflateState &current) {
+                // the state already includes the buffer
+                if (current.outOffset >= nextCheckpointOffset) {
+                    gzipIndex.checkpoints.append(createCheckpoint(current));
+                    nextCheckpointOffset = current.outOffset + span;
+                }
+
+                if (output && size > 0) {
+                    output(buffer, static_cast<int>(size));
+                }
+
+                return true;
+            });
+
+    gzipIndex.uncompressedSize = state.outOffset;
+    file.close();
+
+    qDebug() << __func__ << " - 'gzipIndex': " << gzipIndex;
+
+    return gzipIndex;
+}
+
+/**
+ * Fetches the persisted index of a gzip file
+ */
+GzipIndex GzipIndex::fetch(QString filePath) {
+    GzipIndex gzipIndex;
+    QFile file(indexFilePath(filePath));
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return gzipIndex;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_3);
+
+    quint32 magic, version, stateSize;
+    in >> magic >> version >> stateSize;
+
+    // the inflater state can only be restored by the same build
+    if (magic != GZIP_INDEX_MAGIC || version != GZIP_INDEX_VERSION ||
+            stateSize != sizeof(tinfl_decompressor)) {
+        return gzipIndex;
+    }
+
+    GzipIndex storedIndex;
+    qint32 checkpointCount;
+    in >> storedIndex.filePath >> storedIndex.fileSize
+       >> storedIndex.fileMTime >> storedIndex.span
+       >> storedIndex.uncompressedSize >> checkpointCount;
+
+    for (int i = 0; i < checkpointCount && in.status() == QDataStream::Ok;
+         i++) {
+        Checkpoint checkpoint;
+        in >> checkpoint.inOffset >> checkpoint.outOffset
+           >> checkpoint.windowOffset >> checkpoint.state
+           >> checkpoint.window;
+        storedIndex.checkpoints.append(checkpoint);
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        qWarning() << __func__ << " - 'corrupt index file': "
+                   << file.fileName();
+        return gzipIndex;
+    }
+
+    return storedIndex;
+}
+
+/**
+ * Returns the path of the persisted index of a gzip file in the cache
+ * directory
+ */
+QString GzipIndex::indexFilePath(QString filePath) {
+    QString path = QStandardPaths::writableLocation(
+            QStandardPaths::CacheLocation) + QDir::separator() + "gzipIndex";
+    QDir dir;
+
+    // create path if it doesn't exist yet
+    dir.mkpath(path);
+
+    QByteArray hash = QCryptographicHash::hash(
+            QFileInfo(filePath).absoluteFilePath().toUtf8(),
+            QCryptographicHash::Sha1).toHex();
+
+    return path + QDir::separator() + QString(hash) + ".idx";
+}
+
+/**
+ * Decompresses a gzip file and calls output with the uncompressed data
+ * piece by piece, so files of any size can be decompressed
+ *
+ * If there is a current index for the file its regions are decompressed in
+ * parallel, otherwise the index is built and stored while decompressing.
+ * Throws a std::runtime_error if the file can't be decompressed.
+ */
+void GzipIndex::uncompressFile(QString filePath, Output output) {
+    GzipIndex gzipIndex = fetch(filePath);
+
+    if (gzipIndex.isCurrent()) {
+        gzipIndex.readAll(output);
+        return;
+    }
+
+    gzipIndex = build(filePath, output);
+    gzipIndex.store();
+}
+
+/**
+ * Writes data as block compressed gzip file and stores its index
+ *
+ * The data is split into blocks at line boundaries, which are compressed in
+ * parallel on the global thread pool. The index only knows the offsets of
+ * the blocks, they are used to decompress the file in parallel, lines can't
+ * be looked up in it. Throws a std::runtime_error if the file can't be
+ * written.
+ */
+GzipIndex GzipIndex::writeBlockCompressedFile(QString filePath,
+                                              const QByteArray &data,
+                                              int blockSize) {
+    QList<QByteArray> blocks;
+    int pos = 0;
+
+    while (pos < data.size()) {
+        int end = data.indexOf('\n', qMin(pos + blockSize, data.size()) - 1);
+        end = end == -1 ? data.size() : end + 1;
+        blocks.append(data.mid(pos, end - pos));
+        pos = end;
+    }
+
+    // empty files also need a gzip member
+    if (blocks.isEmpty()) {
+        blocks.append(QByteArray());
+    }
+
+    QList<QByteArray> compressedBlocks =
+            QtConcurrent::blockingMapped(blocks, compressBlock);
+
+    QFile file(filePath);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        throw std::runtime_error(file.errorString().toStdString());
+    }
+
+    GzipIndex gzipIndex;
+    gzipIndex.span = blockSize;
+    qint64 outOffset = 0;
+
+    for (int i = 0; i < blocks.count(); i++) {
+        // every member starts at a line, so no window is needed
+        Checkpoint checkpoint;
+        checkpoint.inOffset = file.pos();
+        checkpoint.outOffset = outOffset;
+        checkpoint.windowOffset = 0;
+        gzipIndex.checkpoints.append(checkpoint);
+
+        if (file.write(compressedBlocks.at(i)) !=
+                compressedBlocks.at(i).size()) {
+            throw std::runtime_error(file.errorString().toStdString());
+        }
+
+        outOffset += blocks.at(i).size();
+    }
+
+    file.close();
+
+    QFileInfo fileInfo(filePath);
+    gzipIndex.filePath = fileInfo.absoluteFilePath();
+    gzipIndex.fileSize = fileInfo.size();
+    gzipIndex.fileMTime = fileInfo.lastModified().toTime_t();
+    gzipIndex.uncompressedSize = outOffset;
+    gzipIndex.store();
+
+    return gzipIndex;
+}
+
+/**
+ * Stores the index in the cache directory
+ */
+bool GzipIndex::store() {
+    if (!isValid()) {
+        return false;
+    }
+
+    QFile file(indexFilePath(filePath));
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << __func__ << ": " << file.errorString();
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_3);
+
+    out << static_cast<quint32>(GZIP_INDEX_MAGIC)
+        << static_cast<quint32>(GZIP_INDEX_VERSION)
+        << static_cast<quint32>(sizeof(tinfl_decompressor))
+        << filePath << fileSize << fileMTime << span << uncompressedSize
+        << static_cast<qint32>(checkpoints.count());
+
+    Q_FOREACH(Checkpoint checkpoint, checkpoints) {
+            out << checkpoint.inOffset << checkpoint.outOffset
+                << checkpoint.windowOffset << checkpoint.state
+                << checkpoint.window;
+        }
+
+    return out.status() == QDataStream::Ok;
+}
+
+/**
+ * Removes the persisted index
+ */
+bool GzipIndex::remove() {
+    QFile file(indexFilePath(filePath));
+    return !file.exists() || file.remove();
+}
+
+bool GzipIndex::isValid() {
+    return !filePath.isEmpty() && !checkpoints.isEmpty();
+}
+
+/**
+ * Checks if the gzip file didn't change since the index was built
+ */
+bool GzipIndex::isCurrent() {
+    if (!isValid()) {
+        return false;
+    }
+
+    QFileInfo fileInfo(filePath);
+
+    return fileInfo.isFile() && fileInfo.size() == fileSize &&
+           fileInfo.lastModified().toTime_t() == fileMTime;
+}
+
+/**
+ * Returns the index of the last checkpoint before offset
+ */
+int GzipIndex::checkpointIndexForOffset(qint64 offset) {
+    int low = 0;
+    int high = checkpoints.count() - 1;
+
+    while (low < high) {
+        int middle = (low + high + 1) / 2;
+
+        if (checkpoints.at(middle).outOffset <= offset) {
+            low = middle;
+        } else {
+            high = middle - 1;
+        }
+    }
+
+    return low;
+}
+
+/**
+ * Reads length bytes of uncompressed data starting at offset
+ *
+ * Only the data from the nearest checkpoint on needs to be decompressed.
+ * Throws a std::runtime_error if the file can't be decompressed or if the
+ * range doesn't fit into a QByteArray.
+ */
+QByteArray GzipIndex::read(qint64 offset, qint64 length) {
+    QByteArray result;
+
+    if (!isValid() || offset >= uncompressedSize || length <= 0) {
+        return result;
+    }
+
+    const qint64 end = qMin(offset + length, uncompressedSize);
+
+    if (end - offset > GZIP_INDEX_MAX_READ_SIZE) {
+        throw std::runtime_error("gzip range is too large to be read");
+    }
+
+    QFile file(filePath);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw std::runtime_error(file.errorString().toStdString());
+    }
+
+    result.reserve(static_cast<int>(end - offset));
+
+    InflateState state;
+    restoreCheckpoint(&state,
+                      checkpoints.at(checkpointIndexForOffset(offset)));
+
+    inflate(&file, &state,
+            [&](const char *buffer, size_t size,
+                const InflateState &current) {
+                qint64 bufferStart =
+                        current.outOffset - static_cast<qint64>(size);
+                qint64 from = qMax(offset, bufferStart);
+                qint64 to = qMin(end, current.outOffset);
+
+                if (to > from) {
+                    result.append(buffer + (from - bufferStart),
+                                  static_cast<int>(to - from));
+                }
+
+                return current.outOffset < end;
+            });
+
+    file.close();
+    return result;
+}
+
+/**
+ * Decompresses the data from a checkpoint until the next checkpoint
+ */
+QByteArray GzipIndex::readRegion(int checkpointIndex) {
+    qint64 offset = checkpoints.at(checkpointIndex).outOffset;
+    qint64 end = checkpointIndex + 1 < checkpoints.count() ?
+                 checkpoints.at(checkpointIndex + 1).outOffset :
+                 uncompressedSize;
+
+    return read(offset, end - offset);
+}
+
+/**
+ * Decompresses the whole file and calls output with the regions between the
+ * checkpoints in their order
+ *
+ * The regions are decompressed in parallel on the global thread pool, only
+ * a few of them at a time, so the file is never held in memory at once.
+ */
+void GzipIndex::readAll(Output output) {
+    const int batchSize = QThread::idealThreadCount();
+
+    for (int start = 0; start < checkpoints.count(); start += batchSize) {
+        QList<int> regions;
+
+        for (int i = start;
+             i < qMin(start + batchSize, checkpoints.count()); i++) {
+            regions.append(i);
+        }
+
+        QList<QByteArray> results =
+                QtConcurrent::blockingMapped(regions, RegionReader(this));
+
+        Q_FOREACH(QByteArray result, results) {
+                output(result.constData(), result.size());
+            }
+    }
+}
+
+QDebug operator<<(QDebug dbg, const GzipIndex &gzipIndex) {
+    dbg.nospace() << "GzipIndex: <filePath>" << gzipIndex.filePath <<
+            " <fileSize>" << gzipIndex.fileSize <<
+            " <uncompressedSize>" << gzipIndex.uncompressedSize <<
+            " <checkpoints>" << gzipIndex.checkpoints.count();
+    return dbg.space();
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QList>
+#include <QDebug>
+#include <functional>
+
+// amount of uncompressed data between two checkpoints
+#define GZIP_INDEX_DEFAULT_SPAN (16 * 1024 * 1024)
+
+// amount of uncompressed data in a block of a block compressed file
+#define GZIP_INDEX_DEFAULT_BLOCK_SIZE (1024 * 1024)
+
+/**
+ * A checkpoint index for random access into gzip files (like the zran
+ * example of zlib)
+ *
+ * While the file is decompressed once, the state of the inflater and its
+ * 32KB window are saved every `span` bytes of output. Later reads can resume
+ * at the nearest checkpoint instead of decompressing from the start, and the
+ * regions between checkpoints can be decompressed in parallel.
+ *
+ * Indexes are persisted in the cache directory and are rebuilt if the size or
+ * the modification time of the gzip file changes.
+ *
+ * Block compressed files consist of independently compressed gzip members
+ * that start at line boundaries, every member is a checkpoint without a
+ * window. They are still valid gzip files for other tools.
+ */
+class GzipIndex
+{
+public:
+    struct Checkpoint {
+        // position in the gzip file to continue reading from
+        qint64 inOffset;
+        // position in the uncompressed data
+        qint64 outOffset;
+        // position of the next output byte in the window
+        quint32 windowOffset;
+        // snapshot of the inflater, empty at the start of a gzip member
+        QByteArray state;
+        QByteArray window;
+    };
+
+    typedef std::function<void(const char *buffer, int size)> Output;
+
+    explicit GzipIndex();
+
+    static GzipIndex build(QString filePath, Output output = Output(),
+                           qint64 span = GZIP_INDEX_DEFAULT_SPAN);
+    static GzipIndex fetch(QString filePath);
+    static QString indexFilePath(QString filePath);
+    static void uncompressFile(QString filePath, Output output);
+    static GzipIndex writeBlockCompressedFile(
+            QString filePath, const QByteArray &data,
+            int blockSize = GZIP_INDEX_DEFAULT_BLOCK_SIZE);
+    bool store();
+    bool remove();
+    bool isValid();
+    bool isCurrent();
+    QString getFilePath();
+    qint64 getUncompressedSize();
+    QList<Checkpoint> getCheckpoints();
+    QByteArray read(qint64 offset, qint64 length);
+    void readAll(Output output);
+    QByteArray readRegion(int checkpointIndex);
+    friend QDebug operator<<(QDebug dbg, const GzipIndex &gzipIndex);
+
+private:
+    QString filePath;
+    qint64 fileSize;
+    uint fileMTime;
+    qint64 span;
+    qint64 uncompressedSize;
+    QList<Checkpoint> checkpoints;
+
+    int checkpointIndexForOffset(qint64 offset);
+};
@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#include "hashjoin.h"
+#include <QDataStream>
+#include <QDir>
+#include <QObject>
+#include <climits>
+
+namespace {
+    QDataStream &operator<<(QDataStream &stream, const JoinRecord &record) {
+        return stream << record.key << record.source << record.line <<
+                record.timestamp << record.text;
+    }
+
+    QDataStream &operator>>(QDataStream &stream, JoinRecord &record) {
+        return stream >> record.key >> record.source >> record.line >>
+                record.timestamp >> record.text;
+    }
+}
+
+HashJoin::HashJoin(MatchFunction matchFunction, qint64 memoryLimit,
+                   int partitionCount) {
+    this->matchFunction = matchFunction;
+    this->memoryLimit = memoryLimit;
+    this->partitionCount = qMax(1, partitionCount);
+    memorySize = 0;
+}
+
+/**
+ * Removes the partition files
+ */
+HashJoin::~HashJoin() {
+    qDeleteAll(buildPartitionFiles);
+    qDeleteAll(probePartitionFiles);
+}
+
+/**
+ * Adds a record of the build side, all of them have to be added before the
+ * first record of the probe side
+ */
+void HashJoin::addBuildRecord(const JoinRecord &record) {
+    if (hasSpilled()) {
+        writeRecord(buildPartitionFiles, record);
+        return;
+    }
+
+    addToBuildEntries(record);
+    memorySize += recordSize(record);
+
+    if (memorySize > memoryLimit) {
+        spill();
+    }
+}
+
+/**
+ * Adds a record of the probe side, it's matched right away unless the join
+ * spilled
+ */
+void HashJoin::addProbeRecord(const JoinRecord &record) {
+    if (hasSpilled()) {
+        writeRecord(probePartitionFiles, record);
+        return;
+    }
+
+    matchProbeRecord(record);
+}
+
+/**
+ * Matches the records of the partitions if the join spilled, only the build
+ * records of one partition are held in memory at once
+ *
+ * Returns false if a partition file couldn't be written or read.
+ */
+bool HashJoin::finish() {
+    if (!hasSpilled()) {
+        return errorMessage.isEmpty();
+    }
+
+    for (int i = 0; i < partitionCount && errorMessage.isEmpty(); i++) {
+        buildEntries.clear();
+        QList<JoinRecord> buildRecords;
+
+        if (!readRecords(buildPartitionFiles.at(i), &buildRecords)) {
+            break;
+        }
+
+        Q_FOREACH(const JoinRecord &record, buildRecords) {
+                addToBuildEntries(record);
+            }
+
+        buildRecords.clear();
+
+        QTemporaryFile *probeFile = probePartitionFiles.at(i);
+        probeFile->flush();
+        probeFile->seek(0);
+        QDataStream stream(probeFile);
+
+        while (!stream.atEnd()) {
+            JoinRecord record;
+            stream >> record;
+
+            if (stream.status() != QDataStream::Ok) {
+                errorMessage = QObject::tr("Partition file '%1' could not "
+                                                   "be read")
+                        .arg(probeFile->fileName());
+                break;
+            }
+
+            matchProbeRecord(record);
+        }
+    }
+
+    buildEntries.clear();
+
+    return errorMessage.isEmpty();
+}
+
+bool HashJoin::hasSpilled() const {
+    return !buildPartitionFiles.isEmpty();
+}
+
+QString HashJoin::getErrorMessage() const {
+    return errorMessage;
+}
+
+/**
+ * Adds a record to the entry of its key in the hash table
+ */
+void HashJoin::addToBuildEntries(const JoinRecord &record) {
+    QHash<QByteArray, BuildEntry>::iterator iterator =
+            buildEntries.find(record.key);
+
+    if (iterator == buildEntries.end()) {
+        BuildEntry entry;
+        entry.matched = false;
+        iterator = buildEntries.insert(record.key, entry);
+    }
+
+    iterator.value().records.append(record);
+}
+
+/**
+ * Calls the match function if there are build records with the key of a
+ * probe record
+ */
+void HashJoin::matchProbeRecord(const JoinRecord &record) {
+    QHash<QByteArray, BuildEntry>::iterator iterator =
+            buildEntries.find(record.key);
+
+    if (iterator == buildEntries.end()) {
+        return;
+    }
+
+    bool firstMatch = !iterator.value().matched;
+    iterator.value().matched = true;
+    matchFunction(iterator.value().records, record, firstMatch);
+}
+
+/**
+ * Moves the build records into the partition files, the records that follow
+ * are written there too
+ *
+ * If the files can't be created the records stay in memory.
+ */
+void HashJoin::spill() {
+    if (!openPartitionFiles(&buildPartitionFiles) ||
+            !openPartitionFiles(&probePartitionFiles)) {
+        qWarning() << __func__ << " - " << errorMessage;
+        qDeleteAll(buildPartitionFiles);
+        qDeleteAll(probePartitionFiles);
+        buildPartitionFiles.clear();
+        probePartitionFiles.clear();
+
+        // don't try again
+        memoryLimit = LLONG_MAX;
+        errorMessage.clear();
+        return;
+    }
+
+    qDebug() << __func__ << " - 'memorySize': " << memorySize;
+
+    Q_FOREACH(const BuildEntry &entry, buildEntries) {
+            Q_FOREACH(const JoinRecord &record, entry.records) {
+                    writeRecord(buildPartitionFiles, record);
+                }
+        }
+
+    buildEntries.clear();
+    memorySize = 0;
+}
+
+/**
+ * Creates a temporary file for every partition
+ */
+bool HashJoin::openPartitionFiles(QList<QTemporaryFile *> *files) {
+    for (int i = 0; i < partitionCount; i++) {
+        QTemporaryFile *file = new QTemporaryFile(
+                QDir::tempPath() + "/loganalyzer-join-XXXXXX");
+        files->append(file);
+
+        if (!file->open()) {
+            errorMessage = QObject::tr("Partition file could not be "
+                                               "created: %1")
+                    .arg(file->errorString());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Writes a record to the partition file of its key
+ */
+void HashJoin::writeRecord(QList<QTemporaryFile *> &files,
+                           const JoinRecord &record) {
+    QTemporaryFile *file = files.at(
+            static_cast<int>(qHash(record.key) % partitionCount));
+    QDataStream stream(file);
+    stream << record;
+
+    if (stream.status() != QDataStream::Ok && errorMessage.isEmpty()) {
+        errorMessage = QObject::tr("Partition file '%1' could not be "
+                                           "written")
+                .arg(file->fileName());
+    }
+}
+
+/**
+ * Reads all records of a partition file
+ *
+ * Returns false and sets the error message if the file couldn't be read.
+ */
+bool HashJoin::readRecords(QTemporaryFile *file,
+                           QList<JoinRecord> *records) {
+    QDataStream stream(file);
+
+    if (file->flush() && file->seek(0)) {
+        while (!stream.atEnd()) {
+            JoinRecord record;
+            stream >> record;
+
+            if (stream.status() != QDataStream::Ok) {
+                break;
+            }
+
+            records->append(record);
+        }
+
+        if (stream.status() == QDataStream::Ok) {
+            return true;
+        }
+    }
+
+    errorMessage = QObject::tr("Partition file '%1' could not be read")
+            .arg(file->fileName());
+    return false;
+}
+
+/**
+ * Returns about the amount of memory a record uses in the hash table
+ */
+qint64 HashJoin::recordSize(const JoinRecord &record) {
+    return record.key.size() + record.text.size() + sizeof(JoinRecord) + 64;
+}
+
+QDebug operator<<(QDebug dbg, const HashJoin &hashJoin) {
+    dbg.nospace() << "HashJoin: <memorySize>" << hashJoin.memorySize <<
+            " <buildKeys>" << hashJoin.buildEntries.count() <<
+            " <spilled>" << hashJoin.hasSpilled();
+    return dbg.space();
+}
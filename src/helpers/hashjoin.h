@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QTemporaryFile>
+#include <QDebug>
+#include <functional>
+
+// amount of memory the records of the build side may use before they are
+// spilled to disk
+#define HASH_JOIN_DEFAULT_MEMORY_LIMIT (256 * 1024 * 1024)
+
+// number of partitions the records are spilled into
+#define HASH_JOIN_DEFAULT_PARTITION_COUNT 32
+
+/**
+ * A line of a log file with the key it is joined by
+ */
+struct JoinRecord {
+    QByteArray key;
+    // index of the log file of the line
+    int source;
+    // zero based number of the line in its log file
+    qint64 line;
+    // a Utils::Timestamp or Utils::Timestamp::Invalid
+    qint64 timestamp;
+    QByteArray text;
+};
+
+/**
+ * Joins the records of a build side with the records of a probe side by
+ * their keys
+ *
+ * The build side, that should be the smaller one, is added first and kept
+ * in a hash table, then the probe side is streamed past it. For every probe
+ * record with a key of the build side the match function is called with
+ * the build records of that key, firstMatch is set for the first probe
+ * record of a key.
+ *
+ * If the build records exceed the memory limit the join spills: the records
+ * of both sides are written to partition files by the hash of their keys,
+ * finish() joins the partitions one after another.
+ */
+class HashJoin
+{
+public:
+    typedef std::function<void(const QList<JoinRecord> &buildRecords,
+                               const JoinRecord &probeRecord,
+                               bool firstMatch)> MatchFunction;
+
+    explicit HashJoin(MatchFunction matchFunction,
+                      qint64 memoryLimit = HASH_JOIN_DEFAULT_MEMORY_LIMIT,
+                      int partitionCount = HASH_JOIN_DEFAULT_PARTITION_COUNT);
+    ~HashJoin();
+
+    void addBuildRecord(const JoinRecord &record);
+    void addProbeRecord(const JoinRecord &record);
+    bool finish();
+    bool hasSpilled() const;
+    QString getErrorMessage() const;
+    friend QDebug operator<<(QDebug dbg, const HashJoin &hashJoin);
+
+private:
+    Q_DISABLE_COPY(HashJoin)
+
+    struct BuildEntry {
+        QList<JoinRecord> records;
+        bool matched;
+    };
+
+    MatchFunction matchFunction;
+    qint64 memoryLimit;
+    int partitionCount;
+    qint64 memorySize;
+    QHash<QByteArray, BuildEntry> buildEntries;
+    QList<QTemporaryFile *> buildPartitionFiles;
+    QList<QTemporaryFile *> probePartitionFiles;
+    QString errorMessage;
+
+    void addToBuildEntries(const JoinRecord &record);
+    void matchProbeRecord(const JoinRecord &record);
+    void spill();
+    bool openPartitionFiles(QList<QTemporaryFile *> *files);
+    void writeRecord(QList<QTemporaryFile *> &files,
+                     const JoinRecord &record);
+    bool readRecords(QTemporaryFile *file, QList<JoinRecord> *records);
+    static qint64 recordSize(const JoinRecord &record);
+};
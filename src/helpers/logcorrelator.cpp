@@ -0,0 +1,343 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#include "logcorrelator.h"
+#include <QFileInfo>
+#include <QtConcurrent>
+#include <algorithm>
+#include <services/logloaderservice.h>
+#include <utils/timestamp.h>
+#include <utils/zip.h>
+
+namespace {
+    /**
+     * The records of the lines of a block with a key, their line numbers
+     * are relative to the block
+     */
+    struct BlockRecords {
+        QList<JoinRecord> records;
+        int lineCount;
+    };
+
+    /**
+     * Extracts the keys of the lines of a block, used to process the blocks
+     * of a chunk in parallel
+     */
+    struct KeyExtractor {
+        typedef BlockRecords result_type;
+
+        QRegularExpression keyExpression;
+
+        BlockRecords operator()(const QByteArray &block) const {
+            BlockRecords blockRecords;
+            blockRecords.lineCount = 0;
+            int pos = 0;
+
+            while (pos < block.size()) {
+                int end = block.indexOf('\n', pos);
+                int next = end == -1 ? block.size() : end + 1;
+                end = end == -1 ? block.size() : end;
+
+                if (end > pos && block.at(end - 1) == '\r') {
+                    end--;
+                }
+
+                QByteArray text = block.mid(pos, end - pos);
+                QByteArray key = LogCorrelator::extractKey(
+                        keyExpression, QString::fromUtf8(text));
+
+                if (!key.isEmpty()) {
+                    JoinRecord record;
+                    record.key = key;
+                    record.source = 0;
+                    record.line = blockRecords.lineCount;
+                    record.timestamp = Utils::Timestamp::parse(text);
+                    record.text = text;
+                    blockRecords.records.append(record);
+                }
+
+                pos = next;
+                blockRecords.lineCount++;
+            }
+
+            return blockRecords;
+        }
+    };
+}
+
+LogCorrelator::LogCorrelator(int timelineCount, qint64 memoryLimit) {
+    this->timelineCount = timelineCount;
+    this->memoryLimit = memoryLimit;
+    buildSource = -1;
+    joinedKeyCount = 0;
+    joinedLineCount = 0;
+    spilled = false;
+}
+
+/**
+ * Joins the lines of the sources by their keys
+ *
+ * Returns false and sets the error message if a file couldn't be read.
+ */
+bool LogCorrelator::correlate(const QList<QStringList> &sources,
+                              const QRegularExpression &keyExpression) {
+    timelines.clear();
+    timelineIndexes.clear();
+    joinedKeyCount = 0;
+    joinedLineCount = 0;
+    errorMessage.clear();
+
+    if (sources.count() < 2) {
+        errorMessage = QObject::tr("At least two log files are needed");
+        return false;
+    }
+
+    // the smallest source is kept in memory
+    buildSource = 0;
+
+    for (int i = 1; i < sources.count(); i++) {
+        if (sourceSize(sources.at(i)) < sourceSize(sources.at(buildSource))) {
+            buildSource = i;
+        }
+    }
+
+    HashJoin hashJoin(
+            [this](const QList<JoinRecord> &buildRecords,
+                   const JoinRecord &probeRecord, bool firstMatch) {
+                addMatch(buildRecords, probeRecord, firstMatch);
+            },
+            memoryLimit);
+
+    bool success = readSource(
+            sources.at(buildSource), buildSource, keyExpression,
+            [&hashJoin](const JoinRecord &record) {
+                hashJoin.addBuildRecord(record);
+            });
+
+    for (int i = 0; success && i < sources.count(); i++) {
+        if (i == buildSource) {
+            continue;
+        }
+
+        success = readSource(
+                sources.at(i), i, keyExpression,
+                [&hashJoin](const JoinRecord &record) {
+                    hashJoin.addProbeRecord(record);
+                });
+    }
+
+    if (success && !hashJoin.finish()) {
+        errorMessage = hashJoin.getErrorMessage();
+        success = false;
+    }
+
+    spilled = hashJoin.hasSpilled();
+    qDebug() << __func__ << " - 'hashJoin': " << hashJoin;
+
+    // the lines of the sources are shown in the order of their time, lines
+    // without timestamps come first
+    for (int i = 0; i < timelines.count(); i++) {
+        std::stable_sort(timelines[i].records.begin(),
+                         timelines[i].records.end(),
+                         [](const JoinRecord &a, const JoinRecord &b) {
+                             return a.timestamp < b.timestamp;
+                         });
+    }
+
+    return success;
+}
+
+QList<LogCorrelator::Timeline> LogCorrelator::getTimelines() const {
+    return timelines;
+}
+
+/**
+ * Returns the index of the source that was kept in memory
+ */
+int LogCorrelator::getBuildSource() const {
+    return buildSource;
+}
+
+/**
+ * Returns the number of keys of the build source that were found in the
+ * other sources
+ */
+qint64 LogCorrelator::getJoinedKeyCount() const {
+    return joinedKeyCount;
+}
+
+/**
+ * Returns the number of lines of all sources with a joined key
+ */
+qint64 LogCorrelator::getJoinedLineCount() const {
+    return joinedLineCount;
+}
+
+/**
+ * Returns if the build source didn't fit into memory and was spilled to
+ * disk
+ */
+bool LogCorrelator::hasSpilled() const {
+    return spilled;
+}
+
+QString LogCorrelator::getErrorMessage() const {
+    return errorMessage;
+}
+
+/**
+ * Returns the key of a line, the named group "key" of the key expression,
+ * its first group or its whole match
+ */
+QByteArray LogCorrelator::extractKey(const QRegularExpression &keyExpression,
+                                     const QString &line) {
+    QRegularExpressionMatch match = keyExpression.match(line);
+
+    if (!match.hasMatch()) {
+        return QByteArray();
+    }
+
+    QString key = match.captured("key");
+
+    if (key.isEmpty() && keyExpression.captureCount() > 0) {
+        key = match.captured(1);
+    }
+
+    if (key.isEmpty()) {
+        key = match.captured(0);
+    }
+
+    return key.toUtf8();
+}
+
+/**
+ * Reads the files of a source in chunks and adds the lines with a key, the
+ * keys of the blocks of a chunk are extracted in parallel
+ */
+bool LogCorrelator::readSource(
+        const QStringList &filePaths, int source,
+        const QRegularExpression &keyExpression,
+        std::function<void(const JoinRecord &record)> addRecord) {
+    KeyExtractor keyExtractor;
+    keyExtractor.keyExpression = keyExpression;
+    qint64 line = 0;
+
+    Q_FOREACH(QString filePath, filePaths) {
+            bool success = LogLoaderService::readLogFileChunks(
+                    filePath,
+                    [&](const QByteArray &chunk) {
+                        QList<QByteArray> blocks;
+                        int pos = 0;
+
+                        while (pos < chunk.size()) {
+                            int end = chunk.indexOf(
+                                    '\n', qMin(pos + LOG_CORRELATOR_BLOCK_SIZE,
+                                               chunk.size()) - 1);
+                            end = end == -1 ? chunk.size() : end + 1;
+                            blocks.append(chunk.mid(pos, end - pos));
+                            pos = end;
+                        }
+
+                        QList<BlockRecords> results =
+                                QtConcurrent::blockingMapped<
+                                        QList<BlockRecords> >(
+                                        blocks, keyExtractor);
+
+                        Q_FOREACH(BlockRecords blockRecords, results) {
+                                Q_FOREACH(JoinRecord record,
+                                          blockRecords.records) {
+                                        record.source = source;
+                                        record.line += line;
+                                        addRecord(record);
+                                    }
+
+                                line += blockRecords.lineCount;
+                            }
+                    },
+                    &errorMessage);
+
+            if (!success) {
+                return false;
+            }
+        }
+
+    return true;
+}
+
+/**
+ * Adds a joined line to the timeline of its key, the lines of the build
+ * source are added with the first joined line of a key
+ */
+void LogCorrelator::addMatch(const QList<JoinRecord> &buildRecords,
+                             const JoinRecord &probeRecord,
+                             bool firstMatch) {
+    joinedLineCount++;
+
+    if (firstMatch) {
+        joinedKeyCount++;
+        joinedLineCount += buildRecords.count();
+    }
+
+    int index = timelineIndexes.value(probeRecord.key, -1);
+
+    if (index < 0) {
+        if (!firstMatch || timelines.count() >= timelineCount) {
+            return;
+        }
+
+        Timeline timeline;
+        timeline.key = probeRecord.key;
+        timeline.lineCount = buildRecords.count();
+        timeline.records = buildRecords.mid(
+                0, LOG_CORRELATOR_TIMELINE_LINE_COUNT);
+
+        index = timelines.count();
+        timelineIndexes.insert(timeline.key, index);
+        timelines.append(timeline);
+    }
+
+    Timeline &timeline = timelines[index];
+    timeline.lineCount++;
+
+    if (timeline.records.count() < LOG_CORRELATOR_TIMELINE_LINE_COUNT) {
+        timeline.records.append(probeRecord);
+    }
+}
+
+/**
+ * Returns the size of the files of a source, for members of zip archives
+ * the size of the archive is used
+ */
+qint64 LogCorrelator::sourceSize(const QStringList &filePaths) {
+    qint64 size = 0;
+
+    Q_FOREACH(QString filePath, filePaths) {
+            size += QFileInfo(Utils::Zip::isMemberPath(filePath) ?
+                              Utils::Zip::archivePath(filePath) :
+                              filePath).size();
+        }
+
+    return size;
+}
+
+QDebug operator<<(QDebug dbg, const LogCorrelator &correlator) {
+    dbg.nospace() << "LogCorrelator: <buildSource>" <<
+            correlator.buildSource << " <joinedKeyCount>" <<
+            correlator.joinedKeyCount << " <joinedLineCount>" <<
+            correlator.joinedLineCount << " <timelines>" <<
+            correlator.timelines.count() << " <spilled>" <<
+            correlator.spilled;
+    return dbg.space();
+}
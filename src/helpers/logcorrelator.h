@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include <QRegularExpression>
+#include <QDebug>
+#include <helpers/hashjoin.h>
+
+// maximum number of keys whose timelines are kept
+#define LOG_CORRELATOR_DEFAULT_TIMELINE_COUNT 200
+
+// maximum number of lines that are kept for the timeline of a key
+#define LOG_CORRELATOR_TIMELINE_LINE_COUNT 1000
+
+// amount of data of a chunk of a log file the keys are extracted from by one
+// task
+#define LOG_CORRELATOR_BLOCK_SIZE (256 * 1024)
+
+/**
+ * Correlates the lines of log files, like an access log, an error log and
+ * an application log, by a key like a request or session id
+ *
+ * Every source is a list of files that are read one after another, like a
+ * family of rotated log files. The key of a line is the named group "key"
+ * of the key expression, its first group or its whole match.
+ *
+ * The sources are streamed in chunks through a hash join: the smallest
+ * source is the build side, the lines of the other sources with a key of the
+ * build side are joined to it. The timelines of the first joined keys are
+ * kept with their lines sorted by time.
+ */
+class LogCorrelator
+{
+public:
+    struct Timeline {
+        QByteArray key;
+        // number of joined lines with the key, also the ones that aren't
+        // kept
+        qint64 lineCount;
+        QList<JoinRecord> records;
+    };
+
+    explicit LogCorrelator(
+            int timelineCount = LOG_CORRELATOR_DEFAULT_TIMELINE_COUNT,
+            qint64 memoryLimit = HASH_JOIN_DEFAULT_MEMORY_LIMIT);
+
+    bool correlate(const QList<QStringList> &sources,
+                   const QRegularExpression &keyExpression);
+    QList<Timeline> getTimelines() const;
+    int getBuildSource() const;
+    qint64 getJoinedKeyCount() const;
+    qint64 getJoinedLineCount() const;
+    bool hasSpilled() const;
+    QString getErrorMessage() const;
+    static QByteArray extractKey(const QRegularExpression &keyExpression,
+                                 const QString &line);
+    friend QDebug operator<<(QDebug dbg, const LogCorrelator &correlator);
+
+private:
+    int timelineCount;
+    qint64 memoryLimit;
+    int buildSource;
+    qint64 joinedKeyCount;
+    qint64 joinedLineCount;
+    bool spilled;
+    QString errorMessage;
+    QList<Timeline> timelines;
+    QHash<QByteArray, int> timelineIndexes;
+
+    bool readSource(const QStringList &filePaths, int source,
+                    const QRegularExpression &keyExpression,
+                    std::function<void(const JoinRecord &record)> addRecord);
+    void addMatch(const QList<JoinRecord> &buildRecords,
+                  const JoinRecord &probeRecord, bool firstMatch);
+    static qint64 sourceSize(const QStringList &filePaths);
+};
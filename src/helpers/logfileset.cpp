@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#include "logfileset.h"
+#include <algorithm>
+
+LogFileSet::LogFileSet() {
+}
+
+LogFileSet::~LogFileSet() {
+    clear();
+}
+
+/**
+ * Unloads all files and forgets the filters
+ */
+void LogFileSet::clear() {
+    Q_FOREACH(File file, files) {
+            delete file.logStore;
+        }
+
+    files.clear();
+    filters.clear();
+}
+
+bool LogFileSet::contains(const QString &filePath) const {
+    Q_FOREACH(File file, files) {
+            if (file.filePath == filePath) {
+                return true;
+            }
+        }
+
+    return false;
+}
+
+QStringList LogFileSet::getFilePaths() const {
+    QStringList filePaths;
+
+    Q_FOREACH(File file, files) {
+            filePaths << file.filePath;
+        }
+
+    return filePaths;
+}
+
+int LogFileSet::getFileCount() const {
+    return files.count();
+}
+
+LogFileSet::File &LogFileSet::file(int index) {
+    return files[index];
+}
+
+int LogFileSet::getFilterCount() const {
+    return filters.count();
+}
+
+/**
+ * Adds a loaded file and takes the ownership of its log store, the filters
+ * that were applied to the other files are applied to it
+ *
+ * The last line of the store has to end with a line break, so the lines of
+ * the next file start on their own line.
+ */
+void LogFileSet::add(const QString &filePath, const LogFileIndex &index,
+                     LogStore *logStore) {
+    File file;
+    file.filePath = filePath;
+    file.index = index;
+    file.logStore = logStore;
+    file.filtered = false;
+    file.timeIndexCurrent = false;
+
+    Q_FOREACH(Filter filter, filters) {
+            filter(file);
+            file.filtered = true;
+            file.timeIndexCurrent = false;
+        }
+
+    files.append(file);
+}
+
+/**
+ * Unloads a file, the filters are forgotten with the last file
+ *
+ * The file path is taken by value, it may be the path of the file that is
+ * removed.
+ */
+void LogFileSet::remove(QString filePath) {
+    for (int i = files.count() - 1; i >= 0; i--) {
+        if (files.at(i).filePath == filePath) {
+            removeAt(i);
+        }
+    }
+}
+
+/**
+ * Unloads the file at an index, the filters are forgotten with the last file
+ */
+void LogFileSet::removeAt(int index) {
+    delete files.at(index).logStore;
+    files.removeAt(index);
+
+    if (files.isEmpty()) {
+        filters.clear();
+    }
+}
+
+/**
+ * Orders the files like the file paths, files that aren't in the list are
+ * moved to the end
+ */
+void LogFileSet::reorder(const QStringList &filePaths) {
+    std::stable_sort(
+            files.begin(), files.end(),
+            [&filePaths](const File &a, const File &b) -> bool {
+                int indexA = filePaths.indexOf(a.filePath);
+                int indexB = filePaths.indexOf(b.filePath);
+
+                return static_cast<uint>(indexA) < static_cast<uint>(indexB);
+            });
+}
+
+/**
+ * Applies a filter to the lines of all files and keeps it for the files that
+ * are added later
+ */
+void LogFileSet::applyFilter(Filter filter) {
+    for (int i = 0; i < files.count(); i++) {
+        filter(files[i]);
+        files[i].filtered = true;
+        files[i].timeIndexCurrent = false;
+    }
+
+    filters.append(filter);
+}
+
+/**
+ * Returns the time index of the lines of a file, it is only built again if
+ * the lines were filtered
+ */
+TimeIndex &LogFileSet::timeIndex(File &file) {
+    if (!file.timeIndexCurrent) {
+        file.timeIndex = TimeIndex::build(*file.logStore);
+        file.timeIndexCurrent = true;
+    }
+
+    return file.timeIndex;
+}
+
+/**
+ * Returns the time index of the lines of the files after they were
+ * concatenated or merged into a store, the runs are the ones that were
+ * returned by concatenate() or merge()
+ *
+ * Only the time indexes of the files that were added or filtered since the
+ * last time are built.
+ */
+TimeIndex LogFileSet::mergeTimeIndexes(const QList<LineSourceRun> &runs,
+                                       qint64 lineCount) {
+    QList<TimeIndex> timeIndexes;
+
+    for (int i = 0; i < files.count(); i++) {
+        timeIndexes.append(timeIndex(files[i]));
+    }
+
+    return TimeIndex::merge(timeIndexes, runs, lineCount);
+}
+
+/**
+ * Replaces the lines of the target store with the lines of the files one
+ * after the other and returns the runs of the lines of every file
+ */
+QList<LineSourceRun> LogFileSet::concatenate(LogStore &target) {
+    QList<LineSourceRun> runs;
+    target.clear();
+
+    for (int i = 0; i < files.count(); i++) {
+        LineSourceRun run;
+        run.firstLine = target.getLineCount();
+        run.source = i;
+        runs.append(run);
+
+        target.appendStore(*files.at(i).logStore);
+    }
+
+    return runs;
+}
+
+/**
+ * Replaces the lines of the target store with the lines of the files merged
+ * by their timestamps and returns the runs of the lines of every file
+ */
+QList<LineSourceRun> LogFileSet::merge(LogStore &target) {
+    QList<LogStore *> logStores;
+
+    Q_FOREACH(File file, files) {
+            logStores.append(file.logStore);
+        }
+
+    target.clear();
+    return LogMerger::merge(logStores, target);
+}
+
+QDebug operator<<(QDebug dbg, const LogFileSet &logFileSet) {
+    dbg.nospace() << "LogFileSet: <files>" << logFileSet.files.count() <<
+            " <filters>" << logFileSet.filters.count();
+    return dbg.space();
+}
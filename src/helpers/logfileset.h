@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QDebug>
+#include <functional>
+#include <entities/logfileindex.h>
+#include <helpers/logstore.h>
+#include <helpers/logmerger.h>
+#include <helpers/timeindex.h>
+
+/**
+ * The loaded log files, every file has its own log store, so files can be
+ * added to or removed from the selection without loading the other files
+ * again
+ *
+ * The filters that were applied to the files are kept and applied to the
+ * files that are added later, so all files stay filtered the same way. The
+ * lines of the files are concatenated or merged into the log store that is
+ * shown, the compressed blocks of concatenated files are shared with it.
+ */
+class LogFileSet
+{
+public:
+    struct File {
+        QString filePath;
+        LogFileIndex index;
+        LogStore *logStore;
+        // lines were removed since the file was loaded, so its index doesn't
+        // match its lines anymore
+        bool filtered;
+        // the time index of the lines of the log store, it is built when it
+        // is needed
+        TimeIndex timeIndex;
+        bool timeIndexCurrent;
+    };
+
+    typedef std::function<void(File &file)> Filter;
+
+    explicit LogFileSet();
+    ~LogFileSet();
+
+    void clear();
+    bool contains(const QString &filePath) const;
+    QStringList getFilePaths() const;
+    int getFileCount() const;
+    File &file(int index);
+    int getFilterCount() const;
+    void add(const QString &filePath, const LogFileIndex &index,
+             LogStore *logStore);
+    void remove(QString filePath);
+    void removeAt(int index);
+    void reorder(const QStringList &filePaths);
+    void applyFilter(Filter filter);
+    static TimeIndex &timeIndex(File &file);
+    TimeIndex mergeTimeIndexes(const QList<LineSourceRun> &runs,
+                               qint64 lineCount);
+    QList<LineSourceRun> concatenate(LogStore &target);
+    QList<LineSourceRun> merge(LogStore &target);
+    friend QDebug operator<<(QDebug dbg, const LogFileSet &logFileSet);
+
+private:
+    Q_DISABLE_COPY(LogFileSet)
+
+    QList<File> files;
+    QList<Filter> filters;
+};
@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#include "logmerger.h"
+#include <queue>
+#include <vector>
+#include <utils/timestamp.h>
+
+// amount of merged data that is collected before it is added to the target
+#define LOG_MERGER_OUTPUT_SIZE (1024 * 1024)
+
+namespace {
+    /**
+     * Reads the entries of a source, an entry is a line with a timestamp and
+     * the lines without timestamp that follow it
+     */
+    class SourceCursor {
+    public:
+        SourceCursor(LogStore *logStore) {
+            this->logStore = logStore;
+            blockIndex = -1;
+            pos = 0;
+            timestamp = Utils::Timestamp::Invalid;
+            nextTimestamp = Utils::Timestamp::Invalid;
+            lineCount = 0;
+            blockCount = logStore->getBlockCount();
+            readLine();
+        }
+
+        /**
+         * Moves the cursor to the next entry, returns false at the end
+         */
+        bool next() {
+            entry.clear();
+            lineCount = 0;
+
+            if (line.isNull()) {
+                return false;
+            }
+
+            timestamp = nextTimestamp;
+
+            do {
+                entry += line;
+                lineCount++;
+                readLine();
+            } while (!line.isNull() &&
+                     nextTimestamp == Utils::Timestamp::Invalid);
+
+            return true;
+        }
+
+        QByteArray entry;
+        int lineCount;
+        qint64 timestamp;
+
+    private:
+        LogStore *logStore;
+        int blockCount;
+        int blockIndex;
+        QByteArray block;
+        int pos;
+        QByteArray line;
+        qint64 nextTimestamp;
+
+        void readLine() {
+            while (pos >= block.size()) {
+                if (blockIndex + 1 >= blockCount) {
+                    line = QByteArray();
+                    return;
+                }
+
+                block = logStore->block(++blockIndex);
+                pos = 0;
+            }
+
+            int end = block.indexOf('\n', pos);
+            end = end == -1 ? block.size() : end + 1;
+            line = block.mid(pos, end - pos);
+
+            // lines at the end of a source get a line break, so they aren't
+            // joined with lines of other sources
+            if (!line.endsWith('\n')) {
+                line.append('\n');
+            }
+
+            pos = end;
+            nextTimestamp = Utils::Timestamp::parse(line);
+        }
+    };
+
+    struct HeapItem {
+        qint64 timestamp;
+        int source;
+
+        // the heap returns the largest item first, so the comparison is
+        // reversed, ties keep the order of the sources
+        bool operator<(const HeapItem &other) const {
+            if (timestamp != other.timestamp) {
+                return timestamp > other.timestamp;
+            }
+
+            return source > other.source;
+        }
+    };
+}
+
+/**
+ * Appends the lines of the sources to the target in the order of their
+ * timestamps and returns the source of every line of the target
+ */
+QList<LineSourceRun> LogMerger::merge(QList<LogStore *> sources,
+                                      LogStore &target) {
+    QList<LineSourceRun> runs;
+    std::vector<SourceCursor *> cursors;
+    std::priority_queue<HeapItem> heap;
+
+    for (int i = 0; i < sources.count(); i++) {
+        SourceCursor *cursor = new SourceCursor(sources.at(i));
+        cursors.push_back(cursor);
+
+        if (cursor->next()) {
+            HeapItem item;
+            item.timestamp = cursor->timestamp;
+            item.source = i;
+            heap.push(item);
+        }
+    }
+
+    qint64 line = target.getLineCount();
+    QByteArray output;
+
+    while (!heap.empty()) {
+        HeapItem item = heap.top();
+        heap.pop();
+
+        SourceCursor *cursor = cursors.at(item.source);
+
+        if (runs.isEmpty() || runs.last().source != item.source) {
+            LineSourceRun run;
+            run.firstLine = line;
+            run.source = item.source;
+            runs.append(run);
+        }
+
+        output += cursor->entry;
+        line += cursor->lineCount;
+
+        if (output.size() >= LOG_MERGER_OUTPUT_SIZE) {
+            target.append(output);
+            output.clear();
+        }
+
+        if (cursor->next()) {
+            item.timestamp = cursor->timestamp;
+            heap.push(item);
+        }
+    }
+
+    target.append(output);
+    target.flush();
+
+    for (size_t i = 0; i < cursors.size(); i++) {
+        delete cursors.at(i);
+    }
+
+    return runs;
+}
+
+/**
+ * Returns the source of a line or -1 if the line isn't in a run
+ */
+int LogMerger::sourceForLine(const QList<LineSourceRun> &runs, qint64 line) {
+    int low = 0;
+    int high = runs.count() - 1;
+    int result = -1;
+
+    while (low <= high) {
+        int middle = (low + high) / 2;
+
+        if (runs.at(middle).firstLine <= line) {
+            result = runs.at(middle).source;
+            low = middle + 1;
+        } else {
+            high = middle - 1;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Returns the runs of count lines starting at firstLine, the lines are
+ * renumbered to start at zero
+ */
+QList<LineSourceRun> LogMerger::sliceRuns(const QList<LineSourceRun> &runs,
+                                          qint64 firstLine, qint64 count) {
+    QList<LineSourceRun> result;
+
+    if (count <= 0) {
+        return result;
+    }
+
+    int source = sourceForLine(runs, firstLine);
+
+    if (source != -1) {
+        LineSourceRun run;
+        run.firstLine = 0;
+        run.source = source;
+        result.append(run);
+    }
+
+    Q_FOREACH(LineSourceRun run, runs) {
+            if (run.firstLine <= firstLine ||
+                    run.firstLine >= firstLine + count) {
+                continue;
+            }
+
+            run.firstLine -= firstLine;
+            result.append(run);
+        }
+
+    return result;
+}
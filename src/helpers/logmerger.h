@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#pragma once
+
+#include <QList>
+#include <helpers/logstore.h>
+
+/**
+ * The lines of a log store from firstLine up to the next run come from the
+ * source with the index `source`
+ */
+struct LineSourceRun {
+    qint64 firstLine;
+    int source;
+};
+
+/**
+ * Merges log stores line by line in the order of their timestamps
+ *
+ * Every source has a cursor on its next line, the cursors are kept in a heap
+ * ordered by timestamp, so only the next line of every source is looked at.
+ * Lines without a timestamp stay with the line before them. The merged lines
+ * are appended to the target store as they are produced, so the merged text
+ * is never held uncompressed as a whole.
+ */
+class LogMerger
+{
+public:
+    static QList<LineSourceRun> merge(QList<LogStore *> sources,
+                                      LogStore &target);
+    static int sourceForLine(const QList<LineSourceRun> &runs, qint64 line);
+    static QList<LineSourceRun> sliceRuns(const QList<LineSourceRun> &runs,
+                                          qint64 firstLine, qint64 count);
+};
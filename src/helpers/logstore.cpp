@@ -0,0 +1,456 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+#include "logstore.h"
+#include <QMutexLocker>
+#include <QThread>
+#include <stdlib.h>
+#include <string.h>
+#include "libraries/miniz/miniz.h"
+
+namespace {
+    /**
+     * Compresses a block as raw deflate data with the fastest level
+     */
+    QByteArray compressBlock(const QByteArray &block) {
+        static const int flags =
+                static_cast<int>(tdefl_create_comp_flags_from_zip_params(
+                        MZ_BEST_SPEED, -MZ_DEFAULT_WINDOW_BITS,
+                        MZ_DEFAULT_STRATEGY));
+
+        size_t compressedSize = 0;
+        void *compressed = tdefl_compress_mem_to_heap(
+                block.constData(), static_cast<size_t>(block.size()),
+                &compressedSize, flags);
+
+        if (compressed == NULL) {
+            qWarning() << __func__ << " - 'could not compress block'";
+
+            // -1 marks a block that wasn't compressed
+            return QByteArray(1, '\xff') + block;
+        }
+
+        QByteArray result(1, '\0');
+        result.append(static_cast<const char *>(compressed),
+                      static_cast<int>(compressedSize));
+        free(compressed);
+
+        return result;
+    }
+
+    /**
+     * Returns the number of lines that start in a block
+     */
+    int blockLineCount(const QByteArray &block) {
+        if (block.isEmpty()) {
+            return 0;
+        }
+
+        return block.count('\n') + (block.endsWith('\n') ? 0 : 1);
+    }
+
+    /**
+     * Calls a function with the uncompressed data of a block of a list
+     * of blocks that doesn't belong to a store anymore
+     */
+    struct DetachedBlockMapper {
+        typedef QByteArray result_type;
+
+        const QList<LogStore::Block> *blocks;
+        LogStore::BlockFunction function;
+
+        QByteArray operator()(int index) const {
+            const LogStore::Block &block = blocks->at(index);
+            return function(LogStore::uncompressBlockData(block),
+                            block.firstLine);
+        }
+    };
+}
+
+LogStore::LogStore(int blockSize, int cacheBlockCount) {
+    this->blockSize = blockSize;
+    lastLineTerminated = true;
+    lineCount = 0;
+    size = 0;
+    compressedSize = 0;
+    cache.setMaxCost(blockSize * cacheBlockCount);
+}
+
+void LogStore::clear() {
+    QMutexLocker locker(&cacheMutex);
+    cache.clear();
+    blocks.clear();
+    pendingData.clear();
+    lastLineTerminated = true;
+    lineCount = 0;
+    size = 0;
+    compressedSize = 0;
+}
+
+/**
+ * Appends data to the store
+ *
+ * Complete blocks are compressed in parallel on the global thread pool, the
+ * rest is kept until more data is appended or the store is flushed.
+ */
+void LogStore::append(const QByteArray &data) {
+    // a last block that doesn't end with a line break is continued
+    if (!lastLineTerminated && pendingData.isEmpty() && !blocks.isEmpty()) {
+        Block block = blocks.takeLast();
+        pendingData = uncompressBlockData(block);
+        lastLineTerminated = true;
+        lineCount -= block.lineCount;
+        size -= block.size;
+        compressedSize -= block.data.size();
+
+        QMutexLocker locker(&cacheMutex);
+        cache.remove(blocks.count());
+    }
+
+    pendingData += data;
+
+    if (pendingData.size() < blockSize) {
+        return;
+    }
+
+    QList<QByteArray> uncompressedBlocks;
+    int pos = 0;
+
+    forever {
+        if (pendingData.size() - pos < blockSize) {
+            break;
+        }
+
+        // blocks end at a line break
+        int end = pendingData.indexOf('\n', pos + blockSize - 1);
+
+        if (end == -1) {
+            break;
+        }
+
+        uncompressedBlocks.append(pendingData.mid(pos, end + 1 - pos));
+        pos = end + 1;
+    }
+
+    pendingData = pendingData.mid(pos);
+    appendBlocks(uncompressedBlocks);
+}
+
+/**
+ * Compresses the data that wasn't compressed yet
+ */
+void LogStore::flush() {
+    if (pendingData.isEmpty()) {
+        return;
+    }
+
+    QList<QByteArray> uncompressedBlocks;
+    uncompressedBlocks.append(pendingData);
+    pendingData.clear();
+    appendBlocks(uncompressedBlocks);
+}
+
+void LogStore::appendBlocks(const QList<QByteArray> &uncompressedBlocks) {
+    if (uncompressedBlocks.isEmpty()) {
+        return;
+    }
+
+    QList<QByteArray> compressedBlocks =
+            QtConcurrent::blockingMapped(uncompressedBlocks, compressBlock);
+
+    for (int i = 0; i < uncompressedBlocks.count(); i++) {
+        Block block;
+        block.data = compressedBlocks.at(i);
+        block.size = uncompressedBlocks.at(i).size();
+        block.firstLine = lineCount;
+        block.lineCount = blockLineCount(uncompressedBlocks.at(i));
+        blocks.append(block);
+
+        lineCount += block.lineCount;
+        size += block.size;
+        compressedSize += block.data.size();
+    }
+
+    lastLineTerminated = uncompressedBlocks.last().endsWith('\n');
+}
+
+qint64 LogStore::getLineCount() {
+    flush();
+    return lineCount;
+}
+
+/**
+ * Returns the size of the uncompressed data
+ */
+qint64 LogStore::getSize() {
+    return size + pendingData.size();
+}
+
+qint64 LogStore::getCompressedSize() {
+    return compressedSize + pendingData.size();
+}
+
+int LogStore::getBlockCount() {
+    flush();
+    return blocks.count();
+}
+
+qint64 LogStore::getBlockFirstLine(int index) {
+    flush();
+    return blocks.at(index).firstLine;
+}
+
+/**
+ * Returns the index of the block the line starts in
+ */
+int LogStore::blockIndexForLine(qint64 line) {
+    flush();
+
+    int low = 0;
+    int high = blocks.count() - 1;
+
+    while (low < high) {
+        int middle = (low + high + 1) / 2;
+
+        if (blocks.at(middle).firstLine <= line) {
+            low = middle;
+        } else {
+            high = middle - 1;
+        }
+    }
+
+    return low;
+}
+
+/**
+ * Returns the uncompressed data of a block, recently used blocks are
+ * kept in the cache
+ */
+QByteArray LogStore::block(int index) {
+    flush();
+
+    QMutexLocker locker(&cacheMutex);
+    QByteArray *cachedBlock = cache.object(index);
+
+    if (cachedBlock != NULL) {
+        return *cachedBlock;
+    }
+
+    QByteArray data = uncompressBlockData(blocks.at(index));
+    cache.insert(index, new QByteArray(data), data.size());
+
+    return data;
+}
+
+/**
+ * Returns the uncompressed data of a block without using the cache, so it
+ * can be called from multiple threads
+ */
+QByteArray LogStore::uncompressBlock(int index) const {
+    return uncompressBlockData(blocks.at(index));
+}
+
+QByteArray LogStore::uncompressBlockData(const Block &block) {
+    const QByteArray &data = block.data;
+
+    if (data.isEmpty()) {
+        return QByteArray();
+    }
+
+    // the block wasn't compressed
+    if (data.at(0) != '\0') {
+        return data.mid(1);
+    }
+
+    QByteArray result;
+    result.resize(block.size);
+
+    size_t resultSize = tinfl_decompress_mem_to_mem(
+            result.data(), static_cast<size_t>(block.size),
+            data.constData() + 1, static_cast<size_t>(data.size() - 1), 0);
+
+    if (resultSize == TINFL_DECOMPRESS_MEM_TO_MEM_FAILED) {
+        qWarning() << __func__ << " - 'could not decompress block'";
+        return QByteArray();
+    }
+
+    result.resize(static_cast<int>(resultSize));
+    return result;
+}
+
+/**
+ * Returns count lines starting at the zero based line firstLine
+ */
+QByteArray LogStore::lines(qint64 firstLine, qint64 count) {
+    QByteArray result;
+
+    if (firstLine < 0 || count <= 0 || firstLine >= getLineCount()) {
+        return result;
+    }
+
+    qint64 readLineCount = 0;
+
+    for (int i = blockIndexForLine(firstLine);
+         i < blocks.count() && readLineCount < count; i++) {
+        QByteArray data = block(i);
+        int pos = 0;
+
+        // skip the lines before the first line
+        for (qint64 line = blocks.at(i).firstLine; line < firstLine; line++) {
+            pos = data.indexOf('\n', pos) + 1;
+        }
+
+        while (pos < data.size() && readLineCount < count) {
+            int end = data.indexOf('\n', pos);
+            end = end == -1 ? data.size() : end + 1;
+            result.append(data.constData() + pos, end - pos);
+            readLineCount++;
+            pos = end;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Replaces the data in the store with the results of a function that is
+ * called for every block and the number of its first line
+ *
+ * The blocks are processed in parallel in batches, so only a few of them
+ * are uncompressed at the same time.
+ */
+void LogStore::replaceWithMappedBlocks(BlockFunction function) {
+    flush();
+
+    QList<Block> oldBlocks = blocks;
+    clear();
+
+    DetachedBlockMapper mapper;
+    mapper.blocks = &oldBlocks;
+    mapper.function = function;
+
+    const int batchSize = QThread::idealThreadCount() * 4;
+
+    for (int start = 0; start < oldBlocks.count(); start += batchSize) {
+        QList<int> indexes;
+
+        for (int i = start;
+             i < qMin(start + batchSize, oldBlocks.count()); i++) {
+            indexes.append(i);
+        }
+
+        QList<QByteArray> results =
+                QtConcurrent::blockingMapped(indexes, mapper);
+
+        Q_FOREACH(QByteArray result, results) {
+                append(result);
+            }
+    }
+
+    flush();
+}
+
+/**
+ * Removes all lines except count lines starting at firstLine
+ *
+ * Blocks that are completely kept aren't decompressed, only the blocks at
+ * the borders of the range are cut.
+ */
+void LogStore::keepLines(qint64 firstLine, qint64 count) {
+    flush();
+
+    qint64 lastLine = firstLine + count;
+    QList<Block> oldBlocks = blocks;
+    bool oldLastLineTerminated = lastLineTerminated;
+    clear();
+
+    for (int i = 0; i < oldBlocks.count(); i++) {
+        Block block = oldBlocks.at(i);
+        qint64 blockLastLine = block.firstLine + block.lineCount;
+
+        if (blockLastLine <= firstLine || block.firstLine >= lastLine) {
+            continue;
+        }
+
+        if (block.firstLine >= firstLine && blockLastLine <= lastLine &&
+                pendingData.isEmpty()) {
+            block.firstLine = lineCount;
+            blocks.append(block);
+            lastLineTerminated = i < oldBlocks.count() - 1 ||
+                    oldLastLineTerminated;
+
+            lineCount += block.lineCount;
+            size += block.size;
+            compressedSize += block.data.size();
+            continue;
+        }
+
+        QByteArray data = uncompressBlockData(block);
+        int start = 0;
+        int end = data.size();
+        qint64 line = block.firstLine;
+
+        for (int pos = 0; pos < data.size(); line++) {
+            int next = data.indexOf('\n', pos);
+            next = next == -1 ? data.size() : next + 1;
+
+            if (line == firstLine) {
+                start = pos;
+            }
+
+            if (line == lastLine) {
+                end = pos;
+                break;
+            }
+
+            pos = next;
+        }
+
+        append(data.mid(start, end - start));
+        flush();
+    }
+}
+
+/**
+ * Appends the lines of another store without decompressing them, the
+ * compressed blocks are shared with the other store
+ *
+ * The lines of this store have to end with a line break, otherwise the
+ * first line of the other store would continue its last line.
+ */
+void LogStore::appendStore(LogStore &logStore) {
+    flush();
+    logStore.flush();
+
+    Q_FOREACH(Block block, logStore.blocks) {
+            block.firstLine = lineCount;
+            blocks.append(block);
+
+            lineCount += block.lineCount;
+            size += block.size;
+            compressedSize += block.data.size();
+        }
+
+    if (!logStore.blocks.isEmpty()) {
+        lastLineTerminated = logStore.lastLineTerminated;
+    }
+}
+
+QDebug operator<<(QDebug dbg, const LogStore &logStore) {
+    dbg.nospace() << "LogStore: <blocks>" << logStore.blocks.count() <<
+            " <lineCount>" << logStore.lineCount <<
+            " <size>" << logStore.size <<
+            " <compressedSize>" << logStore.compressedSize;
+    return dbg.space();
+}
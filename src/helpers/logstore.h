@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QCache>
+#include <QMutex>
+#include <QDebug>
+#include <QtConcurrent>
+#include <functional>
+
+// amount of uncompressed data in a block
+#define LOG_STORE_DEFAULT_BLOCK_SIZE (64 * 1024)
+
+// number of uncompressed blocks that are kept in the cache
+#define LOG_STORE_DEFAULT_CACHE_BLOCK_COUNT 64
+
+/**
+ * Keeps the loaded log data in memory as blocks of about 64KB, that are
+ * compressed with a fast compression level and start at line boundaries
+ *
+ * Every block knows the number of its first line, so lines can be found
+ * without decompressing other blocks. Recently used blocks are kept
+ * uncompressed in a small LRU cache.
+ *
+ * Functions that are mapped over the blocks only see the lines of one
+ * block, a pattern that matches multiple lines doesn't match lines of
+ * different blocks.
+ */
+class LogStore
+{
+public:
+    struct Block {
+        QByteArray data;
+        int size;
+        qint64 firstLine;
+        int lineCount;
+    };
+
+    typedef std::function<QByteArray(const QByteArray &block,
+                                     qint64 firstLine)> BlockFunction;
+
+    explicit LogStore(int blockSize = LOG_STORE_DEFAULT_BLOCK_SIZE,
+                      int cacheBlockCount = LOG_STORE_DEFAULT_CACHE_BLOCK_COUNT);
+
+    void clear();
+    void append(const QByteArray &data);
+    void flush();
+    qint64 getLineCount();
+    qint64 getSize();
+    qint64 getCompressedSize();
+    int getBlockCount();
+    qint64 getBlockFirstLine(int index);
+    int blockIndexForLine(qint64 line);
+    QByteArray block(int index);
+    QByteArray uncompressBlock(int index) const;
+    static QByteArray uncompressBlockData(const Block &block);
+    QByteArray lines(qint64 firstLine, qint64 count);
+    template <typename T>
+    QList<T> mapBlocks(std::function<T(const QByteArray &block)> function);
+    template <typename T, typename R>
+    R mapReduceBlocks(std::function<T(const QByteArray &block)> function,
+                      std::function<void(R &result, const T &blockResult)>
+                              reduce,
+                      QtConcurrent::ReduceOptions reduceOptions =
+                              QtConcurrent::UnorderedReduce);
+    void replaceWithMappedBlocks(BlockFunction function);
+    void keepLines(qint64 firstLine, qint64 count);
+    void appendStore(LogStore &logStore);
+    friend QDebug operator<<(QDebug dbg, const LogStore &logStore);
+
+private:
+    Q_DISABLE_COPY(LogStore)
+
+    int blockSize;
+    QList<Block> blocks;
+    QByteArray pendingData;
+    // the last block ends with a line break, so appended data starts a new
+    // block
+    bool lastLineTerminated;
+    qint64 lineCount;
+    qint64 size;
+    qint64 compressedSize;
+    QCache<int, QByteArray> cache;
+    QMutex cacheMutex;
+
+    void appendBlocks(const QList<QByteArray> &uncompressedBlocks);
+};
+
+/**
+ * Calls a function with the uncompressed data of a block, used to process
+ * the blocks in parallel
+ */
+template <typename T>
+struct LogStoreBlockMapper {
+    typedef T result_type;
+
+    const QList<LogStore::Block> *blocks;
+    std::function<T(const QByteArray &block)> function;
+
+    T operator()(int index) const {
+        return function(LogStore::uncompressBlockData(blocks->at(index)));
+    }
+};
+
+/**
+ * Calls a function for every block on the global thread pool and returns
+ * the results in the order of the blocks
+ *
+ * The blocks are decompressed by the worker threads, the cache isn't used.
+ */
+template <typename T>
+QList<T> LogStore::mapBlocks(
+        std::function<T(const QByteArray &block)> function) {
+    flush();
+
+    QList<int> indexes;
+    for (int i = 0; i < blocks.count(); i++) {
+        indexes.append(i);
+    }
+
+    LogStoreBlockMapper<T> mapper;
+    mapper.blocks = &blocks;
+    mapper.function = function;
+
+    return QtConcurrent::blockingMapped<QList<T> >(indexes, mapper);
+}
+
+/**
+ * Calls a function for every block on the global thread pool and reduces
+ * the results into one result as they arrive
+ *
+ * Unlike mapBlocks() the results of the blocks don't need to be kept until
+ * all blocks are done, the reduce function is never called concurrently.
+ * With QtConcurrent::OrderedReduce the results are reduced in the order of
+ * the blocks.
+ */
+template <typename T, typename R>
+R LogStore::mapReduceBlocks(
+        std::function<T(const QByteArray &block)> function,
+        std::function<void(R &result, const T &blockResult)> reduce,
+        QtConcurrent::ReduceOptions reduceOptions) {
+    flush();
+
+    QList<int> indexes;
+    for (int i = 0; i < blocks.count(); i++) {
+        indexes.append(i);
+    }
+
+    LogStoreBlockMapper<T> mapper;
+    mapper.blocks = &blocks;
+    mapper.function = function;
+
+    return QtConcurrent::blockingMappedReduced<R>(
+            indexes, mapper, reduce, reduceOptions);
+}
@@ -0,0 +1,352 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#include "logtable.h"
+#include <algorithm>
+
+namespace {
+    /**
+     * A column while it is built, the values are encoded with a hash of the
+     * dictionary
+     */
+    struct ColumnBuilder {
+        QString name;
+        QVector<QByteArray> dictionary;
+        QHash<QByteArray, quint32> dictionaryCodes;
+        QVector<quint32> codes;
+
+        ColumnBuilder() {
+            // code 0 is the empty value
+            dictionary.append(QByteArray());
+            dictionaryCodes.insert(QByteArray(), 0);
+        }
+
+        quint32 encode(const QByteArray &value) {
+            QHash<QByteArray, quint32>::const_iterator iterator =
+                    dictionaryCodes.constFind(value);
+
+            if (iterator != dictionaryCodes.constEnd()) {
+                return iterator.value();
+            }
+
+            quint32 code = static_cast<quint32>(dictionary.count());
+            dictionary.append(value);
+            dictionaryCodes.insert(value, code);
+            return code;
+        }
+    };
+
+    /**
+     * The rows of the lines of one block of the log store
+     */
+    struct BlockTable {
+        int rowCount;
+        QVector<int> lines;
+        QList<ColumnBuilder> columns;
+        QHash<QByteArray, int> columnIndexes;
+
+        BlockTable() {
+            rowCount = 0;
+        }
+
+        int columnIndex(const QByteArray &name) {
+            QHash<QByteArray, int>::const_iterator iterator =
+                    columnIndexes.constFind(name);
+
+            if (iterator != columnIndexes.constEnd()) {
+                return iterator.value();
+            }
+
+            // columns that show up later are empty in the rows before
+            ColumnBuilder column;
+            column.name = QString::fromUtf8(name);
+            column.codes.fill(0, rowCount);
+            columns.append(column);
+            columnIndexes.insert(name, columns.count() - 1);
+
+            return columns.count() - 1;
+        }
+    };
+
+    BlockTable parseBlock(const QByteArray &block,
+                          Utils::LogFormat::Format format) {
+        BlockTable table;
+        QVector<QByteArray> values;
+        QVector<QByteArray> names;
+
+        Q_FOREACH(QString name, Utils::LogFormat::fieldNames(format)) {
+                table.columnIndex(name.toUtf8());
+            }
+
+        int pos = 0;
+        int line = 0;
+
+        while (pos < block.size()) {
+            int end = block.indexOf('\n', pos);
+            end = end == -1 ? block.size() : end + 1;
+
+            if (Utils::LogFormat::parseLine(format, block.constData() + pos,
+                                            end - pos, values, names)) {
+                for (int i = 0; i < table.columns.count(); i++) {
+                    table.columns[i].codes.append(0);
+                }
+
+                table.rowCount++;
+                table.lines.append(line);
+
+                for (int i = 0; i < values.count(); i++) {
+                    int column = names.isEmpty() ?
+                                 i : table.columnIndex(names.at(i));
+                    table.columns[column].codes[table.rowCount - 1] =
+                            table.columns[column].encode(values.at(i));
+                }
+            }
+
+            pos = end;
+            line++;
+        }
+
+        return table;
+    }
+}
+
+LogTable::LogTable() {
+    format = Utils::LogFormat::UnknownFormat;
+    rowCount = 0;
+}
+
+/**
+ * Parses the lines of a log store into a table, the blocks are parsed in
+ * parallel with their own dictionaries that are merged afterwards
+ *
+ * Lines that don't have the format are skipped.
+ */
+LogTable LogTable::build(LogStore &logStore,
+                         Utils::LogFormat::Format format) {
+    LogTable logTable;
+    logTable.format = format;
+
+    QList<BlockTable> blockTables = logStore.mapBlocks<BlockTable>(
+            [format](const QByteArray &block) -> BlockTable {
+                return parseBlock(block, format);
+            });
+
+    QList<ColumnBuilder> columns;
+    QHash<QString, int> columnIndexes;
+
+    for (int i = 0; i < blockTables.count(); i++) {
+        const BlockTable &blockTable = blockTables.at(i);
+        qint64 blockFirstLine = logStore.getBlockFirstLine(i);
+        QVector<bool> filledColumns(columns.count(), false);
+
+        Q_FOREACH(ColumnBuilder blockColumn, blockTable.columns) {
+                int index = columnIndexes.value(blockColumn.name, -1);
+
+                if (index == -1) {
+                    ColumnBuilder column;
+                    column.name = blockColumn.name;
+                    column.codes.fill(0, logTable.rowCount);
+                    columns.append(column);
+                    filledColumns.append(false);
+                    index = columns.count() - 1;
+                    columnIndexes.insert(column.name, index);
+                }
+
+                // translate the codes of the block to the codes of the
+                // merged dictionary
+                ColumnBuilder &column = columns[index];
+                QVector<quint32> codeMap(blockColumn.dictionary.count());
+
+                for (int code = 0; code < codeMap.count(); code++) {
+                    codeMap[code] = column.encode(
+                            blockColumn.dictionary.at(code));
+                }
+
+                Q_FOREACH(quint32 code, blockColumn.codes) {
+                        column.codes.append(codeMap.at(code));
+                    }
+
+                filledColumns[index] = true;
+            }
+
+        // columns the block doesn't have are empty
+        for (int index = 0; index < columns.count(); index++) {
+            if (!filledColumns.at(index)) {
+                columns[index].codes.insert(
+                        columns[index].codes.count(), blockTable.rowCount, 0);
+            }
+        }
+
+        Q_FOREACH(int line, blockTable.lines) {
+                logTable.lines.append(blockFirstLine + line);
+            }
+
+        logTable.rowCount += blockTable.rowCount;
+    }
+
+    Q_FOREACH(ColumnBuilder builder, columns) {
+            Column column;
+            column.name = builder.name;
+            column.dictionary = builder.dictionary;
+            column.codes = builder.codes;
+            logTable.columns.append(column);
+        }
+
+    return logTable;
+}
+
+Utils::LogFormat::Format LogTable::getFormat() {
+    return format;
+}
+
+int LogTable::getRowCount() {
+    return rowCount;
+}
+
+int LogTable::getColumnCount() {
+    return columns.count();
+}
+
+QStringList LogTable::getColumnNames() {
+    QStringList names;
+
+    Q_FOREACH(Column column, columns) {
+            names.append(column.name);
+        }
+
+    return names;
+}
+
+int LogTable::columnIndex(QString name) {
+    for (int i = 0; i < columns.count(); i++) {
+        if (columns.at(i).name == name) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+QByteArray LogTable::value(int row, int column) {
+    const Column &tableColumn = columns.at(column);
+    return tableColumn.dictionary.at(tableColumn.codes.at(row));
+}
+
+/**
+ * Returns the line of the log store a row was parsed from
+ */
+qint64 LogTable::line(int row) {
+    return lines.at(row);
+}
+
+/**
+ * Returns the distinct values of a column with the number of rows that
+ * have them, the most frequent values first
+ */
+QList<LogTable::GroupCount> LogTable::groupCount(int column) {
+    const Column &tableColumn = columns.at(column);
+    QVector<qint64> counts(tableColumn.dictionary.count(), 0);
+
+    Q_FOREACH(quint32 code, tableColumn.codes) {
+            counts[code]++;
+        }
+
+    QList<GroupCount> result;
+
+    for (int code = 0; code < counts.count(); code++) {
+        if (counts.at(code) > 0) {
+            result.append(qMakePair(tableColumn.dictionary.at(code),
+                                    counts.at(code)));
+        }
+    }
+
+    std::stable_sort(result.begin(), result.end(),
+                     [](const GroupCount &a, const GroupCount &b) {
+                         return a.second > b.second;
+                     });
+
+    return result;
+}
+
+/**
+ * Returns the rows in the order of the values of a column
+ *
+ * Only the dictionary is sorted, the rows are put in order by the rank of
+ * their codes with a counting sort. Columns with only numbers are sorted
+ * numerically.
+ */
+QVector<int> LogTable::sortedRows(int column, Qt::SortOrder order) {
+    const Column &tableColumn = columns.at(column);
+    const QVector<QByteArray> &dictionary = tableColumn.dictionary;
+    int dictionaryCount = dictionary.count();
+
+    bool isNumeric = true;
+    QVector<double> numbers(dictionaryCount, 0);
+
+    for (int code = 1; code < dictionaryCount && isNumeric; code++) {
+        numbers[code] = dictionary.at(code).toDouble(&isNumeric);
+    }
+
+    QVector<int> sortedCodes(dictionaryCount);
+    for (int code = 0; code < dictionaryCount; code++) {
+        sortedCodes[code] = code;
+    }
+
+    std::sort(sortedCodes.begin(), sortedCodes.end(),
+              [&](int a, int b) {
+                  // empty values come first
+                  if (a == 0 || b == 0) {
+                      return a == 0 && b != 0;
+                  }
+
+                  return isNumeric ? numbers.at(a) < numbers.at(b) :
+                         dictionary.at(a) < dictionary.at(b);
+              });
+
+    if (order == Qt::DescendingOrder) {
+        std::reverse(sortedCodes.begin(), sortedCodes.end());
+    }
+
+    // the first row of every rank in the result
+    QVector<int> rankStarts(dictionaryCount + 1, 0);
+    QVector<int> ranks(dictionaryCount);
+
+    for (int rank = 0; rank < dictionaryCount; rank++) {
+        ranks[sortedCodes.at(rank)] = rank;
+    }
+
+    Q_FOREACH(quint32 code, tableColumn.codes) {
+            rankStarts[ranks.at(code) + 1]++;
+        }
+
+    for (int rank = 0; rank < dictionaryCount; rank++) {
+        rankStarts[rank + 1] += rankStarts.at(rank);
+    }
+
+    QVector<int> rows(rowCount);
+
+    for (int row = 0; row < rowCount; row++) {
+        rows[rankStarts[ranks.at(tableColumn.codes.at(row))]++] = row;
+    }
+
+    return rows;
+}
+
+QDebug operator<<(QDebug dbg, const LogTable &logTable) {
+    dbg.nospace() << "LogTable: <format>" << logTable.format <<
+            " <rowCount>" << logTable.rowCount <<
+            " <columns>" << logTable.columns.count();
+    return dbg.space();
+}
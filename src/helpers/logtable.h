@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QPair>
+#include <QStringList>
+#include <QVector>
+#include <QDebug>
+#include <helpers/logstore.h>
+#include <utils/logformat.h>
+
+/**
+ * The fields of the lines of a log store in columns
+ *
+ * Every column is dictionary encoded, it stores every distinct value once
+ * and a code per row, code 0 is the empty value. Grouping and sorting work
+ * on the codes, so the values don't need to be compared for every row.
+ */
+class LogTable
+{
+public:
+    struct Column {
+        QString name;
+        QVector<QByteArray> dictionary;
+        QVector<quint32> codes;
+    };
+
+    typedef QPair<QByteArray, qint64> GroupCount;
+
+    explicit LogTable();
+
+    static LogTable build(LogStore &logStore,
+                          Utils::LogFormat::Format format);
+    Utils::LogFormat::Format getFormat();
+    int getRowCount();
+    int getColumnCount();
+    QStringList getColumnNames();
+    int columnIndex(QString name);
+    QByteArray value(int row, int column);
+    qint64 line(int row);
+    QList<GroupCount> groupCount(int column);
+    QVector<int> sortedRows(int column, Qt::SortOrder order);
+    friend QDebug operator<<(QDebug dbg, const LogTable &logTable);
+
+private:
+    Utils::LogFormat::Format format;
+    int rowCount;
+    QVector<qint64> lines;
+    QList<Column> columns;
+};
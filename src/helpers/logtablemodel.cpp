@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#include "logtablemodel.h"
+#include <algorithm>
+
+LogTableModel::LogTableModel(QObject *parent) :
+        QAbstractTableModel(parent) {
+}
+
+void LogTableModel::setLogTable(const LogTable &logTable) {
+    beginResetModel();
+    this->logTable = logTable;
+    rows.clear();
+    endResetModel();
+}
+
+/**
+ * Returns the line of the log store of a row
+ */
+qint64 LogTableModel::line(const QModelIndex &index) {
+    int row = rows.isEmpty() ? index.row() : rows.at(index.row());
+    return logTable.line(row);
+}
+
+int LogTableModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : logTable.getRowCount();
+}
+
+int LogTableModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : logTable.getColumnCount();
+}
+
+QVariant LogTableModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    int row = rows.isEmpty() ? index.row() : rows.at(index.row());
+    return QString::fromUtf8(logTable.value(row, index.column()));
+}
+
+QVariant LogTableModel::headerData(int section, Qt::Orientation orientation,
+                                   int role) const {
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    if (orientation == Qt::Vertical) {
+        return section + 1;
+    }
+
+    return logTable.getColumnNames().value(section);
+}
+
+void LogTableModel::sort(int column, Qt::SortOrder order) {
+    if (column < 0 || column >= logTable.getColumnCount()) {
+        return;
+    }
+
+    emit layoutAboutToBeChanged();
+    rows = logTable.sortedRows(column, order);
+    emit layoutChanged();
+}
+
+LogTableGroupModel::LogTableGroupModel(QObject *parent) :
+        QAbstractTableModel(parent) {
+}
+
+void LogTableGroupModel::setGroupCounts(
+        const QString &columnName,
+        const QList<LogTable::GroupCount> &groupCounts) {
+    beginResetModel();
+    this->columnName = columnName;
+    this->groupCounts = groupCounts;
+    endResetModel();
+}
+
+int LogTableGroupModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : groupCounts.count();
+}
+
+int LogTableGroupModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : 2;
+}
+
+QVariant LogTableGroupModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    const LogTable::GroupCount &groupCount = groupCounts.at(index.row());
+
+    return index.column() == 0 ?
+           QVariant(QString::fromUtf8(groupCount.first)) :
+           QVariant(groupCount.second);
+}
+
+QVariant LogTableGroupModel::headerData(int section,
+                                        Qt::Orientation orientation,
+                                        int role) const {
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    if (orientation == Qt::Vertical) {
+        return section + 1;
+    }
+
+    return section == 0 ? columnName : tr("Count");
+}
+
+void LogTableGroupModel::sort(int column, Qt::SortOrder order) {
+    emit layoutAboutToBeChanged();
+
+    std::stable_sort(
+            groupCounts.begin(), groupCounts.end(),
+            [column, order](const LogTable::GroupCount &a,
+                            const LogTable::GroupCount &b) {
+                bool isLess = column == 0 ? a.first < b.first :
+                              a.second < b.second;
+                bool isGreater = column == 0 ? b.first < a.first :
+                                 b.second < a.second;
+
+                return order == Qt::AscendingOrder ? isLess : isGreater;
+            });
+
+    emit layoutChanged();
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#pragma once
+
+#include <QAbstractTableModel>
+#include <helpers/logtable.h>
+
+/**
+ * Shows the rows of a log table in a table view
+ *
+ * The values are only looked up for the rows that are visible, sorting
+ * replaces the order of the rows.
+ */
+class LogTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit LogTableModel(QObject *parent = 0);
+
+    void setLogTable(const LogTable &logTable);
+    qint64 line(const QModelIndex &index);
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder);
+
+private:
+    mutable LogTable logTable;
+    QVector<int> rows;
+};
+
+/**
+ * Shows the distinct values of a column of a log table with their counts
+ */
+class LogTableGroupModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit LogTableGroupModel(QObject *parent = 0);
+
+    void setGroupCounts(const QString &columnName,
+                        const QList<LogTable::GroupCount> &groupCounts);
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder);
+
+private:
+    QString columnName;
+    QList<LogTable::GroupCount> groupCounts;
+};
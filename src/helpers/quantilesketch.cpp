@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#include "quantilesketch.h"
+#include <qmath.h>
+
+// values closer to zero are counted as zero
+#define QUANTILE_SKETCH_MIN_VALUE 1e-9
+
+QuantileSketch::QuantileSketch(double accuracy) {
+    this->accuracy = accuracy;
+    gamma = (1 + accuracy) / (1 - accuracy);
+    logGamma = qLn(gamma);
+    count = 0;
+    zeroCount = 0;
+    min = 0;
+    max = 0;
+    sum = 0;
+}
+
+/**
+ * Returns the index of the bucket of a positive value, the bucket i holds
+ * the values in (gamma^(i-1), gamma^i]
+ */
+int QuantileSketch::bucketIndex(double value) const {
+    return static_cast<int>(qCeil(qLn(value) / logGamma));
+}
+
+/**
+ * Returns the value of a bucket with the lowest relative error of the
+ * values in it
+ */
+double QuantileSketch::bucketValue(int index) const {
+    return 2 * qPow(gamma, index) / (gamma + 1);
+}
+
+void QuantileSketch::add(double value, quint64 count) {
+    if (count == 0 || qIsNaN(value) || qIsInf(value)) {
+        return;
+    }
+
+    if (this->count == 0) {
+        min = value;
+        max = value;
+    } else {
+        min = qMin(min, value);
+        max = qMax(max, value);
+    }
+
+    this->count += count;
+    sum += value * count;
+
+    if (value > QUANTILE_SKETCH_MIN_VALUE) {
+        positiveBuckets[bucketIndex(value)] += count;
+        collapse(positiveBuckets);
+    } else if (value < -QUANTILE_SKETCH_MIN_VALUE) {
+        negativeBuckets[bucketIndex(-value)] += count;
+        collapse(negativeBuckets);
+    } else {
+        zeroCount += count;
+    }
+}
+
+/**
+ * Adds the values of a sketch with the same accuracy
+ */
+void QuantileSketch::merge(const QuantileSketch &other) {
+    if (other.count == 0) {
+        return;
+    }
+
+    if (count == 0) {
+        min = other.min;
+        max = other.max;
+    } else {
+        min = qMin(min, other.min);
+        max = qMax(max, other.max);
+    }
+
+    count += other.count;
+    zeroCount += other.zeroCount;
+    sum += other.sum;
+
+    QMapIterator<int, quint64> positiveIterator(other.positiveBuckets);
+    while (positiveIterator.hasNext()) {
+        positiveIterator.next();
+        positiveBuckets[positiveIterator.key()] += positiveIterator.value();
+    }
+
+    QMapIterator<int, quint64> negativeIterator(other.negativeBuckets);
+    while (negativeIterator.hasNext()) {
+        negativeIterator.next();
+        negativeBuckets[negativeIterator.key()] += negativeIterator.value();
+    }
+
+    collapse(positiveBuckets);
+    collapse(negativeBuckets);
+}
+
+/**
+ * Merges the lowest buckets if there are too many, which only lowers the
+ * accuracy of the values of the smallest magnitude
+ */
+void QuantileSketch::collapse(QMap<int, quint64> &buckets) {
+    while (buckets.count() > QUANTILE_SKETCH_MAX_BUCKET_COUNT) {
+        QMap<int, quint64>::iterator lowest = buckets.begin();
+        quint64 lowestCount = lowest.value();
+        lowest = buckets.erase(lowest);
+        lowest.value() += lowestCount;
+    }
+}
+
+bool QuantileSketch::isEmpty() const {
+    return count == 0;
+}
+
+quint64 QuantileSketch::getCount() const {
+    return count;
+}
+
+double QuantileSketch::getMin() const {
+    return min;
+}
+
+double QuantileSketch::getMax() const {
+    return max;
+}
+
+double QuantileSketch::getSum() const {
+    return sum;
+}
+
+/**
+ * Returns the value at a quantile between 0 and 1
+ */
+double QuantileSketch::quantile(double q) const {
+    if (count == 0) {
+        return 0;
+    }
+
+    if (q <= 0) {
+        return min;
+    }
+
+    if (q >= 1) {
+        return max;
+    }
+
+    // the rank of the value, counted from the lowest value
+    quint64 rank = static_cast<quint64>(q * (count - 1));
+    quint64 seen = 0;
+    double value = 0;
+    bool found = false;
+
+    // the negative values from the lowest to the highest
+    QMapIterator<int, quint64> negativeIterator(negativeBuckets);
+    negativeIterator.toBack();
+    while (!found && negativeIterator.hasPrevious()) {
+        negativeIterator.previous();
+        seen += negativeIterator.value();
+
+        if (seen > rank) {
+            value = -bucketValue(negativeIterator.key());
+            found = true;
+        }
+    }
+
+    if (!found) {
+        seen += zeroCount;
+        found = seen > rank;
+    }
+
+    QMapIterator<int, quint64> positiveIterator(positiveBuckets);
+    while (!found && positiveIterator.hasNext()) {
+        positiveIterator.next();
+        seen += positiveIterator.value();
+
+        if (seen > rank) {
+            value = bucketValue(positiveIterator.key());
+            found = true;
+        }
+    }
+
+    if (!found) {
+        value = max;
+    }
+
+    return qBound(min, value, max);
+}
+
+/**
+ * Returns the number of values in bins of equal width between the lowest
+ * and the highest value, the bins are named by their lower bound
+ *
+ * The values of a bucket are counted in the bin of the value of the bucket.
+ */
+QList<QuantileSketch::HistogramBin> QuantileSketch::histogram(
+        int binCount) const {
+    QList<HistogramBin> bins;
+
+    if (count == 0 || binCount < 1) {
+        return bins;
+    }
+
+    double width = (max - min) / binCount;
+
+    if (width <= 0) {
+        bins.append(HistogramBin(min, count));
+        return bins;
+    }
+
+    QList<quint64> binCounts;
+    for (int i = 0; i < binCount; i++) {
+        binCounts.append(0);
+    }
+
+    auto addToBin = [&](double value, quint64 valueCount) {
+        int bin = qBound(0, static_cast<int>((qBound(min, value, max) - min) /
+                                             width), binCount - 1);
+        binCounts[bin] += valueCount;
+    };
+
+    QMapIterator<int, quint64> negativeIterator(negativeBuckets);
+    while (negativeIterator.hasNext()) {
+        negativeIterator.next();
+        addToBin(-bucketValue(negativeIterator.key()),
+                 negativeIterator.value());
+    }
+
+    addToBin(0, zeroCount);
+
+    QMapIterator<int, quint64> positiveIterator(positiveBuckets);
+    while (positiveIterator.hasNext()) {
+        positiveIterator.next();
+        addToBin(bucketValue(positiveIterator.key()),
+                 positiveIterator.value());
+    }
+
+    for (int i = 0; i < binCount; i++) {
+        bins.append(HistogramBin(min + i * width, binCounts.at(i)));
+    }
+
+    return bins;
+}
+
+QDebug operator<<(QDebug dbg, const QuantileSketch &sketch) {
+    dbg.nospace() << "QuantileSketch: <count>" << sketch.count <<
+            " <min>" << sketch.min << " <max>" << sketch.max <<
+            " <positiveBuckets>" << sketch.positiveBuckets.count() <<
+            " <negativeBuckets>" << sketch.negativeBuckets.count();
+    return dbg.space();
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#pragma once
+
+#include <QMap>
+#include <QList>
+#include <QPair>
+#include <QDebug>
+
+// relative accuracy of the quantiles
+#define QUANTILE_SKETCH_DEFAULT_ACCURACY 0.01
+
+// maximum number of buckets of the values of a sign, the lowest buckets are
+// collapsed if there are more
+#define QUANTILE_SKETCH_MAX_BUCKET_COUNT 2048
+
+/**
+ * A mergeable sketch of the distribution of numbers (DDSketch)
+ *
+ * Values are counted in buckets with logarithmic bounds, so every quantile
+ * is returned with a relative error of at most `accuracy` and the memory
+ * only depends on the range of the values, not on their number. Sketches of
+ * parts of the data can be merged into a sketch of all of it.
+ */
+class QuantileSketch
+{
+public:
+    typedef QPair<double, quint64> HistogramBin;
+
+    explicit QuantileSketch(double accuracy = QUANTILE_SKETCH_DEFAULT_ACCURACY);
+
+    void add(double value, quint64 count = 1);
+    void merge(const QuantileSketch &other);
+    bool isEmpty() const;
+    quint64 getCount() const;
+    double getMin() const;
+    double getMax() const;
+    double getSum() const;
+    double quantile(double q) const;
+    QList<HistogramBin> histogram(int binCount) const;
+    friend QDebug operator<<(QDebug dbg, const QuantileSketch &sketch);
+
+private:
+    double accuracy;
+    double gamma;
+    double logGamma;
+    quint64 count;
+    quint64 zeroCount;
+    double min;
+    double max;
+    double sum;
+    QMap<int, quint64> positiveBuckets;
+    QMap<int, quint64> negativeBuckets;
+
+    int bucketIndex(double value) const;
+    double bucketValue(int index) const;
+    static void collapse(QMap<int, quint64> &buckets);
+};
@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#include "reportcube.h"
+#include <algorithm>
+#include <utils/tokennormalizer.h>
+
+// separates the texts of the groups in the keys of the cells
+#define REPORT_CUBE_KEY_SEPARATOR QChar(0x1f)
+
+namespace {
+    /**
+     * Returns the totals with the highest count first and the same counts
+     * by their text
+     */
+    QList<ReportCube::Total> sortedTotals(const QHash<QString, quint64> &hash) {
+        QList<ReportCube::Total> totals;
+        QHashIterator<QString, quint64> iterator(hash);
+
+        while (iterator.hasNext()) {
+            iterator.next();
+            totals.append(ReportCube::Total(iterator.key(), iterator.value()));
+        }
+
+        std::sort(totals.begin(), totals.end(),
+                  [](const ReportCube::Total &a,
+                     const ReportCube::Total &b) -> bool {
+                      return a.second != b.second ? a.second > b.second :
+                             a.first < b.first;
+                  });
+
+        return totals;
+    }
+}
+
+ReportCube::ReportCube(const QStringList &dimensions) {
+    this->dimensions = dimensions;
+    totalCount = 0;
+}
+
+/**
+ * Returns the names of the named capture groups of an expression
+ */
+QStringList ReportCube::namedGroups(const QRegularExpression &expression) {
+    QStringList groups;
+
+    Q_FOREACH(QString name, expression.namedCaptureGroups()) {
+            if (!name.isEmpty()) {
+                groups.append(name);
+            }
+        }
+
+    return groups;
+}
+
+/**
+ * Counts the matches of an expression in a text by the texts of its named
+ * groups, and by their time if a time histogram is passed
+ *
+ * If normalize is set the volatile tokens of the texts of the groups are
+ * replaced by placeholders.
+ */
+ReportCube ReportCube::countMatches(const QRegularExpression &expression,
+                                    const QString &text,
+                                    TimeHistogram *timeHistogram,
+                                    bool normalize) {
+    QStringList groups = namedGroups(expression);
+    ReportCube reportCube(groups);
+    QRegularExpressionMatchIterator iterator = expression.globalMatch(text);
+    QStringList values;
+
+    while (iterator.hasNext()) {
+        QRegularExpressionMatch match = iterator.next();
+        values.clear();
+
+        Q_FOREACH(QString group, groups) {
+                values.append(normalize ?
+                              Utils::TokenNormalizer::normalize(
+                                      match.captured(group)) :
+                              match.captured(group));
+            }
+
+        reportCube.add(values);
+
+        if (timeHistogram != NULL) {
+            timeHistogram->addMatch(text, match.capturedStart());
+        }
+    }
+
+    if (timeHistogram != NULL) {
+        timeHistogram->finishBlock(text);
+    }
+
+    return reportCube;
+}
+
+QString ReportCube::joinKey(const QStringList &values) {
+    return values.join(REPORT_CUBE_KEY_SEPARATOR);
+}
+
+/**
+ * Returns the texts of the groups of the key of a cell
+ */
+QStringList ReportCube::splitKey(const QString &key) {
+    return key.split(REPORT_CUBE_KEY_SEPARATOR);
+}
+
+void ReportCube::add(const QStringList &values, quint64 count) {
+    cells[joinKey(values)] += count;
+    totalCount += count;
+}
+
+/**
+ * Adds the cells of a cube with the same dimensions, an empty cube takes
+ * the dimensions of the other cube
+ */
+void ReportCube::merge(const ReportCube &other) {
+    if (dimensions.isEmpty()) {
+        dimensions = other.dimensions;
+    }
+
+    QHashIterator<QString, quint64> iterator(other.cells);
+    while (iterator.hasNext()) {
+        iterator.next();
+        cells[iterator.key()] += iterator.value();
+    }
+
+    totalCount += other.totalCount;
+}
+
+bool ReportCube::isEmpty() const {
+    return cells.isEmpty();
+}
+
+QStringList ReportCube::getDimensions() const {
+    return dimensions;
+}
+
+quint64 ReportCube::getTotalCount() const {
+    return totalCount;
+}
+
+/**
+ * Returns the count of a cell
+ */
+quint64 ReportCube::count(const QStringList &values) const {
+    return cells.value(joinKey(values));
+}
+
+/**
+ * Returns the counts of the texts of a dimension over all other
+ * dimensions, highest first
+ */
+QList<ReportCube::Total> ReportCube::dimensionTotals(int dimension) const {
+    QHash<QString, quint64> totals;
+    QHashIterator<QString, quint64> iterator(cells);
+
+    while (iterator.hasNext()) {
+        iterator.next();
+        totals[splitKey(iterator.key()).value(dimension)] += iterator.value();
+    }
+
+    return sortedTotals(totals);
+}
+
+/**
+ * Returns the counts of the combinations of the texts of all dimensions but
+ * the last one, highest first
+ */
+QList<ReportCube::Total> ReportCube::rowTotals() const {
+    QHash<QString, quint64> totals;
+    QHashIterator<QString, quint64> iterator(cells);
+
+    while (iterator.hasNext()) {
+        iterator.next();
+        QStringList values = splitKey(iterator.key());
+        values.removeLast();
+        totals[joinKey(values)] += iterator.value();
+    }
+
+    return sortedTotals(totals);
+}
+
+/**
+ * Returns the counts of the combinations of the texts of all dimensions,
+ * highest first
+ */
+QList<ReportCube::Total> ReportCube::cellTotals() const {
+    return sortedTotals(cells);
+}
+
+QDebug operator<<(QDebug dbg, const ReportCube &reportCube) {
+    dbg.nospace() << "ReportCube: <dimensions>" << reportCube.dimensions <<
+            " <cells>" << reportCube.cells.count() << " <totalCount>" <<
+            reportCube.totalCount;
+    return dbg.space();
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QRegularExpression>
+#include <QDebug>
+#include <helpers/timehistogram.h>
+
+/**
+ * Counts the matches of a report pattern with named capture groups by the
+ * combination of the texts of the groups
+ *
+ * Every named group is a dimension of the cube, the cells are kept in a hash
+ * by a composite key of the texts of the groups. Cubes of the blocks of a log
+ * can be counted in parallel and merged.
+ */
+class ReportCube
+{
+public:
+    typedef QPair<QString, quint64> Total;
+
+    explicit ReportCube(const QStringList &dimensions = QStringList());
+
+    static QStringList namedGroups(const QRegularExpression &expression);
+    static ReportCube countMatches(const QRegularExpression &expression,
+                                   const QString &text,
+                                   TimeHistogram *timeHistogram = NULL,
+                                   bool normalize = false);
+    void add(const QStringList &values, quint64 count = 1);
+    void merge(const ReportCube &other);
+    bool isEmpty() const;
+    QStringList getDimensions() const;
+    quint64 getTotalCount() const;
+    quint64 count(const QStringList &values) const;
+    QList<Total> dimensionTotals(int dimension) const;
+    QList<Total> rowTotals() const;
+    QList<Total> cellTotals() const;
+    static QStringList splitKey(const QString &key);
+    friend QDebug operator<<(QDebug dbg, const ReportCube &reportCube);
+
+private:
+    QStringList dimensions;
+    QHash<QString, quint64> cells;
+    quint64 totalCount;
+
+    static QString joinKey(const QStringList &values);
+};
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#include "reportresult.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QObject>
+#include <QTextStream>
+
+ReportResult::ReportResult() {
+}
+
+void ReportResult::clear() {
+    sections.clear();
+    rows.clear();
+}
+
+/**
+ * Adds the section of a pattern with its rows
+ */
+void ReportResult::addSection(Section section, QList<Row> sectionRows) {
+    section.firstRow = rows.count();
+    section.rowCount = sectionRows.count();
+
+    for (int i = 0; i < sectionRows.count(); i++) {
+        sectionRows[i].section = sections.count();
+        rows.append(sectionRows.at(i));
+    }
+
+    sections.append(section);
+}
+
+bool ReportResult::isEmpty() const {
+    return sections.isEmpty();
+}
+
+int ReportResult::getSectionCount() const {
+    return sections.count();
+}
+
+const ReportResult::Section &ReportResult::section(int index) const {
+    return sections.at(index);
+}
+
+int ReportResult::getRowCount() const {
+    return rows.count();
+}
+
+const ReportResult::Row &ReportResult::row(int index) const {
+    return rows.at(index);
+}
+
+/**
+ * Returns the value of a column of a row, counts are numbers
+ */
+QVariant ReportResult::value(int rowIndex, int column) const {
+    const Row &row = rows.at(rowIndex);
+
+    switch (column) {
+        case PatternColumn:
+            return sections.at(row.section).pattern;
+        case MatchColumn:
+            return row.match;
+        case CountColumn:
+            return row.count;
+        case NoteColumn:
+            return row.note;
+        default:
+            return QVariant();
+    }
+}
+
+QString ReportResult::columnName(int column) {
+    switch (column) {
+        case PatternColumn:
+            return QObject::tr("Pattern");
+        case MatchColumn:
+            return QObject::tr("Match");
+        case CountColumn:
+            return QObject::tr("Count");
+        case NoteColumn:
+            return QObject::tr("Note");
+        default:
+            return QString();
+    }
+}
+
+/**
+ * Writes the rows in an export format, in the order of rowOrder if it isn't
+ * empty
+ *
+ * Every row is written as soon as it's formatted, so only the buffer of the
+ * stream is held in memory. Returns false if the device couldn't be written.
+ */
+bool ReportResult::write(QIODevice *device, ExportFormat format,
+                         const QVector<int> &rowOrder) const {
+    QTextStream stream(device);
+    stream.setCodec("UTF-8");
+
+    QStringList keys;
+    keys << "pattern" << "match" << "count" << "note";
+
+    switch (format) {
+        case CsvFormat:
+            stream << keys.join(",") << "\r\n";
+            break;
+        case JsonFormat:
+            stream << "[";
+            break;
+        case MarkdownFormat:
+            stream << "|";
+
+            for (int column = 0; column < ColumnCount; column++) {
+                stream << " " << columnName(column) << " |";
+            }
+
+            stream << "\n|---|---|--:|---|\n";
+            break;
+    }
+
+    for (int i = 0; i < rows.count(); i++) {
+        const Row &row = rows.at(rowOrder.isEmpty() ? i : rowOrder.at(i));
+        QString pattern = sections.at(row.section).pattern;
+
+        switch (format) {
+            case CsvFormat:
+                stream << csvField(pattern) << "," << csvField(row.match) <<
+                        "," << row.count << "," << csvField(row.note) <<
+                        "\r\n";
+                break;
+            case JsonFormat: {
+                QJsonObject object;
+                object.insert(keys.at(0), pattern);
+                object.insert(keys.at(1), row.match);
+                object.insert(keys.at(2), static_cast<double>(row.count));
+                object.insert(keys.at(3), row.note);
+
+                stream << (i == 0 ? "\n" : ",\n") << QString::fromUtf8(
+                        QJsonDocument(object).toJson(QJsonDocument::Compact));
+                break;
+            }
+            case MarkdownFormat:
+                stream << "| " << markdownField(pattern) << " | " <<
+                        markdownField(row.match) << " | " << row.count <<
+                        " | " << markdownField(row.note) << " |\n";
+                break;
+        }
+
+        if (stream.status() != QTextStream::Ok) {
+            return false;
+        }
+    }
+
+    if (format == JsonFormat) {
+        stream << "\n]\n";
+    }
+
+    stream.flush();
+
+    return stream.status() == QTextStream::Ok;
+}
+
+/**
+ * Quotes a field of a CSV row if it contains separators, quotes or line
+ * breaks
+ */
+QString ReportResult::csvField(const QString &text) {
+    if (!text.contains(',') && !text.contains('"') &&
+            !text.contains('\r') && !text.contains('\n')) {
+        return text;
+    }
+
+    return "\"" + QString(text).replace("\"", "\"\"") + "\"";
+}
+
+/**
+ * Escapes the pipes of a field of a Markdown table, line breaks become
+ * spaces
+ */
+QString ReportResult::markdownField(const QString &text) {
+    return QString(text).replace("\\", "\\\\").replace("|", "\\|")
+            .replace("\r", "").replace("\n", " ");
+}
+
+QDebug operator<<(QDebug dbg, const ReportResult &reportResult) {
+    dbg.nospace() << "ReportResult: <sections>" <<
+            reportResult.sections.count() << " <rows>" <<
+            reportResult.rows.count();
+    return dbg.space();
+}
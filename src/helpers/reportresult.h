@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#pragma once
+
+#include <QString>
+#include <QList>
+#include <QVector>
+#include <QVariant>
+#include <QIODevice>
+#include <QDebug>
+#include <helpers/frequencysketch.h>
+#include <helpers/quantilesketch.h>
+#include <helpers/reportcube.h>
+#include <helpers/timehistogram.h>
+
+/**
+ * The results of the report patterns as structured data
+ *
+ * Every pattern has a section, its results are rows of match texts with
+ * their counts. The sketches and cubes of the patterns that were counted
+ * with them are kept, so the document of the report can be rendered when
+ * it's needed. The rows can be written as CSV, JSON or Markdown without
+ * building the whole output in memory.
+ */
+class ReportResult
+{
+public:
+    enum SectionModes {
+        ListSectionMode = 0,
+        SketchSectionMode,
+        NumericSectionMode,
+        CubeSectionMode
+    };
+
+    enum Columns {
+        PatternColumn = 0,
+        MatchColumn,
+        CountColumn,
+        NoteColumn,
+        ColumnCount
+    };
+
+    enum ExportFormat {
+        CsvFormat = 0,
+        JsonFormat,
+        MarkdownFormat
+    };
+
+    struct Row {
+        int section;
+        QString match;
+        quint64 count;
+        // like the error bound of a count of a sketch
+        QString note;
+
+        Row() : section(0), count(0) {}
+        Row(QString match, quint64 count, QString note = QString()) :
+                section(0), match(match), count(count), note(note) {}
+    };
+
+    struct Section {
+        QString pattern;
+        int mode;
+        int firstRow;
+        int rowCount;
+        TimeHistogram timeHistogram;
+        FrequencySketch frequencySketch;
+        QuantileSketch quantileSketch;
+        // matches of a numeric pattern that weren't numbers
+        quint64 invalidCount;
+        ReportCube reportCube;
+
+        Section() : mode(ListSectionMode), firstRow(0), rowCount(0),
+                    invalidCount(0) {}
+    };
+
+    explicit ReportResult();
+
+    void clear();
+    void addSection(Section section, QList<Row> sectionRows);
+    bool isEmpty() const;
+    int getSectionCount() const;
+    const Section &section(int index) const;
+    int getRowCount() const;
+    const Row &row(int index) const;
+    QVariant value(int rowIndex, int column) const;
+    static QString columnName(int column);
+    bool write(QIODevice *device, ExportFormat format,
+               const QVector<int> &rowOrder = QVector<int>()) const;
+    friend QDebug operator<<(QDebug dbg, const ReportResult &reportResult);
+
+private:
+    QList<Section> sections;
+    QVector<Row> rows;
+
+    static QString csvField(const QString &text);
+    static QString markdownField(const QString &text);
+};
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#include "reportresultmodel.h"
+#include <algorithm>
+
+ReportResultModel::ReportResultModel(QObject *parent) :
+        QAbstractTableModel(parent), reportResult(NULL) {
+}
+
+/**
+ * Sets the report result to show, it has to outlive the model or be
+ * replaced before it's changed
+ */
+void ReportResultModel::setReportResult(const ReportResult *reportResult) {
+    beginResetModel();
+    this->reportResult = reportResult;
+    rows.clear();
+    endResetModel();
+}
+
+/**
+ * Returns the indexes of the rows of the report result in the sorted order,
+ * empty if the rows weren't sorted
+ */
+QVector<int> ReportResultModel::getRowOrder() const {
+    return rows;
+}
+
+int ReportResultModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() || reportResult == NULL ?
+           0 : reportResult->getRowCount();
+}
+
+int ReportResultModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : ReportResult::ColumnCount;
+}
+
+QVariant ReportResultModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || reportResult == NULL) {
+        return QVariant();
+    }
+
+    if (role == Qt::TextAlignmentRole) {
+        return index.column() == ReportResult::CountColumn ?
+               QVariant(static_cast<int>(Qt::AlignRight | Qt::AlignVCenter)) :
+               QVariant();
+    }
+
+    if (role != Qt::DisplayRole && role != Qt::ToolTipRole) {
+        return QVariant();
+    }
+
+    int row = rows.isEmpty() ? index.row() : rows.at(index.row());
+    return reportResult->value(row, index.column());
+}
+
+QVariant ReportResultModel::headerData(int section,
+                                       Qt::Orientation orientation,
+                                       int role) const {
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    if (orientation == Qt::Vertical) {
+        return section + 1;
+    }
+
+    return ReportResult::columnName(section);
+}
+
+void ReportResultModel::sort(int column, Qt::SortOrder order) {
+    if (reportResult == NULL || column < 0 ||
+            column >= ReportResult::ColumnCount) {
+        return;
+    }
+
+    emit layoutAboutToBeChanged();
+
+    if (rows.count() != reportResult->getRowCount()) {
+        rows.resize(reportResult->getRowCount());
+
+        for (int i = 0; i < rows.count(); i++) {
+            rows[i] = i;
+        }
+    }
+
+    const ReportResult *result = reportResult;
+
+    // the rows of equal values keep the order of their sections
+    std::stable_sort(
+            rows.begin(), rows.end(),
+            [result, column, order](int a, int b) -> bool {
+                const ReportResult::Row &rowA = result->row(a);
+                const ReportResult::Row &rowB = result->row(b);
+                bool isLess;
+                bool isGreater;
+
+                if (column == ReportResult::CountColumn) {
+                    isLess = rowA.count < rowB.count;
+                    isGreater = rowB.count < rowA.count;
+                } else {
+                    QString valueA = result->value(a, column).toString();
+                    QString valueB = result->value(b, column).toString();
+                    int comparison = QString::localeAwareCompare(valueA,
+                                                                 valueB);
+                    isLess = comparison < 0;
+                    isGreater = comparison > 0;
+                }
+
+                return order == Qt::AscendingOrder ? isLess : isGreater;
+            });
+
+    emit layoutChanged();
+}
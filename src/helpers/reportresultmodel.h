@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#pragma once
+
+#include <QAbstractTableModel>
+#include <helpers/reportresult.h>
+
+/**
+ * Shows the rows of the report result in a table view
+ *
+ * Sorting only replaces the order of the rows, the order is also used when
+ * the rows are exported.
+ */
+class ReportResultModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit ReportResultModel(QObject *parent = 0);
+
+    void setReportResult(const ReportResult *reportResult);
+    QVector<int> getRowOrder() const;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder);
+
+private:
+    const ReportResult *reportResult;
+    QVector<int> rows;
+};
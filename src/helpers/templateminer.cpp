@@ -0,0 +1,307 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#include "templateminer.h"
+#include <QRegularExpression>
+#include <QStringList>
+#include <algorithm>
+#include <cstring>
+#include <utils/tokennormalizer.h>
+
+TemplateMiner::TemplateMiner(int depth, double similarity, int maxChildren) {
+    this->depth = depth;
+    this->similarity = similarity;
+    this->maxChildren = maxChildren;
+    lineCount = 0;
+
+    // the root node
+    nodes.append(Node());
+}
+
+/**
+ * Adds the lines of data, like a block of the log store
+ */
+void TemplateMiner::addLines(const QByteArray &data) {
+    const char *begin = data.constData();
+    const char *end = begin + data.size();
+
+    while (begin < end) {
+        const char *lineEnd = static_cast<const char *>(
+                memchr(begin, '\n', end - begin));
+
+        if (lineEnd == NULL) {
+            lineEnd = end;
+        }
+
+        addLine(begin, static_cast<int>(lineEnd - begin));
+        begin = lineEnd + 1;
+    }
+}
+
+/**
+ * Adds a line, empty lines are skipped
+ */
+void TemplateMiner::addLine(const char *line, int length) {
+    addTokens(tokenize(line, length));
+}
+
+/**
+ * Adds a line that was already split into tokens, or a template of an other
+ * miner with its count
+ */
+void TemplateMiner::addTokens(const QList<QByteArray> &tokens, quint64 count) {
+    if (tokens.isEmpty()) {
+        return;
+    }
+
+    lineCount += count;
+
+    int leafIndex = leafNode(tokens);
+    int templateIndex = findTemplate(leafIndex, tokens);
+
+    if (templateIndex < 0) {
+        Template lineTemplate;
+        lineTemplate.tokens = tokens;
+        lineTemplate.count = count;
+
+        nodes[leafIndex].templateIndexes.append(templates.count());
+        templates.append(lineTemplate);
+        return;
+    }
+
+    Template &lineTemplate = templates[templateIndex];
+    lineTemplate.count += count;
+
+    for (int i = 0; i < tokens.count(); i++) {
+        if (lineTemplate.tokens.at(i) != tokens.at(i)) {
+            lineTemplate.tokens[i] = TEMPLATE_MINER_WILDCARD;
+        }
+    }
+}
+
+/**
+ * Adds the templates of an other miner
+ */
+void TemplateMiner::merge(const TemplateMiner &other) {
+    Q_FOREACH(const Template &lineTemplate, other.templates) {
+            addTokens(lineTemplate.tokens, lineTemplate.count);
+        }
+}
+
+/**
+ * Returns the templates with the most lines, the most frequent first
+ */
+QList<TemplateMiner::Template> TemplateMiner::topTemplates(int count) const {
+    QList<Template> result = templates.toList();
+
+    std::sort(result.begin(), result.end(),
+              [](const Template &a, const Template &b) {
+                  return a.count > b.count;
+              });
+
+    return result.mid(0, count);
+}
+
+int TemplateMiner::getTemplateCount() const {
+    return templates.count();
+}
+
+quint64 TemplateMiner::getLineCount() const {
+    return lineCount;
+}
+
+/**
+ * Splits a line into tokens at spaces and tabs, numbers, hex ids, UUIDs and
+ * IP addresses in the tokens are replaced with placeholders
+ */
+QList<QByteArray> TemplateMiner::tokenize(const char *line, int length) {
+    QByteArray normalized = Utils::TokenNormalizer::normalize(line, length);
+    QList<QByteArray> tokens;
+    int tokenStart = -1;
+
+    for (int i = 0; i <= normalized.size(); i++) {
+        char c = i < normalized.size() ? normalized.at(i) : ' ';
+
+        if (c == ' ' || c == '\t' || c == '\r') {
+            if (tokenStart >= 0) {
+                tokens.append(normalized.mid(tokenStart, i - tokenStart));
+                tokenStart = -1;
+            }
+        } else if (tokenStart < 0) {
+            tokenStart = i;
+        }
+    }
+
+    return tokens;
+}
+
+/**
+ * Returns the text of a template with its tokens separated by spaces
+ */
+QString TemplateMiner::templateText(const Template &lineTemplate) {
+    QStringList tokens;
+
+    Q_FOREACH(const QByteArray &token, lineTemplate.tokens) {
+            tokens.append(QString::fromUtf8(token));
+        }
+
+    return tokens.join(" ");
+}
+
+/**
+ * Returns a regular expression that matches the whole lines of a template
+ *
+ * Wildcards and placeholders match any text without spaces, the expression
+ * can be used as ignore or report pattern.
+ */
+QString TemplateMiner::templateExpression(const Template &lineTemplate) {
+    static const QRegularExpression placeholderExpression(
+            "<(?:num|hex|uuid|ip)>");
+    QStringList tokenExpressions;
+
+    Q_FOREACH(const QByteArray &token, lineTemplate.tokens) {
+            QString text = QString::fromUtf8(token);
+
+            if (text == TEMPLATE_MINER_WILDCARD) {
+                tokenExpressions.append("\\S+");
+                continue;
+            }
+
+            QString tokenExpression;
+            int position = 0;
+            QRegularExpressionMatchIterator iterator =
+                    placeholderExpression.globalMatch(text);
+
+            while (iterator.hasNext()) {
+                QRegularExpressionMatch match = iterator.next();
+                tokenExpression += QRegularExpression::escape(
+                        text.mid(position,
+                                 match.capturedStart() - position)) + "\\S+?";
+                position = match.capturedEnd();
+            }
+
+            tokenExpressions.append(
+                    tokenExpression +
+                    QRegularExpression::escape(text.mid(position)));
+        }
+
+    return "(?m)^[ \\t]*" + tokenExpressions.join("[ \\t]+") + "[ \\t\\r]*$";
+}
+
+/**
+ * Returns the index of a child of a node, it is created if it doesn't exist
+ */
+int TemplateMiner::childNode(int parentIndex, const QByteArray &key) {
+    int index = nodes.at(parentIndex).children.value(key, -1);
+
+    if (index < 0) {
+        index = nodes.count();
+        nodes.append(Node());
+        nodes[parentIndex].children.insert(key, index);
+    }
+
+    return index;
+}
+
+/**
+ * Returns the index of the leaf of the parse tree for the tokens of a line
+ *
+ * Variable tokens and tokens that don't fit into a full node anymore take
+ * the wildcard branch.
+ */
+int TemplateMiner::leafNode(const QList<QByteArray> &tokens) {
+    int nodeIndex = childNode(0, QByteArray::number(tokens.count()));
+    int prefixLength = qMin(depth - 2, tokens.count());
+
+    for (int i = 0; i < prefixLength; i++) {
+        QByteArray token = isVariableToken(tokens.at(i)) ?
+                           QByteArray(TEMPLATE_MINER_WILDCARD) : tokens.at(i);
+        const QHash<QByteArray, int> &children = nodes.at(nodeIndex).children;
+
+        // one child is kept free for the wildcard branch
+        if (!children.contains(token) &&
+                children.count() >= maxChildren - 1) {
+            token = TEMPLATE_MINER_WILDCARD;
+        }
+
+        nodeIndex = childNode(nodeIndex, token);
+    }
+
+    return nodeIndex;
+}
+
+/**
+ * Returns the index of the template of a leaf that is most similar to the
+ * tokens of a line, or -1 if none is similar enough
+ *
+ * The similarity is the share of tokens that are equal to the tokens of the
+ * template, if it's the same for two templates the one with more wildcards
+ * wins.
+ */
+int TemplateMiner::findTemplate(int leafIndex,
+                                const QList<QByteArray> &tokens) const {
+    int bestIndex = -1;
+    double bestSimilarity = -1;
+    int bestWildcardCount = -1;
+
+    Q_FOREACH(int templateIndex, nodes.at(leafIndex).templateIndexes) {
+            const QList<QByteArray> &templateTokens =
+                    templates.at(templateIndex).tokens;
+            int equalCount = 0;
+            int wildcardCount = 0;
+
+            for (int i = 0; i < tokens.count(); i++) {
+                if (templateTokens.at(i) == TEMPLATE_MINER_WILDCARD) {
+                    wildcardCount++;
+                } else if (templateTokens.at(i) == tokens.at(i)) {
+                    equalCount++;
+                }
+            }
+
+            double tokenSimilarity =
+                    static_cast<double>(equalCount) / tokens.count();
+
+            if (tokenSimilarity > bestSimilarity ||
+                    (tokenSimilarity == bestSimilarity &&
+                     wildcardCount > bestWildcardCount)) {
+                bestIndex = templateIndex;
+                bestSimilarity = tokenSimilarity;
+                bestWildcardCount = wildcardCount;
+            }
+        }
+
+    return bestSimilarity >= similarity ? bestIndex : -1;
+}
+
+/**
+ * Returns if a token is likely a value, like a token with digits or a
+ * placeholder
+ */
+bool TemplateMiner::isVariableToken(const QByteArray &token) {
+    for (int i = 0; i < token.size(); i++) {
+        if (token.at(i) >= '0' && token.at(i) <= '9') {
+            return true;
+        }
+    }
+
+    return token.contains('<') && token.contains('>');
+}
+
+QDebug operator<<(QDebug dbg, const TemplateMiner &miner) {
+    dbg.nospace() << "TemplateMiner: <lineCount>" << miner.lineCount <<
+            " <templateCount>" << miner.templates.count() <<
+            " <nodeCount>" << miner.nodes.count();
+    return dbg.space();
+}
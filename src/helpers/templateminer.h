@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QHash>
+#include <QList>
+#include <QVector>
+#include <QDebug>
+
+// number of levels of the parse tree, the first two are the root and the
+// token count, the others are the leading tokens of the lines
+#define TEMPLATE_MINER_DEFAULT_DEPTH 4
+
+// share of equal tokens a line needs to be added to a template
+#define TEMPLATE_MINER_DEFAULT_SIMILARITY 0.4
+
+// maximum number of children of a node of the parse tree
+#define TEMPLATE_MINER_DEFAULT_MAX_CHILDREN 100
+
+// token that replaces the tokens in which the lines of a template differ
+#define TEMPLATE_MINER_WILDCARD "<*>"
+
+/**
+ * Clusters log lines into templates like "user <*> logged in" with a fixed
+ * depth parse tree (Drain)
+ *
+ * The lines are normalized and split into tokens first. The tree groups them
+ * by their token count and their leading tokens, in every leaf a line is
+ * added to the most similar template, or starts a new one. The tokens in
+ * which the lines of a template differ become wildcards.
+ *
+ * Miners of different parts of a log can be merged, their templates are
+ * added like lines with their counts.
+ */
+class TemplateMiner
+{
+public:
+    struct Template {
+        QList<QByteArray> tokens;
+        quint64 count;
+    };
+
+    explicit TemplateMiner(
+            int depth = TEMPLATE_MINER_DEFAULT_DEPTH,
+            double similarity = TEMPLATE_MINER_DEFAULT_SIMILARITY,
+            int maxChildren = TEMPLATE_MINER_DEFAULT_MAX_CHILDREN);
+
+    void addLines(const QByteArray &data);
+    void addLine(const char *line, int length);
+    void addTokens(const QList<QByteArray> &tokens, quint64 count = 1);
+    void merge(const TemplateMiner &other);
+    QList<Template> topTemplates(int count) const;
+    int getTemplateCount() const;
+    quint64 getLineCount() const;
+    static QList<QByteArray> tokenize(const char *line, int length);
+    static QString templateText(const Template &lineTemplate);
+    static QString templateExpression(const Template &lineTemplate);
+    friend QDebug operator<<(QDebug dbg, const TemplateMiner &miner);
+
+private:
+    struct Node {
+        QHash<QByteArray, int> children;
+        QList<int> templateIndexes;
+    };
+
+    int depth;
+    double similarity;
+    int maxChildren;
+    quint64 lineCount;
+    QVector<Node> nodes;
+    QVector<Template> templates;
+
+    int childNode(int parentIndex, const QByteArray &key);
+    int leafNode(const QList<QByteArray> &tokens);
+    int findTemplate(int leafIndex, const QList<QByteArray> &tokens) const;
+    static bool isVariableToken(const QByteArray &token);
+};
@@ -0,0 +1,249 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#include "timehistogram.h"
+#include <QList>
+#include <utils/timestamp.h>
+
+// number of characters at the start of a line a timestamp is looked for in
+#define TIME_HISTOGRAM_TIMESTAMP_LENGTH 64
+
+TimeHistogram::TimeHistogram() {
+    start = Utils::Timestamp::Invalid;
+    bucketSize = 0;
+    lastLineStart = -1;
+    lastTimestamp = Utils::Timestamp::Invalid;
+    leadingCount = 0;
+    endTimestamp = Utils::Timestamp::Invalid;
+}
+
+/**
+ * Returns an empty histogram of a time range with round bucket sizes, like
+ * 1 minute or 6 hours
+ */
+TimeHistogram TimeHistogram::forTimeRange(qint64 firstTimestamp,
+                                          qint64 lastTimestamp,
+                                          int maxBucketCount) {
+    TimeHistogram timeHistogram;
+
+    if (firstTimestamp == Utils::Timestamp::Invalid ||
+            lastTimestamp < firstTimestamp || maxBucketCount < 1) {
+        return timeHistogram;
+    }
+
+    const qint64 second = 1000;
+    const qint64 minute = 60 * second;
+    const qint64 hour = 60 * minute;
+    const qint64 day = 24 * hour;
+
+    QList<qint64> bucketSizes;
+    bucketSizes << second << 5 * second << 10 * second << 30 * second <<
+            minute << 5 * minute << 10 * minute << 15 * minute <<
+            30 * minute << hour << 3 * hour << 6 * hour << 12 * hour <<
+            day << 7 * day << 30 * day << 365 * day;
+
+    qint64 span = lastTimestamp - firstTimestamp + 1;
+    qint64 bucketSize = bucketSizes.last();
+
+    Q_FOREACH(qint64 size, bucketSizes) {
+            if (span <= size * maxBucketCount) {
+                bucketSize = size;
+                break;
+            }
+        }
+
+    // the buckets start at a multiple of their size
+    timeHistogram.bucketSize = bucketSize;
+    timeHistogram.start = firstTimestamp - firstTimestamp % bucketSize;
+    timeHistogram.counts.fill(0, static_cast<int>(
+            (lastTimestamp - timeHistogram.start) / bucketSize + 1));
+
+    return timeHistogram;
+}
+
+bool TimeHistogram::isValid() const {
+    return !counts.isEmpty();
+}
+
+/**
+ * Counts an event at a time, times outside of the range are counted in the
+ * first or last bucket
+ */
+void TimeHistogram::add(qint64 timestamp, quint64 count) {
+    if (counts.isEmpty() || timestamp == Utils::Timestamp::Invalid) {
+        return;
+    }
+
+    qint64 bucket = (timestamp - start) / bucketSize;
+    counts[static_cast<int>(qBound(
+            Q_INT64_C(0), bucket, static_cast<qint64>(counts.count() - 1)))] +=
+            count;
+}
+
+/**
+ * Counts an event at the time of a line
+ */
+void TimeHistogram::addLine(const char *line, int length, quint64 count) {
+    if (counts.isEmpty()) {
+        return;
+    }
+
+    add(Utils::Timestamp::parse(line, length), count);
+}
+
+/**
+ * Counts a match at a position of the text of a block at the time of the
+ * line of the match, matches in lines without a timestamp get the time of
+ * the previous line with one
+ *
+ * The matches have to be added in the order of their positions. Matches
+ * before the first line with timestamp are counted when the histogram is
+ * merged after the histogram of the previous block.
+ */
+void TimeHistogram::addMatch(const QString &text, int position) {
+    if (counts.isEmpty()) {
+        return;
+    }
+
+    int lineStart = position > 0 ?
+                    text.lastIndexOf('\n', position - 1) + 1 : 0;
+
+    if (lineStart != lastLineStart) {
+        // the lines back to the line of the previous match are searched for
+        // a timestamp, the time of that line is already known
+        int start = lineStart;
+        qint64 timestamp = lineTimestamp(text, start);
+
+        while (timestamp == Utils::Timestamp::Invalid && start > 0) {
+            start = start > 1 ? text.lastIndexOf('\n', start - 2) + 1 : 0;
+
+            if (start <= lastLineStart) {
+                timestamp = lastTimestamp;
+                break;
+            }
+
+            timestamp = lineTimestamp(text, start);
+        }
+
+        lastTimestamp = timestamp;
+        lastLineStart = lineStart;
+    }
+
+    if (lastTimestamp == Utils::Timestamp::Invalid) {
+        leadingCount++;
+    } else {
+        add(lastTimestamp);
+    }
+}
+
+/**
+ * Remembers the timestamp of the last line with one of the text of a block
+ * after its matches were added, the matches at the start of the next block
+ * get this time when the histograms are merged
+ */
+void TimeHistogram::finishBlock(const QString &text) {
+    if (counts.isEmpty()) {
+        return;
+    }
+
+    int start = text.size();
+    endTimestamp = Utils::Timestamp::Invalid;
+
+    while (start > 0) {
+        start = start > 1 ? text.lastIndexOf('\n', start - 2) + 1 : 0;
+
+        if (start <= lastLineStart) {
+            endTimestamp = lastTimestamp;
+            return;
+        }
+
+        endTimestamp = lineTimestamp(text, start);
+
+        if (endTimestamp != Utils::Timestamp::Invalid) {
+            return;
+        }
+    }
+}
+
+qint64 TimeHistogram::lineTimestamp(const QString &text, int lineStart) {
+    return Utils::Timestamp::parse(
+            text.mid(lineStart, TIME_HISTOGRAM_TIMESTAMP_LENGTH).toUtf8());
+}
+
+/**
+ * Adds the counts of the histogram of the next block with the same time
+ * range, an empty histogram takes the range of the other histogram
+ *
+ * The matches at the start of the next block without timestamp are counted
+ * at the last timestamp of this one, the matches at the start of the first
+ * block have no time and aren't counted.
+ */
+void TimeHistogram::merge(const TimeHistogram &other) {
+    if (counts.isEmpty()) {
+        start = other.start;
+        bucketSize = other.bucketSize;
+        counts = other.counts;
+        endTimestamp = other.endTimestamp;
+        return;
+    }
+
+    if (other.start != start || other.bucketSize != bucketSize ||
+            other.counts.count() != counts.count()) {
+        return;
+    }
+
+    for (int i = 0; i < counts.count(); i++) {
+        counts[i] += other.counts.at(i);
+    }
+
+    add(endTimestamp, other.leadingCount);
+
+    if (other.endTimestamp != Utils::Timestamp::Invalid) {
+        endTimestamp = other.endTimestamp;
+    }
+}
+
+int TimeHistogram::getBucketCount() const {
+    return counts.count();
+}
+
+qint64 TimeHistogram::getBucketSize() const {
+    return bucketSize;
+}
+
+qint64 TimeHistogram::getBucketStart(int bucket) const {
+    return start + bucket * bucketSize;
+}
+
+quint64 TimeHistogram::getCount(int bucket) const {
+    return counts.at(bucket);
+}
+
+quint64 TimeHistogram::getHighestCount() const {
+    quint64 highestCount = 0;
+
+    for (int i = 0; i < counts.count(); i++) {
+        highestCount = qMax(highestCount, counts.at(i));
+    }
+
+    return highestCount;
+}
+
+QDebug operator<<(QDebug dbg, const TimeHistogram &timeHistogram) {
+    dbg.nospace() << "TimeHistogram: <start>" << timeHistogram.start <<
+            " <bucketSize>" << timeHistogram.bucketSize <<
+            " <bucketCount>" << timeHistogram.counts.count();
+    return dbg.space();
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#pragma once
+
+#include <QString>
+#include <QVector>
+#include <QDebug>
+
+// number of buckets a time range is divided into at most
+#define TIME_HISTOGRAM_DEFAULT_BUCKET_COUNT 60
+
+/**
+ * Counts events like the matches of a report pattern in buckets of equal
+ * time spans
+ *
+ * The size of the buckets is a round time span that is chosen from the time
+ * range of the log. Histograms of the blocks of a log can be counted in
+ * parallel and merged in the order of the blocks. Matches in lines without
+ * timestamp get the time of the previous line with one, also if that line
+ * is in the previous block.
+ */
+class TimeHistogram
+{
+public:
+    explicit TimeHistogram();
+
+    static TimeHistogram forTimeRange(
+            qint64 firstTimestamp, qint64 lastTimestamp,
+            int maxBucketCount = TIME_HISTOGRAM_DEFAULT_BUCKET_COUNT);
+    bool isValid() const;
+    void add(qint64 timestamp, quint64 count = 1);
+    void addLine(const char *line, int length, quint64 count = 1);
+    void addMatch(const QString &text, int position);
+    void finishBlock(const QString &text);
+    void merge(const TimeHistogram &other);
+    int getBucketCount() const;
+    qint64 getBucketSize() const;
+    qint64 getBucketStart(int bucket) const;
+    quint64 getCount(int bucket) const;
+    quint64 getHighestCount() const;
+    friend QDebug operator<<(QDebug dbg, const TimeHistogram &timeHistogram);
+
+private:
+    qint64 start;
+    qint64 bucketSize;
+    QVector<quint64> counts;
+    // the line of the last match, so the timestamp of a line with multiple
+    // matches is only parsed once
+    int lastLineStart;
+    qint64 lastTimestamp;
+    // matches before the first line with timestamp of the block, they are
+    // counted at the last timestamp of the previous block when merged
+    quint64 leadingCount;
+    // the timestamp of the last line with one of the block
+    qint64 endTimestamp;
+
+    static qint64 lineTimestamp(const QString &text, int lineStart);
+};
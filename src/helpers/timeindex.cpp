@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+#include "timeindex.h"
+#include <QVector>
+#include <utils/timestamp.h>
+
+TimeIndex::TimeIndex() {
+    interval = TIME_INDEX_DEFAULT_INTERVAL;
+    firstTimestamp = Utils::Timestamp::Invalid;
+    lastTimestamp = Utils::Timestamp::Invalid;
+}
+
+/**
+ * Builds the index of a log store, the blocks are scanned in parallel
+ *
+ * Only the lines at the interval positions of a block are parsed, if such
+ * a line has no timestamp the following lines are tried.
+ */
+TimeIndex TimeIndex::build(LogStore &logStore, int interval) {
+    TimeIndex timeIndex;
+    timeIndex.interval = interval;
+
+    QList<QList<Entry>> blockEntries = logStore.mapBlocks<QList<Entry>>(
+            [interval](const QByteArray &block) -> QList<Entry> {
+                QList<Entry> entries;
+                int pos = 0;
+                qint64 line = 0;
+                qint64 nextLine = 0;
+
+                while (pos < block.size()) {
+                    int end = block.indexOf('\n', pos);
+                    end = end == -1 ? block.size() : end + 1;
+
+                    if (line >= nextLine) {
+                        qint64 timestamp = Utils::Timestamp::parse(
+                                block.constData() + pos, end - pos);
+
+                        if (timestamp != Utils::Timestamp::Invalid) {
+                            Entry entry;
+                            entry.line = line;
+                            entry.timestamp = timestamp;
+                            entries.append(entry);
+                            nextLine = line + interval;
+                        }
+                    }
+
+                    pos = end;
+                    line++;
+                }
+
+                return entries;
+            });
+
+    qint64 highestTimestamp = Utils::Timestamp::Invalid;
+
+    for (int i = 0; i < blockEntries.count(); i++) {
+        qint64 blockFirstLine = logStore.getBlockFirstLine(i);
+
+        Q_FOREACH(Entry entry, blockEntries.at(i)) {
+                if (timeIndex.firstTimestamp == Utils::Timestamp::Invalid) {
+                    timeIndex.firstTimestamp = entry.timestamp;
+                }
+
+                highestTimestamp = qMax(highestTimestamp, entry.timestamp);
+                entry.line += blockFirstLine;
+                entry.timestamp = highestTimestamp;
+                timeIndex.entries.append(entry);
+            }
+    }
+
+    timeIndex.lastTimestamp = highestTimestamp;
+
+    return timeIndex;
+}
+
+/**
+ * Puts the indexes of log stores together to the index of a store with
+ * their lines, the runs tell from which store the lines of the store come
+ *
+ * The lines of every store have to be kept in their order, like they are
+ * by concatenating or merging the stores, so the stores don't need to be
+ * scanned again.
+ */
+TimeIndex TimeIndex::merge(const QList<TimeIndex> &timeIndexes,
+                           const QList<LineSourceRun> &runs,
+                           qint64 lineCount) {
+    TimeIndex timeIndex;
+    qint64 highestTimestamp = Utils::Timestamp::Invalid;
+
+    // the next line and the next entry of every store
+    QVector<qint64> sourceLines(timeIndexes.count(), 0);
+    QVector<int> sourceEntries(timeIndexes.count(), 0);
+
+    for (int i = 0; i < runs.count(); i++) {
+        const LineSourceRun &run = runs.at(i);
+        qint64 runLastLine = i + 1 < runs.count() ?
+                             runs.at(i + 1).firstLine : lineCount;
+
+        if (run.source < 0 || run.source >= timeIndexes.count()) {
+            continue;
+        }
+
+        const QList<Entry> &entries = timeIndexes.at(run.source).entries;
+        qint64 sourceFirstLine = sourceLines.at(run.source);
+        qint64 sourceLastLine =
+                sourceFirstLine + runLastLine - run.firstLine;
+        int &entryIndex = sourceEntries[run.source];
+
+        while (entryIndex < entries.count() &&
+                entries.at(entryIndex).line < sourceLastLine) {
+            Entry entry = entries.at(entryIndex++);
+
+            if (timeIndex.firstTimestamp == Utils::Timestamp::Invalid) {
+                timeIndex.firstTimestamp = entry.timestamp;
+            }
+
+            highestTimestamp = qMax(highestTimestamp, entry.timestamp);
+            entry.line += run.firstLine - sourceFirstLine;
+            entry.timestamp = highestTimestamp;
+            timeIndex.entries.append(entry);
+        }
+
+        sourceLines[run.source] = sourceLastLine;
+    }
+
+    timeIndex.lastTimestamp = highestTimestamp;
+
+    return timeIndex;
+}
+
+bool TimeIndex::isEmpty() {
+    return entries.isEmpty();
+}
+
+qint64 TimeIndex::getFirstTimestamp() {
+    return firstTimestamp;
+}
+
+/**
+ * Returns the highest timestamp of the indexed lines
+ */
+qint64 TimeIndex::getLastTimestamp() {
+    return lastTimestamp;
+}
+
+/**
+ * Returns the first line with a timestamp at or after a time, the line count
+ * of the store is returned if there is no such line
+ */
+qint64 TimeIndex::lineForTimestamp(LogStore &logStore, qint64 timestamp) {
+    qint64 lineCount = logStore.getLineCount();
+
+    if (entries.isEmpty()) {
+        return lineCount;
+    }
+
+    // find the first entry that reached the timestamp
+    int low = 0;
+    int high = entries.count();
+
+    while (low < high) {
+        int middle = (low + high) / 2;
+
+        if (entries.at(middle).timestamp < timestamp) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    if (low == 0) {
+        return entries.first().line;
+    }
+
+    // scan the lines after the previous entry, they weren't all indexed
+    qint64 firstLine = entries.at(low - 1).line + 1;
+    qint64 lastLine = low < entries.count() ?
+                      entries.at(low).line : lineCount;
+    QByteArray data = logStore.lines(firstLine, lastLine - firstLine);
+    int pos = 0;
+
+    for (qint64 line = firstLine; line < lastLine; line++) {
+        int end = data.indexOf('\n', pos);
+        end = end == -1 ? data.size() : end + 1;
+
+        if (Utils::Timestamp::parse(data.constData() + pos, end - pos) >=
+                timestamp) {
+            return line;
+        }
+
+        pos = end;
+    }
+
+    return lastLine;
+}
+
+QDebug operator<<(QDebug dbg, const TimeIndex &timeIndex) {
+    dbg.nospace() << "TimeIndex: <entries>" << timeIndex.entries.count() <<
+            " <firstTimestamp>" << timeIndex.firstTimestamp <<
+            " <lastTimestamp>" << timeIndex.lastTimestamp;
+    return dbg.space();
+}
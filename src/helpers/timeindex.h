@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+#pragma once
+
+#include <QList>
+#include <QDebug>
+#include <helpers/logstore.h>
+#include <helpers/logmerger.h>
+
+// number of lines between two entries of the index
+#define TIME_INDEX_DEFAULT_INTERVAL 256
+
+/**
+ * A sparse index from timestamps to the lines of a log store
+ *
+ * About every `interval` lines the timestamp of a line is stored. Entries
+ * hold the highest timestamp up to their line, so the index is sorted even
+ * if the lines aren't and the first line at or after a time can be found
+ * with a binary search and a scan of at most `interval` lines.
+ */
+class TimeIndex
+{
+public:
+    struct Entry {
+        qint64 line;
+        qint64 timestamp;
+    };
+
+    explicit TimeIndex();
+
+    static TimeIndex build(LogStore &logStore,
+                           int interval = TIME_INDEX_DEFAULT_INTERVAL);
+    static TimeIndex merge(const QList<TimeIndex> &timeIndexes,
+                           const QList<LineSourceRun> &runs,
+                           qint64 lineCount);
+    bool isEmpty();
+    qint64 getFirstTimestamp();
+    qint64 getLastTimestamp();
+    qint64 lineForTimestamp(LogStore &logStore, qint64 timestamp);
+    friend QDebug operator<<(QDebug dbg, const TimeIndex &timeIndex);
+
+private:
+    int interval;
+    qint64 firstTimestamp;
+    qint64 lastTimestamp;
+    QList<Entry> entries;
+};
@@ -0,0 +1,13 @@
+/* Header for miniz.c, which is compiled as its own translation unit.
+   As suggested in miniz.c we define MINIZ_HEADER_FILE_ONLY and include it.
+   The zlib compatible names are disabled, they would clash with our own
+   functions like Utils::Gzip::uncompress(). */
+#ifndef MINIZ_HEADER_FILE_ONLY
+#define MINIZ_HEADER_FILE_ONLY
+#endif
+
+#ifndef MINIZ_NO_ZLIB_COMPATIBLE_NAMES
+#define MINIZ_NO_ZLIB_COMPATIBLE_NAMES
+#endif
+
+#include "miniz.c"
@@ -11,18 +11,75 @@
 #include <QDesktopServices>
 #include <QPrinter>
 #include <QPrintDialog>
+#include <QProgressBar>
+#include <QInputDialog>
 #include "version.h"
 #include <dialogs/settingsdialog.h>
 #include <services/databaseservice.h>
 #include <services/ezpublishservice.h>
+#include <services/logloaderservice.h>
 #include <QtCore/QJsonObject>
 #include <utils/misc.h>
+#include <utils/zip.h>
+#include <utils/timestamp.h>
+#include <utils/logrotation.h>
+#include <utils/tokennormalizer.h>
+#include <QElapsedTimer>
+#include <QScrollBar>
+#include <stdexcept>
+#include <QToolButton>
+#include <climits>
+#include <algorithm>
+#include <services/logfilterservice.h>
+#include <helpers/filterplan.h>
+#include <helpers/templateminer.h>
+
+// number of lines that are shown at once in the file view
+#define FILE_VIEW_PAGE_LINE_COUNT 100000
+
+// maximum number of occurrences that are listed below an expanded line of
+// the collapsed file view
+#define FILE_VIEW_OCCURRENCE_COUNT 1000
+
+// number of matches that are listed for report patterns counted with sketches
+#define REPORT_SKETCH_ENTRY_COUNT 100
+
+// number of matches of a pattern that are listed in the document of the
+// report, the table has all of them
+#define REPORT_DOCUMENT_ROW_COUNT 1000
+
+// number of bins and maximum bar length of the histograms of numeric report
+// patterns
+#define REPORT_HISTOGRAM_BIN_COUNT 20
+#define REPORT_HISTOGRAM_BAR_LENGTH 40
+
+// maximum number of rows and columns of the pivot tables of report patterns
+// with named groups
+#define REPORT_PIVOT_ROW_COUNT 200
+#define REPORT_PIVOT_COLUMN_COUNT 20
+
+// item data role of the report patterns that are normalized
+#define REPORT_PATTERN_NORMALIZED_ROLE (Qt::UserRole + 1)
+
+// prefix of the links of the bars of the time histograms of the report
+#define REPORT_TIME_RANGE_URL_PREFIX "loganalyzer-time:"
+
+// number of log templates that are listed in the template report
+#define REPORT_TEMPLATE_COUNT 100
+
+// prefixes of the links of the template report that add its expression as
+// ignore or report pattern
+#define REPORT_IGNORE_PATTERN_URL_PREFIX "loganalyzer-ignore-pattern:"
+#define REPORT_REPORT_PATTERN_URL_PREFIX "loganalyzer-report-pattern:"
 
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
     ui(new Ui::MainWindow)
 {
+    _fileViewFirstLine = 0;
+    _collapsedViewFirstEntry = 0;
+
     ui->setupUi(this);
     setWindowTitle("LogAnalyzer " + QString(VERSION));
 
@@ -37,9 +94,14 @@ MainWindow::MainWindow(QWidget *parent) :
             SLOT(loadLocalLogFileSourceFiles(QString)));
 
     setupStatusBar();
+    setupTimeToolBar();
+    setupFilterToolBar();
+    setupTableView();
+    setupDocumentPrinter();
     ui->fileListWidget->installEventFilter(this);
     ui->ignorePatternsListWidget->installEventFilter(this);
     ui->reportPatternsListWidget->installEventFilter(this);
+    ui->reportTextEdit->viewport()->installEventFilter(this);
     ui->fileTextEdit->installEventFilter(this);
     ui->localFilesTableWidget->installEventFilter(this);
     setupMainSplitter();
@@ -60,8 +122,302 @@ MainWindow::~MainWindow()
 }
 
 void MainWindow::setupStatusBar() {
+    _lineSourceLabel = new QLabel();
+    ui->statusBar->addPermanentWidget(_lineSourceLabel);
+    QObject::connect(ui->fileTextEdit, SIGNAL(cursorPositionChanged()),
+                     this, SLOT(updateLineSource()));
+
+    _previousPageButton = new QToolButton();
+    _previousPageButton->setArrowType(Qt::LeftArrow);
+    _previousPageButton->setToolTip(tr("Show the previous lines"));
+    _previousPageButton->setEnabled(false);
+    QObject::connect(_previousPageButton, SIGNAL(clicked()),
+                     this, SLOT(showPreviousFileViewPage()));
+    ui->statusBar->addPermanentWidget(_previousPageButton);
+
     _lineCountLabel = new QLabel();
     ui->statusBar->addPermanentWidget(_lineCountLabel);
+
+    _nextPageButton = new QToolButton();
+    _nextPageButton->setArrowType(Qt::RightArrow);
+    _nextPageButton->setToolTip(tr("Show the next lines"));
+    _nextPageButton->setEnabled(false);
+    QObject::connect(_nextPageButton, SIGNAL(clicked()),
+                     this, SLOT(showNextFileViewPage()));
+    ui->statusBar->addPermanentWidget(_nextPageButton);
+}
+
+/**
+ * Sets up the tool bar to filter the lines by a time range and to jump to
+ * the lines of a time
+ */
+void MainWindow::setupTimeToolBar() {
+    _timeToolBar = addToolBar(tr("Time"));
+    _timeToolBar->setObjectName("timeToolBar");
+
+    QString displayFormat = "yyyy-MM-dd HH:mm:ss";
+
+    _timeFromDateTimeEdit = new QDateTimeEdit();
+    _timeFromDateTimeEdit->setTimeSpec(Qt::UTC);
+    _timeFromDateTimeEdit->setDisplayFormat(displayFormat);
+    _timeFromDateTimeEdit->setToolTip(tr("Start of the time range"));
+    _timeToolBar->addWidget(_timeFromDateTimeEdit);
+
+    _timeToDateTimeEdit = new QDateTimeEdit();
+    _timeToDateTimeEdit->setTimeSpec(Qt::UTC);
+    _timeToDateTimeEdit->setDisplayFormat(displayFormat);
+    _timeToDateTimeEdit->setToolTip(tr("End of the time range"));
+    _timeToolBar->addWidget(_timeToDateTimeEdit);
+
+    QAction *filterAction = _timeToolBar->addAction(
+            QIcon::fromTheme("view-filter"), tr("Filter time range"));
+    filterAction->setToolTip(
+            tr("Remove the lines outside of the time range"));
+    QObject::connect(filterAction, SIGNAL(triggered()),
+                     this, SLOT(filterTimeRange()));
+
+    _timeToolBar->addSeparator();
+
+    _jumpToTimeDateTimeEdit = new QDateTimeEdit();
+    _jumpToTimeDateTimeEdit->setTimeSpec(Qt::UTC);
+    _jumpToTimeDateTimeEdit->setDisplayFormat(displayFormat);
+    _jumpToTimeDateTimeEdit->setToolTip(tr("Time to jump to"));
+    _timeToolBar->addWidget(_jumpToTimeDateTimeEdit);
+
+    QAction *jumpAction = _timeToolBar->addAction(
+            QIcon::fromTheme("go-jump"), tr("Jump to time"));
+    jumpAction->setToolTip(
+            tr("Show the first line at or after the time"));
+    QObject::connect(jumpAction, SIGNAL(triggered()),
+                     this, SLOT(jumpToTime()));
+
+    _timeToolBar->addSeparator();
+
+    QSettings settings;
+    _mergeByTimeAction = new QAction(QIcon::fromTheme("view-sort-ascending"),
+                                     tr("Merge files by time"), this);
+    _mergeByTimeAction->setObjectName("mergeByTimeAction");
+    _mergeByTimeAction->setToolTip(
+            tr("Show the lines of multiple log files in the order of "
+                       "their timestamps"));
+    _mergeByTimeAction->setCheckable(true);
+    _mergeByTimeAction->setChecked(
+            settings.value("mergeLogFilesByTime").toBool());
+    _timeToolBar->addAction(_mergeByTimeAction);
+    QObject::connect(_mergeByTimeAction, SIGNAL(toggled(bool)),
+                     this, SLOT(toggleMergeByTime(bool)));
+
+    updateTimeIndex();
+}
+
+/**
+ * Sets up the tool bar to filter the lines with a filter expression
+ */
+void MainWindow::setupFilterToolBar() {
+    QToolBar *filterToolBar = addToolBar(tr("Filter"));
+    filterToolBar->setObjectName("filterToolBar");
+
+    QSettings settings;
+    _filterExpressionLineEdit = new QLineEdit();
+    _filterExpressionLineEdit->setPlaceholderText(tr("Filter expression"));
+    _filterExpressionLineEdit->setToolTip(
+            tr("Keeps the lines that match the expression, like<br />"
+                       "<code>level = error AND path !~ /health/ AND "
+                       "time >= \"2016-06-14 11:00:00\"</code><br />"
+                       "Predicates compare <code>time</code>, "
+                       "<code>line</code> or a field with =, !=, ~, !~, "
+                       "contains, &lt;, &lt;=, &gt; or &gt;= and are combined "
+                       "with AND, OR, NOT and parentheses"));
+    _filterExpressionLineEdit->setText(
+            settings.value("filterExpression").toString());
+    filterToolBar->addWidget(_filterExpressionLineEdit);
+    QObject::connect(_filterExpressionLineEdit, SIGNAL(returnPressed()),
+                     this, SLOT(filterExpression()));
+
+    QAction *filterAction = filterToolBar->addAction(
+            QIcon::fromTheme("view-filter"), tr("Filter by expression"));
+    filterAction->setToolTip(
+            tr("Remove the lines that don't match the filter expression"));
+    QObject::connect(filterAction, SIGNAL(triggered()),
+                     this, SLOT(filterExpression()));
+
+    filterToolBar->addSeparator();
+
+    _collapseDuplicatesAction = new QAction(
+            QIcon::fromTheme("format-justify-fill"),
+            tr("Collapse duplicate lines"), this);
+    _collapseDuplicatesAction->setObjectName("collapseDuplicatesAction");
+    _collapseDuplicatesAction->setToolTip(
+            tr("Show every distinct line once with the number of its "
+                       "occurrences, lines that only differ by numbers, "
+                       "hex ids, UUIDs or IP addresses are duplicates"));
+    _collapseDuplicatesAction->setCheckable(true);
+    _collapseDuplicatesAction->setChecked(
+            settings.value("collapseDuplicateLines").toBool());
+    filterToolBar->addAction(_collapseDuplicatesAction);
+    QObject::connect(_collapseDuplicatesAction, SIGNAL(toggled(bool)),
+                     this, SLOT(toggleCollapseDuplicates(bool)));
+}
+
+/**
+ * Stores if duplicate lines should be collapsed and shows the lines
+ *
+ * If the lines are expanded again the line at the cursor is shown.
+ */
+void MainWindow::toggleCollapseDuplicates(bool checked) {
+    QSettings settings;
+    settings.setValue("collapseDuplicateLines", checked);
+
+    _expandedDuplicateEntries.clear();
+
+    if (checked) {
+        updateDuplicateIndex();
+        showCollapsedViewPage(0);
+    } else {
+        qint64 line = _collapsedViewLines.value(
+                ui->fileTextEdit->textCursor().blockNumber(), 0);
+
+        // the duplicates are only hashed while they are collapsed
+        _duplicateIndex = DuplicateIndex();
+        _collapsedViewLines.clear();
+        _collapsedViewEntries.clear();
+        showFileViewLine(line);
+    }
+}
+
+/**
+ * Keeps the lines of the log store that match the filter expression
+ *
+ * The expression is compiled into a plan that is optimized on the first
+ * block before the blocks are filtered in parallel.
+ */
+void MainWindow::filterExpression() {
+    QString expression = _filterExpressionLineEdit->text().trimmed();
+
+    if (expression.isEmpty()) {
+        return;
+    }
+
+    QSettings settings;
+    settings.setValue("filterExpression", expression);
+
+    FilterPlan filterPlan;
+
+    if (!filterPlan.compile(expression)) {
+        ui->statusBar->showMessage(
+                tr("Invalid filter expression: %1")
+                        .arg(filterPlan.getErrorMessage()), 8000);
+        return;
+    }
+
+    if (_logStore.getBlockCount() > 0) {
+        filterPlan.optimize(_logStore.block(0));
+    }
+
+    qDebug() << __func__ << " - 'filterPlan': " << filterPlan;
+
+    ui->statusBar->showMessage(tr("Filtering the lines by the expression"));
+
+    // the lines of every log file are filtered, so files that are loaded
+    // later are filtered the same way
+    _logFileSet.applyFilter([filterPlan](LogFileSet::File &file) {
+        // the lines without timestamp at the start of a block have the time
+        // of the last line with one of the blocks before
+        QHash<qint64, qint64> previousTimestamps;
+
+        if (filterPlan.hasTimePredicate()) {
+            QList<qint64> lastTimestamps = file.logStore->mapBlocks<qint64>(
+                    FilterPlan::lastTimestamp);
+            qint64 timestamp = Utils::Timestamp::Invalid;
+
+            for (int i = 0; i < lastTimestamps.count(); i++) {
+                previousTimestamps[file.logStore->getBlockFirstLine(i)] =
+                        timestamp;
+
+                if (lastTimestamps.at(i) != Utils::Timestamp::Invalid) {
+                    timestamp = lastTimestamps.at(i);
+                }
+            }
+        }
+
+        file.logStore->replaceWithMappedBlocks(
+                [filterPlan, previousTimestamps](
+                        const QByteArray &block, qint64 firstLine)
+                        -> QByteArray {
+                    return filterPlan.filterBlock(
+                            block, previousTimestamps.value(
+                                    firstLine, Utils::Timestamp::Invalid));
+                });
+    });
+
+    updateLogStore();
+    logStoreChanged();
+
+    ui->statusBar->showMessage(
+            tr("Done with filtering the lines by the expression"), 4000);
+}
+
+/**
+ * Stores if log files should be merged by time and reloads them
+ */
+void MainWindow::toggleMergeByTime(bool checked) {
+    QSettings settings;
+    settings.setValue("mergeLogFilesByTime", checked);
+
+    // the loaded log files only need to be put together again
+    if (_logFileSet.getFileCount() > 1) {
+        updateLogStore();
+        logStoreChanged();
+    }
+}
+
+/**
+ * Shows the log file the line at the cursor comes from in the status bar
+ */
+void MainWindow::updateLineSource() {
+    int blockNumber = ui->fileTextEdit->textCursor().blockNumber();
+    qint64 line = _collapseDuplicatesAction->isChecked() ?
+                  _collapsedViewLines.value(blockNumber, -1) :
+                  _fileViewFirstLine + blockNumber;
+    int source = line < 0 ? -1 :
+                 LogMerger::sourceForLine(_lineSourceRuns, line);
+
+    if (source < 0 || source >= _logFileSet.getFileCount()) {
+        _lineSourceLabel->clear();
+        _lineSourceLabel->setToolTip("");
+        return;
+    }
+
+    QString filePath = _logFileSet.file(source).filePath;
+    _lineSourceLabel->setText(QFileInfo(filePath).fileName());
+    _lineSourceLabel->setToolTip(filePath);
+}
+
+/**
+ * Sets up the table views that show the fields of the log lines and the
+ * rows of the report
+ */
+void MainWindow::setupTableView() {
+    ui->tableFormatComboBox->addItem(tr("Detect automatically"),
+                                     Utils::LogFormat::UnknownFormat);
+
+    QList<Utils::LogFormat::Format> formats;
+    formats << Utils::LogFormat::CombinedFormat <<
+            Utils::LogFormat::SyslogFormat <<
+            Utils::LogFormat::JsonLinesFormat;
+
+    Q_FOREACH(Utils::LogFormat::Format format, formats) {
+            ui->tableFormatComboBox->addItem(
+                    Utils::LogFormat::formatName(format), format);
+        }
+
+    _logTableModel = new LogTableModel(this);
+    _logTableGroupModel = new LogTableGroupModel(this);
+    ui->tableView->setModel(_logTableModel);
+
+    _reportResultModel = new ReportResultModel(this);
+    _reportDocumentCurrent = false;
+    ui->reportTableView->setModel(_reportResultModel);
 }
 
 void MainWindow::storeSettings() {
@@ -166,7 +522,17 @@ void MainWindow::loadLogFileList()
 
         for (int i = 0; i < logFiles.count(); i++) {
             QString logFile = logFiles.at(i);
-            QFileInfo fileInfo = QFileInfo(logFile);
+
+            // skip families of rotated log files without files
+            if (Utils::LogRotation::isFamilyPath(logFile)) {
+                if (!Utils::LogRotation::memberPaths(logFile).isEmpty()) {
+                    addPathToFileListWidget(logFile);
+                }
+
+                continue;
+            }
+
+            QFileInfo fileInfo = QFileInfo(Utils::Zip::archivePath(logFile));
 
             // skip files that are not readable
             if (fileInfo.isReadable() && fileInfo.isFile()) {
@@ -246,10 +612,15 @@ void MainWindow::storeReportPatterns(QSettings *settings)
 
     QStringList patternList;
     QList<QVariant> checkedList;
+    QList<QVariant> modeList;
+    QList<QVariant> normalizedList;
 
     Q_FOREACH(QListWidgetItem *item, items) {
             patternList.append(item->text());
             checkedList.append(item->checkState() == Qt::Checked);
+            modeList.append(item->data(Qt::UserRole).toInt());
+            normalizedList.append(
+                    item->data(REPORT_PATTERN_NORMALIZED_ROLE).toBool());
         }
 
     if (settings == NULL) {
@@ -258,6 +629,8 @@ void MainWindow::storeReportPatterns(QSettings *settings)
 
     settings->setValue("reportPatternExpressions", patternList);
     settings->setValue("reportPatternCheckedStates", checkedList);
+    settings->setValue("reportPatternModes", modeList);
+    settings->setValue("reportPatternNormalized", normalizedList);
 }
 
 /**
@@ -273,6 +646,10 @@ void MainWindow::loadReportPatterns(QSettings *settings)
             settings->value("reportPatternExpressions").toStringList();
     QList<QVariant> checkedList =
             settings->value("reportPatternCheckedStates").toList();
+    QList<QVariant> modeList =
+            settings->value("reportPatternModes").toList();
+    QList<QVariant> normalizedList =
+            settings->value("reportPatternNormalized").toList();
 
     if (patternList.count() > 0) {
         const QSignalBlocker blocker(this->ui->reportPatternsListWidget);
@@ -286,12 +663,128 @@ void MainWindow::loadReportPatterns(QSettings *settings)
                 item->setText(pattern);
                 item->setCheckState(checked ? Qt::Checked : Qt::Unchecked);
                 item->setFlags(item->flags() | Qt::ItemIsEditable);
+                setReportPatternMode(item, modeList.value(i).toInt(),
+                                     normalizedList.value(i).toBool());
                 ui->reportPatternsListWidget->addItem(item);
             }
         }
     }
 }
 
+/**
+ * Sets how the matches of a report pattern are counted and if their
+ * volatile tokens are replaced before they are counted
+ *
+ * The matches of numeric patterns are never normalized, their numbers
+ * would be replaced.
+ */
+void MainWindow::setReportPatternMode(QListWidgetItem *item, int mode,
+                                      bool normalized)
+{
+    normalized = normalized && mode != NumericReportPatternMode;
+
+    item->setData(Qt::UserRole, mode);
+    item->setData(REPORT_PATTERN_NORMALIZED_ROLE, normalized);
+
+    QFont font = item->font();
+    font.setItalic(mode != ExactReportPatternMode || normalized);
+    item->setFont(font);
+
+    QStringList toolTips;
+
+    switch (mode) {
+        case SketchReportPatternMode:
+            toolTips << tr("Only the most frequent matches are counted, "
+                                   "with a fixed amount of memory");
+            break;
+        case NumericReportPatternMode:
+            toolTips << tr("The matches are numbers, their quantiles and "
+                                   "histogram are reported");
+            break;
+    }
+
+    if (normalized) {
+        toolTips << tr("Numbers, hex ids, UUIDs and IP addresses in the "
+                               "matches are replaced by placeholders");
+    }
+
+    item->setToolTip(toolTips.join("<br />"));
+}
+
+/**
+ * Shows the context menu for the report pattern list to set how the
+ * matches of the selected patterns are counted
+ */
+void MainWindow::on_reportPatternsListWidget_customContextMenuRequested(
+        const QPoint &pos)
+{
+    QList<QListWidgetItem *> items =
+            ui->reportPatternsListWidget->selectedItems();
+
+    if (items.isEmpty()) {
+        return;
+    }
+
+    QPoint globalPos = ui->reportPatternsListWidget->mapToGlobal(pos);
+    QMenu menu;
+    int mode = items.first()->data(Qt::UserRole).toInt();
+
+    QAction *exactAction = menu.addAction(tr("Count all matches &exactly"));
+    exactAction->setCheckable(true);
+    exactAction->setChecked(mode == ExactReportPatternMode);
+
+    QAction *sketchAction = menu.addAction(
+            tr("Count the most &frequent matches with sketches"));
+    sketchAction->setCheckable(true);
+    sketchAction->setChecked(mode == SketchReportPatternMode);
+
+    QAction *numericAction = menu.addAction(
+            tr("Compute &quantiles of numeric matches"));
+    numericAction->setCheckable(true);
+    numericAction->setChecked(mode == NumericReportPatternMode);
+
+    menu.addSeparator();
+    bool normalized =
+            items.first()->data(REPORT_PATTERN_NORMALIZED_ROLE).toBool();
+    QAction *normalizeAction = menu.addAction(
+            tr("&Normalize numbers, ids and IP addresses"));
+    normalizeAction->setCheckable(true);
+    normalizeAction->setChecked(normalized);
+    normalizeAction->setEnabled(mode != NumericReportPatternMode);
+
+    QAction *selectedItem = menu.exec(globalPos);
+
+    if (selectedItem == NULL) {
+        return;
+    }
+
+    if (selectedItem == normalizeAction) {
+        Q_FOREACH(QListWidgetItem *item, items) {
+                setReportPatternMode(item, item->data(Qt::UserRole).toInt(),
+                                     !normalized);
+            }
+
+        storeReportPatterns();
+        return;
+    }
+
+    if (selectedItem == sketchAction) {
+        mode = SketchReportPatternMode;
+    } else if (selectedItem == numericAction) {
+        mode = NumericReportPatternMode;
+    } else {
+        mode = ExactReportPatternMode;
+    }
+
+    Q_FOREACH(QListWidgetItem *item, items) {
+            setReportPatternMode(
+                    item, mode,
+                    item->data(REPORT_PATTERN_NORMALIZED_ROLE).toBool());
+        }
+
+    storeReportPatterns();
+}
+
 void MainWindow::dragEnterEvent(QDragEnterEvent *e) {
     if (e->mimeData()->hasUrls()) {
         e->acceptProposedAction();
@@ -367,6 +860,33 @@ bool MainWindow::eventFilter(QObject *obj, QEvent *event) {
                 return true;
             }
         }
+    } else if (event->type() == QEvent::MouseButtonRelease &&
+            obj == ui->reportTextEdit->viewport()) {
+        // the bars of the time histograms of the report link to their
+        // time range
+        QMouseEvent *mouseEvent = static_cast<QMouseEvent *>(event);
+        QString anchor = ui->reportTextEdit->anchorAt(mouseEvent->pos());
+
+        if (anchor.startsWith(REPORT_TIME_RANGE_URL_PREFIX)) {
+            QStringList range = anchor.mid(
+                    QString(REPORT_TIME_RANGE_URL_PREFIX).length()).split('-');
+            jumpToTimeRange(range.value(0).toLongLong(),
+                            range.value(1).toLongLong());
+            return true;
+        } else if (anchor.startsWith(REPORT_IGNORE_PATTERN_URL_PREFIX)) {
+            // the templates of the template report can be added as patterns
+            ui->toolTabWidget->setCurrentIndex(ToolTabs::IgnorePatternTab);
+            addIgnorePattern(QUrl::fromPercentEncoding(anchor.mid(
+                    QString(REPORT_IGNORE_PATTERN_URL_PREFIX).length())
+                                                               .toLatin1()));
+            return true;
+        } else if (anchor.startsWith(REPORT_REPORT_PATTERN_URL_PREFIX)) {
+            ui->toolTabWidget->setCurrentIndex(ToolTabs::ReportPatternTab);
+            addReportPattern(QUrl::fromPercentEncoding(anchor.mid(
+                    QString(REPORT_REPORT_PATTERN_URL_PREFIX).length())
+                                                               .toLatin1()));
+            return true;
+        }
     }
 
     return QMainWindow::eventFilter(obj, event);
@@ -451,10 +971,10 @@ bool MainWindow::removeLogFiles() {
         qDeleteAll(ui->fileListWidget->selectedItems());
         storeLogFileList();
 
-        ui->fileTextEdit->clear();
-
-        // update the line count
-        updateLineCount();
+        _logFileSet.clear();
+        _logStore.clear();
+        _lineSourceRuns.clear();
+        logStoreChanged();
 
         return true;
     }
@@ -484,15 +1004,34 @@ bool MainWindow::removeLocalLogFiles() {
         const QSignalBlocker blocker(this->ui->fileListWidget);
         Q_UNUSED(blocker);
 
+        QStringList failedPaths;
+
         // remove all selected log files from the file system
         Q_FOREACH(QTableWidgetItem *item,
                   ui->localFilesTableWidget->selectedItems()) {
                 QString filePath = item->data(Qt::UserRole).toString();
-                QFile file(filePath);
+                bool removed = true;
+
+                // all files of a family of rotated log files are removed
+                if (Utils::LogRotation::isFamilyPath(filePath)) {
+                    Q_FOREACH(QString memberPath,
+                              Utils::LogRotation::memberPaths(filePath)) {
+                            if (!QFile::remove(memberPath)) {
+                                failedPaths.append(memberPath);
+                                removed = false;
+                            }
+                        }
+                } else {
+                    QFile file(filePath);
+                    removed = file.exists() && file.remove();
+
+                    if (!removed) {
+                        failedPaths.append(filePath);
+                    }
+                }
 
-                // remove the file and check for items in the evaluation file
-                // list widget
-                if (file.exists() && file.remove()) {
+                // check for items in the evaluation file list widget
+                if (removed) {
                     // search for items to remove in the evaluation file list
                     // widget
                     QList<QListWidgetItem*> items =
@@ -507,6 +1046,15 @@ bool MainWindow::removeLocalLogFiles() {
                 }
             }
 
+        if (!failedPaths.isEmpty()) {
+            QMessageBox::warning(
+                    this, tr("Remove selected files"),
+                    tr("%n file(s) couldn't be removed:", "",
+                       failedPaths.count()) + "<br /><br />" +
+                            failedPaths.join("\n").toHtmlEscaped()
+                                    .replace("\n", "<br />"));
+        }
+
         return true;
     }
 
@@ -668,188 +1216,711 @@ void MainWindow::importReportPatterns() {
  */
 void MainWindow::updateLineCount()
 {
-    // count the lines in the text
-    int lineCount = ui->fileTextEdit->toPlainText().count("\n") + 1;
+    qint64 lineCount = _logStore.getLineCount();
+
+    if (_collapseDuplicatesAction->isChecked()) {
+        int entryCount = _duplicateIndex.getEntryCount();
+        int lastEntry = qMin(
+                _collapsedViewFirstEntry + FILE_VIEW_PAGE_LINE_COUNT,
+                entryCount);
+
+        if (entryCount > FILE_VIEW_PAGE_LINE_COUNT) {
+            _lineCountLabel->setText(
+                    tr("distinct lines %L1-%L2 of %L3 in %L4 lines")
+                            .arg(_collapsedViewFirstEntry + 1)
+                            .arg(lastEntry)
+                            .arg(entryCount)
+                            .arg(lineCount));
+        } else {
+            _lineCountLabel->setText(
+                    tr("%L1 distinct line(s) in %L2 line(s)")
+                            .arg(entryCount).arg(lineCount));
+        }
+
+        _previousPageButton->setEnabled(_collapsedViewFirstEntry > 0);
+        _nextPageButton->setEnabled(lastEntry < entryCount);
+        return;
+    }
+    qint64 lastLine = qMin(_fileViewFirstLine + FILE_VIEW_PAGE_LINE_COUNT,
+                           lineCount);
+
+    // set the line count, with the shown lines if not all lines are shown
+    if (lineCount > FILE_VIEW_PAGE_LINE_COUNT) {
+        _lineCountLabel->setText(tr("lines %L1-%L2 of %L3")
+                                         .arg(_fileViewFirstLine + 1)
+                                         .arg(lastLine)
+                                         .arg(lineCount));
+    } else {
+        _lineCountLabel->setText(tr("%L1 line(s)").arg(lineCount));
+    }
 
-    // set the line count
-    _lineCountLabel->setText(tr("%L1 line(s)").arg(lineCount));
+    _previousPageButton->setEnabled(_fileViewFirstLine > 0);
+    _nextPageButton->setEnabled(lastLine < lineCount);
 }
 
 /**
- * Loads a log file
+ * Shows the lines of the log store starting at firstLine in the file view
+ *
+ * Only a page of lines is put into the text edit, the rest of the loaded
+ * data stays compressed in the log store
  */
-void MainWindow::loadLogFiles()
+void MainWindow::showFileViewPage(qint64 firstLine)
 {
-    QString logString;
+    _fileViewFirstLine = qMax(Q_INT64_C(0), firstLine);
 
-    QList<QListWidgetItem *> items = ui->fileListWidget->selectedItems();
-    Q_FOREACH(QListWidgetItem *item, items) {
-            qDebug() << __func__ << " - 'item': " << item;
+    QByteArray data = _logStore.lines(_fileViewFirstLine,
+                                      FILE_VIEW_PAGE_LINE_COUNT);
 
-            QFile file(item->text());
+    if (data.endsWith('\n')) {
+        data.chop(1);
+    }
 
-            if (!file.exists()) {
-                QString warning = tr("File '%1' does not exist!")
-                                      .arg(file.fileName());
-                qWarning() << warning;
-                ui->statusBar->showMessage(warning);
-                continue;
-            }
+    ui->fileTextEdit->setPlainText(QString::fromUtf8(data));
 
-            if (!file.open(QIODevice::ReadOnly)) {
-                qWarning() << file.errorString();
-                ui->statusBar->showMessage(file.errorString());
-                continue;
-            }
+    // update the line count
+    updateLineCount();
+}
 
-            qDebug() << __func__ << " - 'file': " << file.fileName();
+/**
+ * Shows the page of the file view with a line and moves the cursor to it,
+ * duplicate lines are expanded first
+ */
+void MainWindow::showFileViewLine(qint64 line)
+{
+    // this shows the lines again if they were collapsed
+    _collapseDuplicatesAction->setChecked(false);
 
-            ui->statusBar->showMessage(
-                    tr("Loading log file <strong>%1</strong>")
-                            .arg(file.fileName()));
+    qint64 pageFirstLine = line - line % FILE_VIEW_PAGE_LINE_COUNT;
+    showFileViewPage(pageFirstLine);
 
-            logString += file.readAll();
-            file.close();
-        }
+    QTextCursor cursor(ui->fileTextEdit->document()->findBlockByNumber(
+            static_cast<int>(line - pageFirstLine)));
+    ui->fileTextEdit->setTextCursor(cursor);
+    ui->fileTextEdit->centerCursor();
+}
 
-    ui->statusBar->showMessage(tr("Updating line count"));
+void MainWindow::showPreviousFileViewPage()
+{
+    if (_collapseDuplicatesAction->isChecked()) {
+        showCollapsedViewPage(
+                _collapsedViewFirstEntry - FILE_VIEW_PAGE_LINE_COUNT);
+        return;
+    }
 
-    ui->fileTextEdit->setPlainText(logString);
+    showFileViewPage(_fileViewFirstLine - FILE_VIEW_PAGE_LINE_COUNT);
+}
 
-    // update the line count
-    updateLineCount();
+void MainWindow::showNextFileViewPage()
+{
+    if (_collapseDuplicatesAction->isChecked()) {
+        showCollapsedViewPage(
+                _collapsedViewFirstEntry + FILE_VIEW_PAGE_LINE_COUNT);
+        return;
+    }
 
-    ui->statusBar->showMessage(tr("Done loading log files"), 4000);
+    showFileViewPage(_fileViewFirstLine + FILE_VIEW_PAGE_LINE_COUNT);
 }
 
 /**
- * Removes occurrences of the ignore patterns from the text
+ * Rebuilds the index of the duplicate lines of the log store
  */
-void MainWindow::on_removeIgnoredPatternsButton_clicked()
+void MainWindow::updateDuplicateIndex()
 {
-    ui->viewTabWidget->setCurrentIndex(ViewTabs::FileViewTab);
+    QElapsedTimer timer;
+    timer.start();
 
-    QList<QListWidgetItem *> items =
-            ui->ignorePatternsListWidget->findItems(
-                    QString("*"), Qt::MatchWrap | Qt::MatchWildcard);
-    QString logText = ui->fileTextEdit->toPlainText();
+    _duplicateIndex = DuplicateIndex::build(_logStore);
 
-    ui->statusBar->showMessage(tr("Removing occurrences of the ignore "
-                                          "patterns in the text"));
+    qDebug() << __func__ << " - 'duplicateIndex': " << _duplicateIndex;
+    qDebug() << __func__ << " - 'elapsed': " << timer.elapsed();
+}
 
-    // remove all occurrences of the ignore patterns from the text
-    Q_FOREACH(QListWidgetItem *item, items) {
-            if ( item->checkState() != Qt::Checked ) {
-                continue;
-            }
+/**
+ * Shows the distinct lines starting at the entry firstEntry of the duplicate
+ * index in the file view, with the number of their occurrences and the
+ * lines of their first and last occurrence
+ *
+ * The occurrences of the expanded entries are listed below them.
+ */
+void MainWindow::showCollapsedViewPage(int firstEntry)
+{
+    _collapsedViewFirstEntry = qMax(0, firstEntry);
+    _collapsedViewLines.clear();
+    _collapsedViewEntries.clear();
+
+    int lastEntry = qMin(_collapsedViewFirstEntry + FILE_VIEW_PAGE_LINE_COUNT,
+                         _duplicateIndex.getEntryCount());
+    QStringList lines;
+
+    for (int i = _collapsedViewFirstEntry; i < lastEntry; i++) {
+        DuplicateIndex::Entry entry = _duplicateIndex.getEntry(i);
+        QString position = entry.count == 1 ?
+                           tr("line %L1").arg(entry.firstLine + 1) :
+                           tr("lines %L1-%L2").arg(entry.firstLine + 1)
+                                   .arg(entry.lastLine + 1);
+
+        // all arguments are replaced at once, so markers in the line are
+        // kept
+        lines.append(QString("%1%2 %3: %4").arg(
+                QString::number(entry.count), QString(QChar(0x00d7)),
+                position, QString::fromUtf8(entry.line)));
+        _collapsedViewLines.append(entry.firstLine);
+        _collapsedViewEntries.append(i);
+
+        if (!_expandedDuplicateEntries.contains(i)) {
+            continue;
+        }
 
-            QString pattern = item->text();
-            qDebug() << __func__ << " - 'pattern': " << pattern;
+        QList<QPair<qint64, QByteArray>> occurrences =
+                _duplicateIndex.occurrences(_logStore, i,
+                                            FILE_VIEW_OCCURRENCE_COUNT);
 
-            QRegularExpression expression(pattern + "\n");
-            logText.remove(expression);
+        for (int j = 0; j < occurrences.count(); j++) {
+            lines.append(QString("    %1: %2").arg(
+                    QString::number(occurrences.at(j).first + 1),
+                    QString::fromUtf8(occurrences.at(j).second)));
+            _collapsedViewLines.append(occurrences.at(j).first);
+            _collapsedViewEntries.append(i);
         }
+    }
 
-    // remove empty lines
-    logText = logText.split(QRegExp("\n|\r\n"), QString::SkipEmptyParts)
-            .join("\n");
-
-    ui->fileTextEdit->setPlainText(logText);
+    ui->fileTextEdit->setPlainText(lines.join("\n"));
 
     // update the line count
     updateLineCount();
-
-    ui->statusBar->showMessage(tr("Done with filtering occurrences of the "
-                                          "ignore patterns in the text"), 4000);
 }
 
 /**
- * Adds an ignore pattern to the list
+ * Expands or collapses the occurrences of an entry of the collapsed file
+ * view
  */
-void MainWindow::on_actionAdd_ignore_pattern_triggered()
+void MainWindow::toggleDuplicateOccurrences(int entryIndex)
 {
-    ui->toolTabWidget->setCurrentIndex(ToolTabs::IgnorePatternTab);
-    QString selectedText = ui->fileTextEdit->textCursor().selectedText();
+    if (!_expandedDuplicateEntries.remove(entryIndex)) {
+        _expandedDuplicateEntries.insert(entryIndex);
+    }
 
-    // add an ignore pattern
-    addIgnorePattern(".+" + QRegularExpression::escape(selectedText) + ".+");
+    int scrollPosition = ui->fileTextEdit->verticalScrollBar()->value();
+    showCollapsedViewPage(_collapsedViewFirstEntry);
+    ui->fileTextEdit->verticalScrollBar()->setValue(scrollPosition);
 }
 
 /**
- * Adds text as ignore pattern to the list
+ * Puts the time index of the log store together from the time indexes of
+ * the log files and sets the time range of the time tool bar to the time
+ * range of the lines
  */
-void MainWindow::addIgnorePattern(QString text)
+void MainWindow::updateTimeIndex()
 {
-    QListWidgetItem *item = new QListWidgetItem();
-    item->setText(text);
-    item->setCheckState(Qt::Checked);
-    item->setFlags(item->flags() | Qt::ItemIsEditable);
-    ui->ignorePatternsListWidget->addItem(item);
-    ui->ignorePatternsListWidget->scrollToItem(item);
-    ui->ignorePatternsListWidget->editItem(item);
+    _timeIndex = _logFileSet.mergeTimeIndexes(_lineSourceRuns,
+                                              _logStore.getLineCount());
+    qDebug() << __func__ << " - 'timeIndex': " << _timeIndex;
+
+    // the time range controls are only enabled if there are lines with
+    // timestamps
+    Q_FOREACH(QAction *action, _timeToolBar->actions()) {
+            if (action != _mergeByTimeAction) {
+                action->setEnabled(!_timeIndex.isEmpty());
+            }
+        }
 
-    // store ignore patterns
-    storeIgnorePatterns();
+    if (_timeIndex.isEmpty()) {
+        return;
+    }
+
+    QDateTime firstDateTime =
+            Utils::Timestamp::toDateTime(_timeIndex.getFirstTimestamp());
+    QDateTime lastDateTime =
+            Utils::Timestamp::toDateTime(_timeIndex.getLastTimestamp());
+
+    _timeFromDateTimeEdit->setDateTime(firstDateTime);
+    _timeToDateTimeEdit->setDateTime(lastDateTime);
+    _jumpToTimeDateTimeEdit->setDateTime(firstDateTime);
 }
 
 /**
- * Searches for the current ignore pattern if an other item was selected
+ * Updates everything that depends on the lines of the log store after they
+ * were loaded or filtered
  */
-void MainWindow::on_ignorePatternsListWidget_currentItemChanged(
-        QListWidgetItem *current, QListWidgetItem *previous)
+void MainWindow::logStoreChanged()
 {
-    Q_UNUSED(current);
-    Q_UNUSED(previous);
-    findCurrentIgnorePattern();
+    updateTimeIndex();
+
+    // the table has to be parsed again
+    _logTable = LogTable();
+    _logTableModel->setLogTable(_logTable);
+    ui->tableView->setModel(_logTableModel);
+    ui->tableGroupByComboBox->clear();
+
+    _expandedDuplicateEntries.clear();
+
+    if (_collapseDuplicatesAction->isChecked()) {
+        updateDuplicateIndex();
+        showCollapsedViewPage(0);
+    } else {
+        showFileViewPage(0);
+    }
 }
 
 /**
- * Stores the ignore patterns and searches for the current pattern if an item
- * was changed
+ * Removes the lines outside of the time range of the time tool bar
+ *
+ * The borders of the range are found with the time index of every log file,
+ * files that are loaded later keep the lines of the same range.
  */
-void MainWindow::on_ignorePatternsListWidget_itemChanged(QListWidgetItem *item)
+void MainWindow::filterTimeRange()
 {
-    Q_UNUSED(item);
+    qint64 fromTimestamp = Utils::Timestamp::fromDateTime(
+            _timeFromDateTimeEdit->dateTime());
+    qint64 toTimestamp = Utils::Timestamp::fromDateTime(
+            _timeToDateTimeEdit->dateTime());
+
+    if (fromTimestamp > toTimestamp) {
+        ui->statusBar->showMessage(
+                tr("The start of the time range is after its end"), 4000);
+        return;
+    }
 
-    // store ignore patterns
-    storeIgnorePatterns();
+    // every log file keeps its lines of the range, the range includes all
+    // lines of the last second
+    _logFileSet.applyFilter(
+            [fromTimestamp, toTimestamp](LogFileSet::File &file) {
+                TimeIndex &timeIndex = LogFileSet::timeIndex(file);
+                qint64 firstLine = timeIndex.lineForTimestamp(
+                        *file.logStore, fromTimestamp);
+                qint64 lastLine = timeIndex.lineForTimestamp(
+                        *file.logStore, toTimestamp + 1000);
 
-    findCurrentIgnorePattern();
+                file.logStore->keepLines(firstLine, lastLine - firstLine);
+            });
+
+    updateLogStore();
+    logStoreChanged();
+
+    ui->statusBar->showMessage(
+            tr("Done with filtering the lines of the time range"), 4000);
 }
 
 /**
- * Opens the find widget
+ * Shows the lines starting at the first line at or after the time of the
+ * time tool bar
  */
-void MainWindow::on_action_Find_in_file_triggered()
+void MainWindow::jumpToTime()
 {
-    _searchWidget->activate();
+    qint64 timestamp = Utils::Timestamp::fromDateTime(
+            _jumpToTimeDateTimeEdit->dateTime());
+    qint64 line = _timeIndex.lineForTimestamp(_logStore, timestamp);
+
+    if (line >= _logStore.getLineCount()) {
+        ui->statusBar->showMessage(
+                tr("There are no lines at or after that time"), 4000);
+        return;
+    }
+
+    // this shows the lines again if they were collapsed
+    _collapseDuplicatesAction->setChecked(false);
+    showFileViewPage(line);
+
+    ui->fileTextEdit->moveCursor(QTextCursor::Start);
+    ui->fileTextEdit->setFocus();
 }
 
 /**
- * Exports ignore patterns
+ * Shows the lines of a time range in the file view and sets the range in
+ * the time tool bar, so it can be filtered
  */
-void MainWindow::on_actionExport_ignore_patterns_triggered()
+void MainWindow::jumpToTimeRange(qint64 fromTimestamp, qint64 toTimestamp)
 {
-    exportIgnorePatterns();
+    _timeFromDateTimeEdit->setDateTime(
+            Utils::Timestamp::toDateTime(fromTimestamp));
+    _timeToDateTimeEdit->setDateTime(
+            Utils::Timestamp::toDateTime(toTimestamp));
+    _jumpToTimeDateTimeEdit->setDateTime(
+            Utils::Timestamp::toDateTime(fromTimestamp));
+
+    ui->viewTabWidget->setCurrentIndex(ViewTabs::FileViewTab);
+    jumpToTime();
 }
 
 /**
- * Imports ignore patterns
+ * Loads the selected log files
+ *
+ * Only the files that aren't loaded yet are read, the files that aren't
+ * selected anymore are unloaded. The filters that were applied to the
+ * loaded files are applied to the new files too.
  */
-void MainWindow::on_actionImport_ignore_patterns_triggered()
+void MainWindow::loadLogFiles()
 {
-    importIgnorePatterns();
-}
+    QStringList filePaths;
 
-/**
- * Reloads the current log file
+    QList<QListWidgetItem *> items = ui->fileListWidget->selectedItems();
+    Q_FOREACH(QListWidgetItem *item, items) {
+            qDebug() << __func__ << " - 'item': " << item;
+            QString path = item->text();
+
+            // families of rotated log files are loaded from the oldest to
+            // the newest file
+            if (Utils::LogRotation::isFamilyPath(path)) {
+                filePaths << Utils::LogRotation::memberPaths(path);
+            } else {
+                filePaths << path;
+            }
+        }
+
+    // the files that aren't selected anymore are unloaded, files that
+    // changed since they were loaded are loaded again
+    for (int i = _logFileSet.getFileCount() - 1; i >= 0; i--) {
+        LogFileSet::File &file = _logFileSet.file(i);
+
+        if (!filePaths.contains(file.filePath) || !file.index.isCurrent()) {
+            _logFileSet.removeAt(i);
+        }
+    }
+
+    QStringList newFilePaths;
+    Q_FOREACH(QString filePath, filePaths) {
+            if (!_logFileSet.contains(filePath) &&
+                    !newFilePaths.contains(filePath)) {
+                newFilePaths << filePath;
+            }
+        }
+
+    qDebug() << __func__ << " - 'newFilePaths': " << newFilePaths;
+
+    QList<LogFileIndex> logFileIndexes;
+    Q_FOREACH(QString filePath, newFilePaths) {
+            logFileIndexes.append(LogFileIndex::fetchByFilePath(filePath));
+        }
+
+    // the files are loaded and decompressed in parallel ahead of the file
+    // that is added
+    LogFileLoadQueue loadQueue(newFilePaths, logFileIndexes);
+
+    for (int i = 0; loadQueue.hasNext(); i++) {
+        ui->statusBar->showMessage(
+                tr("Loading log file <strong>%1</strong>")
+                        .arg(newFilePaths.at(i)));
+
+        LoadedLogFile loadedLogFile = loadQueue.next();
+
+        if (!loadedLogFile.errorMessage.isEmpty()) {
+            qWarning() << loadedLogFile.errorMessage;
+            ui->statusBar->showMessage(loadedLogFile.errorMessage);
+            continue;
+        }
+
+        if (loadedLogFile.indexChanged) {
+            loadedLogFile.index.store();
+        }
+
+        qDebug() << __func__ << " - 'index': " << loadedLogFile.index;
+
+        _logFileSet.add(newFilePaths.at(i), loadedLogFile.index,
+                        loadedLogFile.logStore);
+    }
+
+    // the content of the files is shown in the order they were selected (if
+    // they aren't merged)
+    _logFileSet.reorder(filePaths);
+    updateLogStore();
+    logStoreChanged();
+
+    ui->statusBar->showMessage(tr("Done loading log files"), 4000);
+}
+
+/**
+ * Reloads all selected log files without the filters that were applied
  */
-void MainWindow::on_action_Reload_file_triggered()
+void MainWindow::reloadLogFiles()
 {
-    // load the log files
+    _logFileSet.clear();
     loadLogFiles();
 }
 
+/**
+ * Puts the lines of the loaded log files into the log store that is shown,
+ * multiple files are merged by the timestamps of their lines if enabled
+ */
+void MainWindow::updateLogStore()
+{
+    if (_mergeByTimeAction->isChecked() && _logFileSet.getFileCount() > 1) {
+        ui->statusBar->showMessage(tr("Merging log files by time"));
+        _lineSourceRuns = _logFileSet.merge(_logStore);
+    } else {
+        _lineSourceRuns = _logFileSet.concatenate(_logStore);
+    }
+
+    _logStore.flush();
+    qDebug() << __func__ << " - 'logFileSet': " << _logFileSet;
+    qDebug() << __func__ << " - 'logStore': " << _logStore;
+}
+
+/**
+ * Removes occurrences of the ignore patterns from the text
+ */
+void MainWindow::on_removeIgnoredPatternsButton_clicked()
+{
+    ui->viewTabWidget->setCurrentIndex(ViewTabs::FileViewTab);
+
+    QList<QRegularExpression> expressions = ignorePatternExpressions();
+    QList<FieldRule> fieldRules = ignoreFieldRules();
+
+    ui->statusBar->showMessage(tr("Removing occurrences of the ignore "
+                                          "patterns in the text"));
+
+    // remove all occurrences of the ignore patterns from the blocks of the
+    // log files in parallel, the blocks end at line breaks
+    _logFileSet.applyFilter([expressions, fieldRules](LogFileSet::File &file) {
+        // only the lines the index marked as matched need to be filtered, if
+        // it still matches the lines of the file
+        QBitArray markedLines = ignorePatternLineBitmap(file, expressions);
+
+        file.logStore->replaceWithMappedBlocks(
+                [expressions, fieldRules, markedLines](
+                        const QByteArray &block, qint64 firstLine)
+                        -> QByteArray {
+                    QByteArray result = markedLines.isNull() ?
+                            LogFilterService::removeIgnorePatterns(
+                                    block, expressions) :
+                            LogFilterService::removeMarkedIgnorePatterns(
+                                    block, firstLine, expressions,
+                                    markedLines);
+
+                    return fieldRules.isEmpty() ? result :
+                           LogFilterService::removeFieldRuleLines(
+                                   result, fieldRules);
+                });
+    });
+
+    updateLogStore();
+    logStoreChanged();
+
+    ui->statusBar->showMessage(tr("Done with filtering occurrences of the "
+                                          "ignore patterns in the text"), 4000);
+}
+
+/**
+ * Returns the expressions of the checked ignore patterns, they remove the
+ * matched text including the line break
+ */
+QList<QRegularExpression> MainWindow::ignorePatternExpressions()
+{
+    QList<QRegularExpression> expressions;
+
+    Q_FOREACH(QString pattern, activeIgnorePatterns()) {
+            if (LogFilterService::isFieldRule(pattern)) {
+                continue;
+            }
+
+            qDebug() << __func__ << " - 'pattern': " << pattern;
+            expressions.append(QRegularExpression(pattern + "\n"));
+        }
+
+    return expressions;
+}
+
+/**
+ * Returns the checked ignore patterns that match fields of JSON lines, they
+ * remove the whole lines
+ */
+QList<FieldRule> MainWindow::ignoreFieldRules()
+{
+    QList<FieldRule> rules;
+
+    Q_FOREACH(QString pattern, activeIgnorePatterns()) {
+            if (LogFilterService::isFieldRule(pattern)) {
+                qDebug() << __func__ << " - 'pattern': " << pattern;
+                rules.append(LogFilterService::fieldRule(pattern));
+            }
+        }
+
+    return rules;
+}
+
+/**
+ * Returns the lines of a log file the expressions matched according to the
+ * pattern bitmaps of its index
+ *
+ * Missing bitmaps are built from the blocks of the file and stored with its
+ * index, so the file doesn't need to be scanned again the next time it is
+ * loaded. A null bitmap is returned if the file was already filtered, then
+ * all lines have to be filtered.
+ */
+QBitArray MainWindow::ignorePatternLineBitmap(
+        LogFileSet::File &file,
+        const QList<QRegularExpression> &expressions)
+{
+    qint64 lineCount = file.index.getLineCount();
+
+    if (file.filtered || lineCount != file.logStore->getLineCount() ||
+            lineCount > INT_MAX) {
+        return QBitArray();
+    }
+
+    QBitArray markedLines(static_cast<int>(lineCount));
+    bool indexChanged = false;
+
+    Q_FOREACH(QRegularExpression expression, expressions) {
+            if (!file.index.hasPatternBitmap(expression.pattern())) {
+                file.index.setPatternBitmap(
+                        expression.pattern(),
+                        buildPatternBitmap(*file.logStore, expression));
+                indexChanged = true;
+            }
+
+            QBitArray bitmap = file.index.getPatternBitmap(
+                    expression.pattern());
+
+            if (bitmap.size() == markedLines.size()) {
+                markedLines |= bitmap;
+            }
+        }
+
+    if (indexChanged && file.index.getId() > 0) {
+        file.index.store();
+    }
+
+    return markedLines;
+}
+
+/**
+ * Returns the lines of a log store that are part of a match of an
+ * expression, one bit per line
+ *
+ * The blocks are matched in parallel, the blocks end at line breaks like
+ * the ones the ignore patterns are applied to.
+ */
+QBitArray MainWindow::buildPatternBitmap(
+        LogStore &logStore, const QRegularExpression &expression)
+{
+    QList<QBitArray> blockBitmaps = logStore.mapBlocks<QBitArray>(
+            [expression](const QByteArray &block) -> QBitArray {
+                return LogFileIndex::buildPatternBitmap(
+                        QString::fromUtf8(block), expression);
+            });
+
+    QBitArray bitmap(static_cast<int>(logStore.getLineCount()));
+    int line = 0;
+
+    Q_FOREACH(QBitArray blockBitmap, blockBitmaps) {
+            for (int i = 0; i < blockBitmap.size() &&
+                    line + i < bitmap.size(); i++) {
+                if (blockBitmap.testBit(i)) {
+                    bitmap.setBit(line + i);
+                }
+            }
+
+            line += blockBitmap.size();
+        }
+
+    return bitmap;
+}
+
+/**
+ * Returns the checked ignore patterns
+ */
+QStringList MainWindow::activeIgnorePatterns()
+{
+    QStringList patterns;
+
+    for (int i = 0; i < ui->ignorePatternsListWidget->count(); i++) {
+        QListWidgetItem *item = ui->ignorePatternsListWidget->item(i);
+
+        if (item->checkState() == Qt::Checked) {
+            patterns.append(item->text());
+        }
+    }
+
+    return patterns;
+}
+
+/**
+ * Adds an ignore pattern to the list
+ */
+void MainWindow::on_actionAdd_ignore_pattern_triggered()
+{
+    ui->toolTabWidget->setCurrentIndex(ToolTabs::IgnorePatternTab);
+    QString selectedText = ui->fileTextEdit->textCursor().selectedText();
+
+    // add an ignore pattern
+    addIgnorePattern(".+" + QRegularExpression::escape(selectedText) + ".+");
+}
+
+/**
+ * Adds text as ignore pattern to the list
+ */
+void MainWindow::addIgnorePattern(QString text)
+{
+    QListWidgetItem *item = new QListWidgetItem();
+    item->setText(text);
+    item->setCheckState(Qt::Checked);
+    item->setFlags(item->flags() | Qt::ItemIsEditable);
+    ui->ignorePatternsListWidget->addItem(item);
+    ui->ignorePatternsListWidget->scrollToItem(item);
+    ui->ignorePatternsListWidget->editItem(item);
+
+    // store ignore patterns
+    storeIgnorePatterns();
+}
+
+/**
+ * Searches for the current ignore pattern if an other item was selected
+ */
+void MainWindow::on_ignorePatternsListWidget_currentItemChanged(
+        QListWidgetItem *current, QListWidgetItem *previous)
+{
+    Q_UNUSED(current);
+    Q_UNUSED(previous);
+    findCurrentIgnorePattern();
+}
+
+/**
+ * Stores the ignore patterns and searches for the current pattern if an item
+ * was changed
+ */
+void MainWindow::on_ignorePatternsListWidget_itemChanged(QListWidgetItem *item)
+{
+    Q_UNUSED(item);
+
+    // store ignore patterns
+    storeIgnorePatterns();
+
+    findCurrentIgnorePattern();
+}
+
+/**
+ * Opens the find widget
+ */
+void MainWindow::on_action_Find_in_file_triggered()
+{
+    _searchWidget->activate();
+}
+
+/**
+ * Exports ignore patterns
+ */
+void MainWindow::on_actionExport_ignore_patterns_triggered()
+{
+    exportIgnorePatterns();
+}
+
+/**
+ * Imports ignore patterns
+ */
+void MainWindow::on_actionImport_ignore_patterns_triggered()
+{
+    importIgnorePatterns();
+}
+
+/**
+ * Reloads the current log file
+ */
+void MainWindow::on_action_Reload_file_triggered()
+{
+    // load the log files again, without the filters
+    reloadLogFiles();
+}
+
 /**
  * Filters ignore patterns by a text
  */
@@ -967,116 +2038,1186 @@ void MainWindow::on_actionShow_changelog_triggered()
 }
 
 /**
- * Opens the issues page on GitHub
+ * Opens the issues page on GitHub
+ */
+void MainWindow::on_actionReport_issues_triggered()
+{
+    QDesktopServices::openUrl(
+            QUrl("https://github.com/pbek/loganalyzer/issues"));
+}
+
+/**
+ * Opens the releases page on GitHub
+ */
+void MainWindow::on_actionShow_releases_triggered()
+{
+    QDesktopServices::openUrl(
+            QUrl("https://github.com/pbek/loganalyzer/releases"));
+}
+
+/**
+ * Generates a report from the report patterns
+ */
+void MainWindow::on_reportPatternsButton_clicked()
+{
+    ui->viewTabWidget->setCurrentIndex(ViewTabs::ReportViewTab);
+
+    QList<QListWidgetItem *> items =
+            ui->reportPatternsListWidget->findItems(
+                    QString("*"), Qt::MatchWrap | Qt::MatchWildcard);
+    ReportResult reportResult;
+
+    ui->statusBar->showMessage(tr("Reporting on occurrences of the report "
+                                          "patterns in the text"));
+
+    // the matches of every pattern are also counted by the time range of
+    // the log, if it has timestamps, the histograms of the blocks are merged
+    // in their order, so matches in lines without timestamp at the start of
+    // a block get the time of the previous block
+    typedef QPair<QHash<QString, int>, TimeHistogram> BlockCounts;
+    TimeHistogram timeHistogram = TimeHistogram::forTimeRange(
+            _timeIndex.getFirstTimestamp(), _timeIndex.getLastTimestamp());
+
+    // find all occurrences of the report patterns from the text, they are
+    // matched block by block, so a match can't span the lines of two blocks
+    for (int index = 0; index < items.count(); index++) {
+        QListWidgetItem *item = items.at(index);
+
+        if ( item->checkState() != Qt::Checked ) {
+            continue;
+        }
+
+        QString pattern = item->text();
+        QRegularExpression re(pattern);
+        bool normalized = item->data(REPORT_PATTERN_NORMALIZED_ROLE).toBool();
+        std::function<BlockCounts(const QByteArray &block)> countMatches;
+
+        // the matches of a block are counted by their text and their time
+        if (LogFilterService::isFieldRule(pattern)) {
+            // only the value of the field of the JSON lines is matched
+            FieldRule rule = LogFilterService::fieldRule(pattern);
+            countMatches = [rule, timeHistogram, normalized](
+                    const QByteArray &block) -> BlockCounts {
+                BlockCounts blockCounts(QHash<QString, int>(), timeHistogram);
+                QHash<QString, int> counts =
+                        LogFilterService::countFieldRuleMatches(
+                                block, rule, &blockCounts.second);
+
+                if (!normalized) {
+                    blockCounts.first = counts;
+                    return blockCounts;
+                }
+
+                QHashIterator<QString, int> countIterator(counts);
+                while (countIterator.hasNext()) {
+                    countIterator.next();
+                    blockCounts.first[Utils::TokenNormalizer::normalize(
+                            countIterator.key())] += countIterator.value();
+                }
+
+                return blockCounts;
+            };
+        } else {
+            countMatches = [re, timeHistogram, normalized](
+                    const QByteArray &block) -> BlockCounts {
+                BlockCounts blockCounts(QHash<QString, int>(), timeHistogram);
+                QString text = QString::fromUtf8(block);
+                QRegularExpressionMatchIterator iterator =
+                        re.globalMatch(text);
+
+                while (iterator.hasNext()) {
+                    QRegularExpressionMatch match = iterator.next();
+                    QString matchText = match.captured(1);
+
+                    if (matchText.isEmpty()) {
+                        matchText = match.captured(0);
+                    }
+
+                    // volatile tokens are replaced before the text is
+                    // hashed, so the texts that only differ by them are
+                    // counted together
+                    if (normalized) {
+                        matchText = Utils::TokenNormalizer::normalize(
+                                matchText);
+                    }
+
+                    blockCounts.first[matchText]++;
+                    blockCounts.second.addMatch(text, match.capturedStart());
+                }
+
+                blockCounts.second.finishBlock(text);
+                return blockCounts;
+            };
+        }
+
+        int mode = item->data(Qt::UserRole).toInt();
+        ReportResult::Section section;
+        section.pattern = pattern;
+        QList<ReportResult::Row> rows;
+
+        if (mode == ExactReportPatternMode &&
+                !LogFilterService::isFieldRule(pattern) &&
+                !ReportCube::namedGroups(re).isEmpty()) {
+            // patterns with named groups are counted by the combinations of
+            // the texts of their groups in one pass, the cubes of the blocks
+            // are merged as they arrive
+            typedef QPair<ReportCube, TimeHistogram> CubeResult;
+            CubeResult result = _logStore.mapReduceBlocks<
+                    CubeResult, CubeResult>(
+                    [re, timeHistogram, normalized](const QByteArray &block)
+                            -> CubeResult {
+                        CubeResult blockResult(ReportCube(), timeHistogram);
+                        blockResult.first = ReportCube::countMatches(
+                                re, QString::fromUtf8(block),
+                                &blockResult.second, normalized);
+                        return blockResult;
+                    },
+                    [](CubeResult &result, const CubeResult &blockResult) {
+                        result.first.merge(blockResult.first);
+                        result.second.merge(blockResult.second);
+                    },
+                    QtConcurrent::OrderedReduce);
+
+            qDebug() << __func__ << " - 'reportCube': " << result.first;
+            section.mode = ReportResult::CubeSectionMode;
+            section.reportCube = result.first;
+            section.timeHistogram = result.second;
+
+            // every combination of the texts of the groups is a row
+            QStringList dimensions = result.first.getDimensions();
+            Q_FOREACH(ReportCube::Total total, result.first.cellTotals()) {
+                    QStringList texts = ReportCube::splitKey(total.first);
+                    QStringList parts;
+
+                    for (int i = 0; i < dimensions.count(); i++) {
+                        parts << dimensions.at(i) + "=" + texts.value(i);
+                    }
+
+                    rows << ReportResult::Row(parts.join(", "), total.second);
+                }
+        } else if (mode == NumericReportPatternMode) {
+            // every block gets its own sketch of the numbers it matched,
+            // they are merged as they arrive, the matches that aren't
+            // numbers are only counted
+            struct NumericResult {
+                QuantileSketch sketch;
+                quint64 invalidCount;
+                TimeHistogram timeHistogram;
+
+                NumericResult() : invalidCount(0) {}
+            };
+
+            NumericResult result = _logStore.mapReduceBlocks<
+                    NumericResult, NumericResult>(
+                    [countMatches](const QByteArray &block) -> NumericResult {
+                        NumericResult blockResult;
+                        BlockCounts blockCounts = countMatches(block);
+                        blockResult.timeHistogram = blockCounts.second;
+                        QHashIterator<QString, int> countIterator(
+                                blockCounts.first);
+
+                        while (countIterator.hasNext()) {
+                            countIterator.next();
+                            bool ok;
+                            double value =
+                                    countIterator.key().trimmed().toDouble(&ok);
+
+                            if (ok) {
+                                blockResult.sketch.add(value,
+                                                       countIterator.value());
+                            } else {
+                                blockResult.invalidCount +=
+                                        countIterator.value();
+                            }
+                        }
+
+                        return blockResult;
+                    },
+                    [](NumericResult &result,
+                       const NumericResult &blockResult) {
+                        result.sketch.merge(blockResult.sketch);
+                        result.invalidCount += blockResult.invalidCount;
+                        result.timeHistogram.merge(blockResult.timeHistogram);
+                    },
+                    QtConcurrent::OrderedReduce);
+
+            qDebug() << __func__ << " - 'sketch': " << result.sketch;
+            section.mode = ReportResult::NumericSectionMode;
+            section.quantileSketch = result.sketch;
+            section.invalidCount = result.invalidCount;
+            section.timeHistogram = result.timeHistogram;
+
+            // the bins of the histogram are the rows, named by their lower
+            // bound
+            if (!result.sketch.isEmpty()) {
+                Q_FOREACH(QuantileSketch::HistogramBin bin,
+                          result.sketch.histogram(
+                                  REPORT_HISTOGRAM_BIN_COUNT)) {
+                        rows << ReportResult::Row(
+                                QString::number(bin.first, 'g', 6),
+                                bin.second, tr("histogram bin"));
+                    }
+            }
+
+            if (result.invalidCount > 0) {
+                rows << ReportResult::Row(QString(), result.invalidCount,
+                                          tr("matches that weren't numbers"));
+            }
+        } else if (mode == SketchReportPatternMode) {
+            // the counts of the blocks are added to one sketch as they
+            // arrive, so the memory doesn't grow with the number of
+            // distinct matches
+            typedef QPair<FrequencySketch, TimeHistogram> SketchResult;
+            SketchResult result = _logStore.mapReduceBlocks<
+                    BlockCounts, SketchResult>(
+                    countMatches,
+                    [](SketchResult &result, const BlockCounts &blockCounts) {
+                        QHashIterator<QString, int> countIterator(
+                                blockCounts.first);
+                        while (countIterator.hasNext()) {
+                            countIterator.next();
+                            result.first.add(countIterator.key(),
+                                             countIterator.value());
+                        }
+
+                        result.second.merge(blockCounts.second);
+                    },
+                    QtConcurrent::OrderedReduce);
+
+            qDebug() << __func__ << " - 'sketch': " << result.first;
+            section.mode = ReportResult::SketchSectionMode;
+            section.frequencySketch = result.first;
+            section.timeHistogram = result.second;
+
+            Q_FOREACH(FrequencySketch::Entry entry,
+                      result.first.topEntries(REPORT_SKETCH_ENTRY_COUNT)) {
+                    rows << ReportResult::Row(
+                            entry.key, entry.count, entry.error > 0 ?
+                            tr("at least %1").arg(entry.count - entry.error) :
+                            QString());
+                }
+        } else {
+            // count the matches in the blocks of the log store in parallel
+            QHash<QString, int> matchesCounts;
+            QList<BlockCounts> blockMatchesCounts =
+                    _logStore.mapBlocks<BlockCounts>(countMatches);
+
+            Q_FOREACH(const BlockCounts &blockCounts, blockMatchesCounts) {
+                    QHashIterator<QString, int> countIterator(
+                            blockCounts.first);
+                    while (countIterator.hasNext()) {
+                        countIterator.next();
+                        matchesCounts[countIterator.key()] +=
+                                countIterator.value();
+                    }
+
+                    section.timeHistogram.merge(blockCounts.second);
+                }
+
+            QHashIterator<QString, int> i(matchesCounts);
+            while (i.hasNext()) {
+                i.next();
+                rows << ReportResult::Row(i.key(), i.value());
+            }
+
+            // the most frequent matches come first
+            std::stable_sort(rows.begin(), rows.end(),
+                             [](const ReportResult::Row &a,
+                                const ReportResult::Row &b) -> bool {
+                                 return a.count != b.count ?
+                                        a.count > b.count : a.match < b.match;
+                             });
+        }
+
+        if (!rows.isEmpty()) {
+            reportResult.addSection(section, rows);
+        }
+    }
+
+    // the document is only rendered when it's shown, the table only
+    // looks up the rows that are visible
+    _reportResult = reportResult;
+    _reportResultModel->setReportResult(&_reportResult);
+    _reportDocumentCurrent = false;
+
+    if (ui->reportDisplayComboBox->currentIndex() == ReportDocumentDisplay) {
+        updateReportDocument();
+    }
+
+    ui->statusBar->showMessage(tr("Done with reporting occurrences of the "
+                                          "report patterns in the text"), 4000);
+}
+
+/**
+ * Returns the start of the html of a report with its styles
+ */
+QString MainWindow::reportHtmlStart()
+{
+    return "<html>"
+            "<head>"
+            "<style>"
+            "* {font-family: 'Open Sans', Arial, Helvetica, sans-serif;}"
+            "pre, code, h2.code {"
+            "font-family: 'Droid Sans Mono', monospace;"
+            "}"
+            "pre, code {"
+            "white-space: pre-wrap;"
+            "background-color: #efefef;"
+            "}"
+            "h2 {margin: 30px 0 20px 0;}"
+            "</style>"
+            "</head>"
+            "<body>";
+}
+
+/**
+ * Returns the title of a report with the selected log files
+ */
+QString MainWindow::reportTitleHtml()
+{
+    QString reportHtml = tr("<h1>LogAnalyzer report</h1>");
+
+    // add log file information
+    QList<QListWidgetItem *> logFileItems = ui->fileListWidget->selectedItems();
+    if (logFileItems.count() > 0) {
+        reportHtml += tr("<h2>Log files</h2><ul>");
+
+        Q_FOREACH(QListWidgetItem *logFileItem, logFileItems) {
+                reportHtml += QString("<li>%1</li>").arg(logFileItem->text());
+            }
+
+        reportHtml += tr("</ul>");
+    }
+
+    return reportHtml;
+}
+
+/**
+ * Returns the start of the html of a report with its styles, its title and
+ * the selected log files
+ */
+QString MainWindow::reportHtmlHead()
+{
+    return reportHtmlStart() + reportTitleHtml();
+}
+
+/**
+ * Returns the parts of the document of the report result, the title and a
+ * part for every section, so it can be printed in chunks
+ *
+ * The sections of the patterns that were counted with sketches or cubes are
+ * rendered from them, the other sections only list the matches with the
+ * highest counts.
+ */
+QStringList MainWindow::reportResultHtmlParts()
+{
+    QStringList parts;
+    parts << reportTitleHtml();
+
+    for (int index = 0; index < _reportResult.getSectionCount(); index++) {
+        const ReportResult::Section &section = _reportResult.section(index);
+        QString reportHtml;
+
+        switch (section.mode) {
+            case ReportResult::SketchSectionMode:
+                reportHtml += sketchReportHtml(section.pattern,
+                                               section.frequencySketch);
+                break;
+            case ReportResult::NumericSectionMode:
+                reportHtml += quantileReportHtml(section.pattern,
+                                                 section.quantileSketch,
+                                                 section.invalidCount);
+                break;
+            case ReportResult::CubeSectionMode:
+                reportHtml += cubeReportHtml(section.pattern,
+                                             section.reportCube);
+                break;
+            default: {
+                int shownCount = qMin(section.rowCount,
+                                      REPORT_DOCUMENT_ROW_COUNT);
+                reportHtml += QString("<h2 class='code'>%1</h2><ul>")
+                        .arg(section.pattern.toHtmlEscaped());
+
+                for (int i = 0; i < shownCount; i++) {
+                    const ReportResult::Row &row =
+                            _reportResult.row(section.firstRow + i);
+
+                    reportHtml += "<li>" +
+                            tr("<pre>%1</pre> found: %n time(s)", "",
+                               static_cast<int>(row.count))
+                                    .arg(row.match.toHtmlEscaped()) + "</li>";
+                }
+
+                reportHtml += "</ul>";
+
+                if (section.rowCount > shownCount) {
+                    reportHtml += "<p>" + tr("Only the %1 texts with the "
+                                                     "highest counts of %2 "
+                                                     "are listed, the table "
+                                                     "shows all of them.")
+                            .arg(shownCount).arg(section.rowCount) + "</p>";
+                }
+            }
+        }
+
+        reportHtml += timeHistogramHtml(section.timeHistogram);
+        parts << reportHtml;
+    }
+
+    return parts;
+}
+
+/**
+ * Returns the document of the report result
+ */
+QString MainWindow::reportResultHtml()
+{
+    return reportHtmlStart() + reportResultHtmlParts().join("") +
+            "</body></html>";
+}
+
+/**
+ * Renders the document of the report result if it isn't current
+ */
+void MainWindow::updateReportDocument()
+{
+    if (_reportDocumentCurrent) {
+        return;
+    }
+
+    ui->reportTextEdit->setHtml(reportResultHtml());
+    _reportDocumentCurrent = true;
+}
+
+/**
+ * Shows a report that isn't made from the report result as document
+ */
+void MainWindow::showReportHtml(QString html)
+{
+    ui->viewTabWidget->setCurrentIndex(ViewTabs::ReportViewTab);
+
+    // the document is rendered from the report result again the next time
+    // it's shown for the report patterns
+    ui->reportDisplayComboBox->blockSignals(true);
+    ui->reportDisplayComboBox->setCurrentIndex(ReportDocumentDisplay);
+    ui->reportDisplayComboBox->blockSignals(false);
+    ui->reportStackedWidget->setCurrentIndex(ReportDocumentDisplay);
+    ui->reportTextEdit->setHtml(html);
+    _reportDocumentCurrent = false;
+}
+
+/**
+ * Switches between the table and the document of the report
+ */
+void MainWindow::on_reportDisplayComboBox_currentIndexChanged(int index)
+{
+    if (index == ReportDocumentDisplay) {
+        updateReportDocument();
+    }
+
+    ui->reportStackedWidget->setCurrentIndex(index);
+}
+
+/**
+ * Exports the rows of the report in the order of the table as CSV, JSON or
+ * Markdown
+ */
+void MainWindow::on_reportExportButton_clicked()
+{
+    if (_reportResult.isEmpty()) {
+        ui->statusBar->showMessage(tr("The report has no rows to export"),
+                                   4000);
+        return;
+    }
+
+    QStringList nameFilters;
+    nameFilters << tr("CSV files (*.csv)") << tr("JSON files (*.json)") <<
+            tr("Markdown files (*.md)");
+    QStringList suffixes;
+    suffixes << "csv" << "json" << "md";
+
+    QFileDialog dialog;
+    dialog.setFileMode(QFileDialog::AnyFile);
+    dialog.setAcceptMode(QFileDialog::AcceptSave);
+    dialog.setDirectory(QDir::homePath());
+    dialog.setNameFilters(nameFilters);
+    dialog.setWindowTitle(tr("Export report"));
+    dialog.selectFile("LogAnalyzer Report.csv");
+    int ret = dialog.exec();
+
+    if (ret != QDialog::Accepted || dialog.selectedFiles().isEmpty()) {
+        return;
+    }
+
+    QString fileName = dialog.selectedFiles().at(0);
+    int format = suffixes.indexOf(QFileInfo(fileName).suffix().toLower());
+
+    // the format of the name filter is used for unknown suffixes
+    if (format == -1) {
+        format = qMax(0, nameFilters.indexOf(dialog.selectedNameFilter()));
+        fileName.append("." + suffixes.at(format));
+    }
+
+    QFile file(fileName);
+    bool written = file.open(QIODevice::WriteOnly | QIODevice::Truncate) &&
+            _reportResult.write(
+                    &file, static_cast<ReportResult::ExportFormat>(format),
+                    _reportResultModel->getRowOrder());
+    file.close();
+
+    if (!written) {
+        QMessageBox::warning(
+                this, tr("Export report"),
+                tr("The report couldn't be written to <strong>%1</strong>.")
+                        .arg(fileName.toHtmlEscaped()));
+        return;
+    }
+
+    ui->statusBar->showMessage(tr("The report was exported to %1")
+                                       .arg(fileName), 4000);
+}
+
+/**
+ * Clusters the lines of the view into templates and reports the most
+ * frequent ones, they can be added as ignore or report patterns
+ */
+void MainWindow::on_actionMine_log_templates_triggered()
+{
+    ui->viewTabWidget->setCurrentIndex(ViewTabs::ReportViewTab);
+    ui->statusBar->showMessage(tr("Mining the templates of the log lines"));
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // the blocks are mined in parallel, their templates are merged as the
+    // blocks are done
+    std::function<TemplateMiner(const QByteArray &block)> mineBlock =
+            [](const QByteArray &block) -> TemplateMiner {
+                TemplateMiner miner;
+                miner.addLines(block);
+                return miner;
+            };
+    std::function<void(TemplateMiner &result,
+                       const TemplateMiner &blockMiner)> mergeMiners =
+            [](TemplateMiner &result, const TemplateMiner &blockMiner) {
+                result.merge(blockMiner);
+            };
+    TemplateMiner miner = _logStore.mapReduceBlocks<TemplateMiner,
+            TemplateMiner>(mineBlock, mergeMiners);
+
+    qDebug() << __func__ << " - 'miner': " << miner;
+    qDebug() << __func__ << " - 'elapsed': " << timer.elapsed();
+
+    QList<TemplateMiner::Template> templates =
+            miner.topTemplates(REPORT_TEMPLATE_COUNT);
+    QString reportHtml = reportHtmlHead();
+    reportHtml += tr("<h2>Log templates</h2>");
+    reportHtml += "<p>" + tr("%1 lines were clustered into %2 templates, "
+                                     "the %3 most frequent are listed.")
+            .arg(miner.getLineCount())
+            .arg(miner.getTemplateCount())
+            .arg(templates.count()) + "</p>";
+    reportHtml += "<table cellpadding='3'><tr><th>" + tr("Lines") +
+            "</th><th>%</th><th>" + tr("Template") + "</th><th></th></tr>";
+
+    Q_FOREACH(TemplateMiner::Template lineTemplate, templates) {
+            QString expression = QString::fromLatin1(QUrl::toPercentEncoding(
+                    TemplateMiner::templateExpression(lineTemplate)));
+
+            // all arguments are replaced at once, so markers in the
+            // template text are kept
+            reportHtml += QString("<tr><td align='right'>%1</td>"
+                                  "<td align='right'>%2</td>"
+                                  "<td><code>%3</code></td>"
+                                  "<td><a href='%4%6'>%5</a> "
+                                  "<a href='%7%6'>%8</a></td></tr>")
+                    .arg(QString::number(lineTemplate.count),
+                         QString::number(100.0 * lineTemplate.count /
+                                         miner.getLineCount(), 'f', 1),
+                         TemplateMiner::templateText(lineTemplate)
+                                 .toHtmlEscaped(),
+                         REPORT_IGNORE_PATTERN_URL_PREFIX, tr("ignore"),
+                         expression, REPORT_REPORT_PATTERN_URL_PREFIX,
+                         tr("report"));
+        }
+
+    reportHtml += "</table></body></html>";
+
+    showReportHtml(reportHtml);
+    ui->statusBar->showMessage(tr("Done with mining the templates of the "
+                                          "log lines"), 4000);
+}
+
+/**
+ * Correlates the lines of the selected log files by a key like a request id
+ * and reports the joined lines of every key as timeline
+ */
+void MainWindow::on_actionCorrelate_log_files_triggered()
+{
+    QList<QListWidgetItem *> items = ui->fileListWidget->selectedItems();
+
+    if (items.count() < 2) {
+        QMessageBox::information(
+                this, tr("Correlate log files"),
+                tr("Please select at least two log files to correlate."));
+        return;
+    }
+
+    QSettings settings;
+    bool ok;
+    QString pattern = QInputDialog::getText(
+            this, tr("Correlate log files"),
+            tr("Pattern of the key the lines are joined by, like a request "
+                       "id (the group named \"key\" or the first group is "
+                       "used):"), QLineEdit::Normal,
+            settings.value("correlationKeyPattern",
+                           "request_id=(\\S+)").toString(), &ok);
+
+    if (!ok || pattern.isEmpty()) {
+        return;
+    }
+
+    QRegularExpression keyExpression(pattern);
+
+    if (!keyExpression.isValid()) {
+        ui->statusBar->showMessage(
+                tr("Invalid key pattern: %1")
+                        .arg(keyExpression.errorString()), 8000);
+        return;
+    }
+
+    settings.setValue("correlationKeyPattern", pattern);
+
+    // every selected item is a source, families of rotated log files are
+    // read from the oldest to the newest file
+    QList<QStringList> sources;
+    QStringList sourceNames;
+
+    Q_FOREACH(QListWidgetItem *item, items) {
+            QString path = item->text();
+            sources.append(Utils::LogRotation::isFamilyPath(path) ?
+                           Utils::LogRotation::memberPaths(path) :
+                           QStringList(path));
+            sourceNames.append(QFileInfo(path).fileName());
+        }
+
+    ui->viewTabWidget->setCurrentIndex(ViewTabs::ReportViewTab);
+    ui->statusBar->showMessage(tr("Correlating the log files by the key"));
+
+    QElapsedTimer timer;
+    timer.start();
+
+    LogCorrelator correlator;
+
+    if (!correlator.correlate(sources, keyExpression)) {
+        ui->statusBar->showMessage(correlator.getErrorMessage(), 8000);
+        return;
+    }
+
+    qDebug() << __func__ << " - 'correlator': " << correlator;
+    qDebug() << __func__ << " - 'elapsed': " << timer.elapsed();
+
+    showReportHtml(correlationReportHtml(pattern, sourceNames, correlator));
+    ui->statusBar->showMessage(tr("Done with correlating the log files"),
+                               4000);
+}
+
+/**
+ * Returns the report of a correlation with the timelines of the joined keys
+ */
+QString MainWindow::correlationReportHtml(QString pattern,
+                                          QStringList sourceNames,
+                                          const LogCorrelator &correlator)
+{
+    QList<LogCorrelator::Timeline> timelines = correlator.getTimelines();
+    QString html = reportHtmlHead();
+    html += "<h2>" + tr("Correlation by <code>%1</code>")
+            .arg(pattern.toHtmlEscaped()) + "</h2>";
+    html += "<p>" + tr("%1 keys of <strong>%2</strong> were found in the "
+                               "other log files, with %3 lines in total.")
+            .arg(correlator.getJoinedKeyCount())
+            .arg(sourceNames.value(correlator.getBuildSource())
+                         .toHtmlEscaped())
+            .arg(correlator.getJoinedLineCount());
+
+    if (correlator.hasSpilled()) {
+        html += " " + tr("The keys didn't fit into memory and were joined "
+                                 "on disk.");
+    }
+
+    if (timelines.count() < correlator.getJoinedKeyCount()) {
+        html += " " + tr("The timelines of the first %1 keys are shown.")
+                .arg(timelines.count());
+    }
+
+    html += "</p>";
+
+    Q_FOREACH(LogCorrelator::Timeline timeline, timelines) {
+            html += QString("<h2 class='code'>%1</h2>")
+                    .arg(QString::fromUtf8(timeline.key).toHtmlEscaped());
+
+            if (timeline.lineCount > timeline.records.count()) {
+                html += "<p>" + tr("The first %1 of %2 lines are shown.")
+                        .arg(timeline.records.count())
+                        .arg(timeline.lineCount) + "</p>";
+            }
+
+            html += "<table cellpadding='3'>";
+
+            Q_FOREACH(JoinRecord record, timeline.records) {
+                    QString time = record.timestamp ==
+                                   Utils::Timestamp::Invalid ? QString() :
+                                   Utils::Timestamp::toDateTime(
+                                           record.timestamp).toString(
+                                           "yyyy-MM-dd HH:mm:ss.zzz");
+
+                    // all arguments are replaced at once, so markers in the
+                    // line are kept
+                    html += QString("<tr><td>%1</td><td>%2</td>"
+                                    "<td align='right'>%3</td>"
+                                    "<td><code>%4</code></td></tr>").arg(
+                            time,
+                            sourceNames.value(record.source).toHtmlEscaped(),
+                            QString::number(record.line + 1),
+                            QString::fromUtf8(record.text).toHtmlEscaped());
+                }
+
+            html += "</table>";
+        }
+
+    return html + "</body></html>";
+}
+
+/**
+ * Returns the report of a pattern that was counted with a sketch, only the
+ * most frequent matches are listed
+ */
+QString MainWindow::sketchReportHtml(QString pattern,
+                                     const FrequencySketch &sketch)
+{
+    if (sketch.getTotalCount() == 0) {
+        return QString();
+    }
+
+    QList<FrequencySketch::Entry> entries =
+            sketch.topEntries(REPORT_SKETCH_ENTRY_COUNT);
+
+    QString html = QString("<h2 class='code'>%1</h2>").arg(pattern);
+    html += "<p>" + tr("%1 matches of about %2 distinct texts, the %3 most "
+                               "frequent are listed. Counts are upper "
+                               "bounds and exceed the real count by at most "
+                               "%4 (with a probability of 98%).")
+            .arg(sketch.getTotalCount())
+            .arg(qRound64(sketch.distinctCount()))
+            .arg(entries.count())
+            .arg(sketch.getCountMinErrorBound()) + "</p><ul>";
+
+    Q_FOREACH(FrequencySketch::Entry entry, entries) {
+            html += "<li>" + tr("<pre>%1</pre> found: about %2 times")
+                    .arg(entry.key.toHtmlEscaped()).arg(entry.count);
+
+            if (entry.error > 0) {
+                html += " " + tr("(at least %1 times)")
+                        .arg(entry.count - entry.error);
+            }
+
+            html += "</li>";
+        }
+
+    return html + "</ul>";
+}
+
+/**
+ * Returns the report of a numeric pattern with the quantiles and a
+ * histogram of the matched numbers
  */
-void MainWindow::on_actionReport_issues_triggered()
+QString MainWindow::quantileReportHtml(QString pattern,
+                                       const QuantileSketch &sketch,
+                                       quint64 invalidCount)
 {
-    QDesktopServices::openUrl(
-            QUrl("https://github.com/pbek/loganalyzer/issues"));
+    if (sketch.isEmpty() && invalidCount == 0) {
+        return QString();
+    }
+
+    QString html = QString("<h2 class='code'>%1</h2>").arg(pattern);
+
+    if (invalidCount > 0) {
+        html += "<p>" + tr("%1 matches weren't numbers").arg(invalidCount) +
+                "</p>";
+    }
+
+    if (sketch.isEmpty()) {
+        return html;
+    }
+
+    html += "<table cellpadding='3'>";
+
+    html += QString("<tr><th align='left'>%1</th><td align='right'>"
+                            "<code>%2</code></td></tr>")
+            .arg(tr("count")).arg(sketch.getCount());
+
+    QList<QPair<QString, double>> rows;
+    rows << qMakePair(tr("min"), sketch.getMin())
+         << qMakePair(tr("mean"), sketch.getSum() / sketch.getCount())
+         << qMakePair(QString("p50"), sketch.quantile(0.5))
+         << qMakePair(QString("p90"), sketch.quantile(0.9))
+         << qMakePair(QString("p95"), sketch.quantile(0.95))
+         << qMakePair(QString("p99"), sketch.quantile(0.99))
+         << qMakePair(tr("max"), sketch.getMax());
+
+    for (int i = 0; i < rows.count(); i++) {
+        html += QString("<tr><th align='left'>%1</th><td align='right'>"
+                                "<code>%2</code></td></tr>")
+                .arg(rows.at(i).first)
+                .arg(rows.at(i).second, 0, 'g', 6);
+    }
+
+    html += "</table><p>" + tr("Quantiles are accurate to 1% of their "
+                                       "value.") + "</p><table>";
+
+    // the bars of the histogram are scaled to the fullest bin
+    QList<QuantileSketch::HistogramBin> bins =
+            sketch.histogram(REPORT_HISTOGRAM_BIN_COUNT);
+    quint64 highestCount = 1;
+    Q_FOREACH(QuantileSketch::HistogramBin bin, bins) {
+            highestCount = qMax(highestCount, bin.second);
+        }
+
+    Q_FOREACH(QuantileSketch::HistogramBin bin, bins) {
+            int barLength = static_cast<int>(
+                    REPORT_HISTOGRAM_BAR_LENGTH * bin.second / highestCount);
+
+            html += QString("<tr><td align='right'><code>%1</code></td>"
+                                    "<td><code>%2</code></td>"
+                                    "<td align='right'>%3</td></tr>")
+                    .arg(bin.first, 0, 'g', 6)
+                    .arg(QString(barLength, QChar(0x2588)))
+                    .arg(bin.second);
+        }
+
+    return html + "</table>";
 }
 
 /**
- * Opens the releases page on GitHub
+ * Returns a sparkline of the counts of a time histogram, every bar links to
+ * its time range
  */
-void MainWindow::on_actionShow_releases_triggered()
+QString MainWindow::timeHistogramHtml(const TimeHistogram &timeHistogram)
 {
-    QDesktopServices::openUrl(
-            QUrl("https://github.com/pbek/loganalyzer/releases"));
+    quint64 highestCount = timeHistogram.getHighestCount();
+
+    if (highestCount == 0) {
+        return QString();
+    }
+
+    QString html = "<p><code style='font-size: large'>";
+
+    for (int i = 0; i < timeHistogram.getBucketCount(); i++) {
+        quint64 count = timeHistogram.getCount(i);
+        qint64 start = timeHistogram.getBucketStart(i);
+
+        // the eight block characters from U+2581 are the heights of the bars
+        int level = count == 0 ? 0 : static_cast<int>(
+                1 + (count * 7 - 1) / highestCount);
+
+        html += QString("<a href='%1%2-%3' style='text-decoration: none; "
+                                "color: %4'>%5</a>")
+                .arg(REPORT_TIME_RANGE_URL_PREFIX)
+                .arg(start)
+                .arg(start + timeHistogram.getBucketSize() - 1)
+                .arg(count == 0 ? "#cccccc" : "#2a6fb0")
+                .arg(QChar(0x2581 + level));
+    }
+
+    QString dateFormat = "yyyy-MM-dd HH:mm:ss";
+    int last = timeHistogram.getBucketCount() - 1;
+    int seconds = static_cast<int>(timeHistogram.getBucketSize() / 1000);
+    QString bucketSizeText;
+
+    if (seconds % 86400 == 0) {
+        bucketSizeText = tr("%n day(s)", "", seconds / 86400);
+    } else if (seconds % 3600 == 0) {
+        bucketSizeText = tr("%n hour(s)", "", seconds / 3600);
+    } else if (seconds % 60 == 0) {
+        bucketSizeText = tr("%n minute(s)", "", seconds / 60);
+    } else {
+        bucketSizeText = tr("%n second(s)", "", seconds);
+    }
+
+    html += "</code><br />" + tr("%1 to %2, %3 per bar, at most %4 matches "
+                                         "per bar (click a bar to show its "
+                                         "lines)")
+            .arg(Utils::Timestamp::toDateTime(
+                    timeHistogram.getBucketStart(0)).toString(dateFormat))
+            .arg(Utils::Timestamp::toDateTime(
+                    timeHistogram.getBucketStart(last) +
+                    timeHistogram.getBucketSize() - 1).toString(dateFormat))
+            .arg(bucketSizeText)
+            .arg(highestCount) + "</p>";
+
+    return html;
 }
 
 /**
- * Generates a report from the report patterns
+ * Returns the report of a pattern with named groups as a pivot table
+ *
+ * The rows are the combinations of the texts of all groups but the last,
+ * the columns the texts of the last group. With more than two groups the
+ * rows are grouped by the text of the first group with a subtotal row.
  */
-void MainWindow::on_reportPatternsButton_clicked()
+QString MainWindow::cubeReportHtml(QString pattern,
+                                   const ReportCube &reportCube)
 {
-    ui->viewTabWidget->setCurrentIndex(ViewTabs::ReportViewTab);
+    if (reportCube.isEmpty()) {
+        return QString();
+    }
 
-    QList<QListWidgetItem *> items =
-            ui->reportPatternsListWidget->findItems(
-                    QString("*"), Qt::MatchWrap | Qt::MatchWildcard);
-    QString logText = ui->fileTextEdit->toPlainText();
-    QString reportHtml = "<html>"
-            "<head>"
-            "<style>"
-            "* {font-family: 'Open Sans', Arial, Helvetica, sans-serif;}"
-            "pre, code, h2.code {"
-            "font-family: 'Droid Sans Mono', monospace;"
-            "}"
-            "pre, code {"
-            "white-space: pre-wrap;"
-            "background-color: #efefef;"
-            "}"
-            "h2 {margin: 30px 0 20px 0;}"
-            "</style>"
-            "<head>"
-            "<body>";
-    reportHtml += tr("<h1>LogAnalyzer report</h1>");
+    QStringList dimensions = reportCube.getDimensions();
+    QString html = QString("<h2 class='code'>%1</h2>")
+            .arg(pattern.toHtmlEscaped());
+    html += "<table border='1' cellspacing='0' cellpadding='3'><tr>";
+
+    // a single group is listed with its counts
+    if (dimensions.count() == 1) {
+        html += QString("<th>%1</th><th>%2</th></tr>")
+                .arg(dimensions.first().toHtmlEscaped(), tr("count"));
+
+        QList<ReportCube::Total> totals = reportCube.dimensionTotals(0);
+        for (int i = 0; i < totals.count() && i < REPORT_PIVOT_ROW_COUNT;
+             i++) {
+            html += QString("<tr><td><code>%1</code></td>"
+                                    "<td align='right'>%2</td></tr>")
+                    .arg(totals.at(i).first.toHtmlEscaped())
+                    .arg(totals.at(i).second);
+        }
 
-    // add log file information
-    QList<QListWidgetItem *> logFileItems = ui->fileListWidget->selectedItems();
-    if (logFileItems.count() > 0) {
-        reportHtml += tr("<h2>Log files</h2><ul>");
+        html += QString("<tr><th align='left'>%1</th>"
+                                "<th align='right'>%2</th></tr></table>")
+                .arg(tr("total")).arg(reportCube.getTotalCount());
 
-        Q_FOREACH(QListWidgetItem *logFileItem, logFileItems) {
-                reportHtml += QString("<li>%1</li>").arg(logFileItem->text());
-            }
+        if (totals.count() > REPORT_PIVOT_ROW_COUNT) {
+            html += "<p>" + tr("Only the %1 texts with the highest counts of "
+                                       "%2 are listed.")
+                    .arg(REPORT_PIVOT_ROW_COUNT).arg(totals.count()) + "</p>";
+        }
 
-        reportHtml += tr("</ul>");
+        return html;
     }
 
-    ui->statusBar->showMessage(tr("Reporting on occurrences of the report "
-                                          "patterns in the text"));
+    // the columns with the highest totals are shown, the others are added up
+    QList<ReportCube::Total> columnTotals =
+            reportCube.dimensionTotals(dimensions.count() - 1);
+    bool hasOtherColumn = columnTotals.count() > REPORT_PIVOT_COLUMN_COUNT;
+    columnTotals = columnTotals.mid(0, REPORT_PIVOT_COLUMN_COUNT);
 
-    // find all occurrences of the report patterns from the text
-    for (int index = 0; index < items.count(); index++) {
-        QListWidgetItem *item = items.at(index);
+    QStringList rowDimensions = dimensions.mid(0, dimensions.count() - 1);
+    Q_FOREACH(QString dimension, rowDimensions) {
+            html += QString("<th>%1</th>").arg(dimension.toHtmlEscaped());
+        }
 
-        if ( item->checkState() != Qt::Checked ) {
-            continue;
+    Q_FOREACH(ReportCube::Total columnTotal, columnTotals) {
+            html += QString("<th><code>%1</code></th>")
+                    .arg(columnTotal.first.toHtmlEscaped());
         }
 
-        QString pattern = item->text();
-        QHash<QString, int> matchesCounts;
+    if (hasOtherColumn) {
+        html += QString("<th>%1</th>").arg(tr("other"));
+    }
 
-        QRegularExpression re(pattern);
-        QRegularExpressionMatchIterator iterator = re.globalMatch(logText);
-        while (iterator.hasNext()) {
-            QRegularExpressionMatch match = iterator.next();
-            QString text = match.captured(1);
+    html += QString("<th>%1</th></tr>").arg(tr("total"));
 
-            if (text.isEmpty()) {
-                text = match.captured(0);
-            }
+    // the rows are ordered by the total of their first text and then by their
+    // own total
+    QList<ReportCube::Total> firstTotals = reportCube.dimensionTotals(0);
+    QHash<QString, int> firstRanks;
+    for (int i = 0; i < firstTotals.count(); i++) {
+        firstRanks[firstTotals.at(i).first] = i;
+    }
 
-            matchesCounts[text]++;
+    QList<ReportCube::Total> rowTotals = reportCube.rowTotals();
+    std::stable_sort(rowTotals.begin(), rowTotals.end(),
+                     [&firstRanks](const ReportCube::Total &a,
+                                   const ReportCube::Total &b) -> bool {
+                         return firstRanks.value(
+                                 ReportCube::splitKey(a.first).first()) <
+                                 firstRanks.value(
+                                         ReportCube::splitKey(b.first)
+                                                 .first());
+                     });
+
+    // renders a row of the counts of the rows of the cube, all rows are
+    // counted if there are none
+    auto rowHtml = [&](const QStringList &labels,
+                       const QList<QStringList> &rows,
+                       quint64 rowTotal, bool isTotal) -> QString {
+        QString tag = isTotal ? "th" : "td";
+        QString text = "<tr>";
+
+        for (int i = 0; i < rowDimensions.count(); i++) {
+            text += QString("<%1 align='left'><code>%2</code></%1>")
+                    .arg(tag, labels.value(i).toHtmlEscaped());
         }
 
+        quint64 shownTotal = 0;
 
-        if (matchesCounts.count() > 0) {
-            reportHtml += QString("<h2 class='code'>%1</h2><ul>").arg(pattern);
+        Q_FOREACH(ReportCube::Total columnTotal, columnTotals) {
+                quint64 count = 0;
 
-            QHashIterator<QString, int> i(matchesCounts);
-            while (i.hasNext()) {
-                i.next();
-                QString text = i.key();
-                int count = i.value();
-
-                reportHtml +=
-                        "<li>"
-                        + tr("<pre>%1</pre> found: %n time(s)", "", count)
-                                                          .arg(text)
-                        + "</li>";
+                if (rows.isEmpty()) {
+                    count = columnTotal.second;
+                } else {
+                    Q_FOREACH(QStringList row, rows) {
+                            count += reportCube.count(
+                                    QStringList(row) << columnTotal.first);
+                        }
+                }
+
+                shownTotal += count;
+                text += QString("<%1 align='right'>%2</%1>")
+                        .arg(tag).arg(count > 0 ? QString::number(count) :
+                                      QString());
             }
 
-            reportHtml += "</ul>";
+        if (hasOtherColumn) {
+            text += QString("<%1 align='right'>%2</%1>")
+                    .arg(tag).arg(rowTotal - shownTotal);
+        }
+
+        return text + QString("<th align='right'>%1</th></tr>").arg(rowTotal);
+    };
+
+    QString group;
+    QList<QStringList> groupRows;
+    quint64 groupTotal = 0;
+
+    for (int i = 0; i < rowTotals.count(); i++) {
+        QStringList row = ReportCube::splitKey(rowTotals.at(i).first);
+        bool isNewGroup = i > 0 && row.first() != group;
+
+        if (rowDimensions.count() > 1 && isNewGroup) {
+            html += rowHtml(QStringList() << group + " " + tr("subtotal"),
+                            groupRows, groupTotal, true);
+            groupRows.clear();
+            groupTotal = 0;
+        }
+
+        // the groups after the last listed row get no subtotal, the rows of
+        // the group of the last listed row are still added up
+        if (i >= REPORT_PIVOT_ROW_COUNT &&
+                (isNewGroup || rowDimensions.count() == 1)) {
+            break;
+        }
+
+        group = row.first();
+        groupRows.append(row);
+        groupTotal += rowTotals.at(i).second;
+
+        if (i < REPORT_PIVOT_ROW_COUNT) {
+            html += rowHtml(row, QList<QStringList>() << row,
+                            rowTotals.at(i).second, false);
         }
     }
 
-    reportHtml += "</body></html>";
+    if (rowDimensions.count() > 1 && !groupRows.isEmpty()) {
+        html += rowHtml(QStringList() << group + " " + tr("subtotal"),
+                        groupRows, groupTotal, true);
+    }
 
-    ui->reportTextEdit->setHtml(reportHtml);
-    ui->statusBar->showMessage(tr("Done with reporting occurrences of the "
-                                          "report patterns in the text"), 4000);
+    html += rowHtml(QStringList() << tr("total"), QList<QStringList>(),
+                    reportCube.getTotalCount(), true) + "</table>";
+
+    if (rowTotals.count() > REPORT_PIVOT_ROW_COUNT) {
+        html += "<p>" + tr("Only %1 of %2 rows are listed, the subtotals "
+                                   "include all rows of their group and "
+                                   "the totals all rows.")
+                .arg(REPORT_PIVOT_ROW_COUNT).arg(rowTotals.count()) + "</p>";
+    }
+
+    return html;
+}
+
+/**
+ * Parses the fields of the lines of the log store into the table
+ */
+void MainWindow::on_tableParseButton_clicked()
+{
+    Utils::LogFormat::Format format = static_cast<Utils::LogFormat::Format>(
+            ui->tableFormatComboBox->currentData().toInt());
+
+    if (format == Utils::LogFormat::UnknownFormat) {
+        format = Utils::LogFormat::detect(_logStore.lines(0, 20));
+
+        if (format == Utils::LogFormat::UnknownFormat) {
+            ui->statusBar->showMessage(
+                    tr("The format of the log lines could not be detected"),
+                    4000);
+            return;
+        }
+    }
+
+    ui->statusBar->showMessage(
+            tr("Parsing the log lines as %1")
+                    .arg(Utils::LogFormat::formatName(format)));
+
+    QElapsedTimer timer;
+    timer.start();
+
+    _logTable = LogTable::build(_logStore, format);
+    qDebug() << __func__ << " - 'logTable': " << _logTable;
+
+    _logTableModel->setLogTable(_logTable);
+    ui->tableView->setModel(_logTableModel);
+    ui->tableGroupByComboBox->clear();
+    ui->tableGroupByComboBox->addItems(_logTable.getColumnNames());
+
+    ui->statusBar->showMessage(
+            tr("Parsed %L1 rows as %2 in %L3 ms")
+                    .arg(_logTable.getRowCount())
+                    .arg(Utils::LogFormat::formatName(format))
+                    .arg(timer.elapsed()), 4000);
+}
+
+/**
+ * Shows the number of rows of every value of the group by column
+ */
+void MainWindow::on_tableGroupByButton_clicked()
+{
+    int column = ui->tableGroupByComboBox->currentIndex();
+
+    if (column < 0) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    _logTableGroupModel->setGroupCounts(
+            ui->tableGroupByComboBox->currentText(),
+            _logTable.groupCount(column));
+    ui->tableView->setModel(_logTableGroupModel);
+
+    ui->statusBar->showMessage(
+            tr("Counted %L1 distinct values in %L2 ms")
+                    .arg(_logTableGroupModel->rowCount())
+                    .arg(timer.elapsed()), 4000);
+}
+
+void MainWindow::on_tableShowRowsButton_clicked()
+{
+    ui->tableView->setModel(_logTableModel);
+}
+
+/**
+ * Shows the line of a row in the file view
+ */
+void MainWindow::on_tableView_doubleClicked(const QModelIndex &index)
+{
+    if (ui->tableView->model() != _logTableModel) {
+        return;
+    }
+
+    ui->viewTabWidget->setCurrentIndex(ViewTabs::FileViewTab);
+    showFileViewLine(_logTableModel->line(index));
 }
 
 /**
@@ -1095,7 +3236,7 @@ void MainWindow::on_viewTabWidget_tabBarClicked(int index)
 void MainWindow::on_action_Export_report_as_PDF_triggered()
 {
     on_reportPatternsButton_clicked();
-    exportTextEditContentAsPDF(ui->reportTextEdit);
+    exportHtmlAsPDF(reportResultHtmlParts());
 }
 
 /**
@@ -1104,32 +3245,46 @@ void MainWindow::on_action_Export_report_as_PDF_triggered()
 void MainWindow::on_action_Print_report_triggered()
 {
     on_reportPatternsButton_clicked();
-    printTextEditContent(ui->reportTextEdit);
+    printHtml(reportResultHtmlParts());
 }
 
 
 /**
- * Prints the content of a text edit widget
- * @param textEdit
+ * Prints the parts of the html of a report in the background, a page range
+ * can be selected in the print dialog
+ *
+ * The html is rendered by the printer, so it doesn't need to be shown in
+ * the report text edit first.
  */
-void MainWindow::printTextEditContent(QTextEdit *textEdit) {
-    QPrinter printer;
+void MainWindow::printHtml(const QStringList &parts) {
+    if (_documentPrinter->isRunning()) {
+        showStatusBarMessage(tr("The report is still being printed"), 4000);
+        return;
+    }
 
-    QPrintDialog dialog(&printer, this);
+    QPrinter *printer = new QPrinter();
+
+    QPrintDialog dialog(printer, this);
     dialog.setWindowTitle(tr("Print report"));
 
     if (dialog.exec() != QDialog::Accepted) {
+        delete printer;
         return;
     }
 
-    textEdit->document()->print(&printer);
+    _documentPrinterFileName.clear();
+    _documentPrinter->start(reportHtmlStart(), parts, printer);
 }
 
 /**
- * Exports the content of a text edit widget as PDF
- * @param textEdit
+ * Exports the parts of the html of a report as PDF in the background
  */
-void MainWindow::exportTextEditContentAsPDF(QTextEdit *textEdit) {
+void MainWindow::exportHtmlAsPDF(const QStringList &parts) {
+    if (_documentPrinter->isRunning()) {
+        showStatusBarMessage(tr("The report is still being printed"), 4000);
+        return;
+    }
+
     QFileDialog dialog;
     dialog.setFileMode(QFileDialog::AnyFile);
     dialog.setAcceptMode(QFileDialog::AcceptSave);
@@ -1148,14 +3303,76 @@ void MainWindow::exportTextEditContentAsPDF(QTextEdit *textEdit) {
                 fileName.append(".pdf");
             }
 
-            QPrinter printer(QPrinter::HighResolution);
-            printer.setOutputFormat(QPrinter::PdfFormat);
-            printer.setOutputFileName(fileName);
-            textEdit->document()->print(&printer);
+            QPrinter *printer = new QPrinter(QPrinter::HighResolution);
+            printer->setOutputFormat(QPrinter::PdfFormat);
+            printer->setOutputFileName(fileName);
+
+            _documentPrinterFileName = fileName;
+            _documentPrinter->start(reportHtmlStart(), parts, printer);
         }
     }
 }
 
+/**
+ * Sets up the background printing of the report with a progress bar in the
+ * status bar
+ */
+void MainWindow::setupDocumentPrinter() {
+    _documentPrinter = new DocumentPrinter(this);
+    QObject::connect(_documentPrinter, SIGNAL(progress(int, int, int)),
+                     this, SLOT(updatePrintProgress(int, int, int)));
+    QObject::connect(_documentPrinter, SIGNAL(finished(bool, int)),
+                     this, SLOT(documentPrinterFinished(bool, int)));
+
+    _printProgressBar = new QProgressBar();
+    _printProgressBar->setMaximumWidth(200);
+    _printProgressBar->setVisible(false);
+    ui->statusBar->addPermanentWidget(_printProgressBar);
+
+    _cancelPrintButton = new QToolButton();
+    _cancelPrintButton->setIcon(QIcon::fromTheme("process-stop"));
+    _cancelPrintButton->setToolTip(tr("Cancel printing the report"));
+    _cancelPrintButton->setVisible(false);
+    QObject::connect(_cancelPrintButton, SIGNAL(clicked()),
+                     _documentPrinter, SLOT(cancel()));
+    ui->statusBar->addPermanentWidget(_cancelPrintButton);
+}
+
+/**
+ * Shows the progress of the background printing by the chunks of the report
+ * that were laid out
+ */
+void MainWindow::updatePrintProgress(int chunk, int chunkCount,
+                                     int pageCount) {
+    _printProgressBar->setMaximum(chunkCount);
+    _printProgressBar->setValue(chunk);
+    _printProgressBar->setVisible(true);
+    _cancelPrintButton->setVisible(true);
+
+    ui->statusBar->showMessage(
+            pageCount == 0 ? tr("Laying out the pages of the report") :
+            tr("%n page(s) of the report printed", "", pageCount));
+}
+
+/**
+ * Hides the progress of the background printing when it's done
+ */
+void MainWindow::documentPrinterFinished(bool completed, int pageCount) {
+    _printProgressBar->setVisible(false);
+    _cancelPrintButton->setVisible(false);
+
+    if (!completed) {
+        showStatusBarMessage(tr("Printing the report was canceled"), 4000);
+    } else if (_documentPrinterFileName.isEmpty()) {
+        showStatusBarMessage(tr("%n page(s) of the report were printed", "",
+                                pageCount), 4000);
+    } else {
+        showStatusBarMessage(tr("%n page(s) of the report were exported to "
+                                        "%1", "", pageCount)
+                                     .arg(_documentPrinterFileName), 4000);
+    }
+}
+
 /**
  * Loads the selected log files
  */
@@ -1290,14 +3507,39 @@ void MainWindow::loadLocalLogFileSourceFiles(QString localPath)
 
     QDir dir(localPath);
 
-    // only show log files
+    // only show log files, zip archives with log files and rotated files
+    // like "syslog.1"
     QStringList filters;
-    filters << "*.log*";
+    filters << "*.log*" << "*.zip";
+
+    QStringList files = dir.entryList(QDir::Files, QDir::Name);
+
+    // rotated log files are shown as one entry for their family
+    QMap<QString, QStringList> families =
+            Utils::LogRotation::families(files);
+    QStringList entries;
+
+    Q_FOREACH(QString fileName, files) {
+            QString baseName = Utils::LogRotation::baseName(fileName);
+            bool isRotated = families.value(baseName).count() > 1;
+
+            if (!isRotated && !QDir::match(filters, fileName)) {
+                continue;
+            }
 
-    QStringList files = dir.entryList(filters, QDir::Files, QDir::Name);
+            if (isRotated) {
+                QString familyName = baseName + "*";
+
+                if (!entries.contains(familyName)) {
+                    entries.append(familyName);
+                }
+            } else {
+                entries.append(fileName);
+            }
+        }
 
     ui->localFilesTableWidget->clear();
-    ui->localFilesTableWidget->setRowCount(files.count());
+    ui->localFilesTableWidget->setRowCount(entries.count());
 
     QTableWidgetItem *nameHeader = new QTableWidgetItem(tr("File name"));
     ui->localFilesTableWidget->setHorizontalHeaderItem(
@@ -1317,17 +3559,37 @@ void MainWindow::loadLocalLogFileSourceFiles(QString localPath)
             ->setSectionResizeMode(1, QHeaderView::Interactive);
 
     int i = 0;
-    Q_FOREACH(QString fileName, files) {
+    Q_FOREACH(QString fileName, entries) {
             QString filePath =
                     dir.absolutePath() + QDir::separator() + fileName;
-            QFileInfo fileInfo(filePath);
-            qint64 fileSize = fileInfo.size();
-            QDateTime mTime = fileInfo.lastModified();
+            QString toolTip = filePath;
+            qint64 fileSize = 0;
+            QDateTime mTime;
+            QStringList memberNames;
+
+            if (Utils::LogRotation::isFamilyPath(fileName)) {
+                QString baseName = fileName;
+                baseName.chop(1);
+                memberNames = families.value(baseName);
+                toolTip += "\n\n" + memberNames.join("\n");
+            } else {
+                memberNames << fileName;
+            }
+
+            Q_FOREACH(QString memberName, memberNames) {
+                    QFileInfo fileInfo(dir.absolutePath() +
+                                       QDir::separator() + memberName);
+                    fileSize += fileInfo.size();
+
+                    if (!mTime.isValid() || fileInfo.lastModified() > mTime) {
+                        mTime = fileInfo.lastModified();
+                    }
+                }
 
             // set the name item
             QTableWidgetItem *nameItem = new QTableWidgetItem(fileName);
             nameItem->setData(Qt::UserRole, filePath);
-            nameItem->setToolTip(filePath);
+            nameItem->setToolTip(toolTip);
             ui->localFilesTableWidget->setItem(
                     i, LocalFileListColumns::LFileNameColumn, nameItem);
 
@@ -1386,21 +3648,80 @@ void MainWindow::on_localFilesTableWidget_doubleClicked(
  */
 void MainWindow::addPathToFileListWidget(QString path)
 {
+    // every member of a zip archive is added as a log file of its own
+    if (Utils::Zip::isZipFile(path)) {
+        addZipArchiveToFileListWidget(path);
+        return;
+    }
+
     if (ui->fileListWidget->findItems(path, Qt::MatchExactly).count() == 0) {
-        QFileInfo fileInfo(path);
-        qint64 fileSize = fileInfo.size();
-        QDateTime mTime = fileInfo.lastModified();
+        QStringList filePaths;
+
+        if (Utils::LogRotation::isFamilyPath(path)) {
+            filePaths = Utils::LogRotation::memberPaths(path);
+        } else {
+            filePaths << Utils::Zip::archivePath(path);
+        }
+
+        qint64 fileSize = 0;
+        QDateTime mTime;
+
+        Q_FOREACH(QString filePath, filePaths) {
+                QFileInfo fileInfo(filePath);
+                fileSize += fileInfo.size();
+
+                if (!mTime.isValid() || fileInfo.lastModified() > mTime) {
+                    mTime = fileInfo.lastModified();
+                }
+            }
+
+        QString toolTip = tr("File size: %1\nModified at: %2").arg(
+                Utils::Misc::friendlyUnit(fileSize), mTime.toString());
+
+        if (Utils::LogRotation::isFamilyPath(path)) {
+            toolTip += "\n" + tr("Rotated log files: %1").arg(
+                    filePaths.count());
+        }
 
         QListWidgetItem *item = new QListWidgetItem(path);
         item->setData(Qt::UserRole, path);
-        item->setToolTip(tr("File size: %1\nModified at: %2").arg(
-                Utils::Misc::friendlyUnit(fileSize), mTime.toString()));
+        item->setToolTip(toolTip);
         ui->fileListWidget->addItem(item);
     } else {
         ui->statusBar->showMessage(tr("%1 was already in the list").arg(path));
     }
 }
 
+/**
+ * Adds the members of a zip archive to the log file list widget
+ *
+ * The members are not extracted, they are inflated in memory when they
+ * are loaded
+ */
+void MainWindow::addZipArchiveToFileListWidget(QString archivePath)
+{
+    QStringList memberNames;
+
+    try {
+        memberNames = Utils::Zip::memberNames(archivePath);
+    } catch (std::exception const &e) {
+        QString warning = tr("Zip archive '%1' could not be read: %2")
+                .arg(archivePath, e.what());
+        qWarning() << warning;
+        ui->statusBar->showMessage(warning);
+        return;
+    }
+
+    Q_FOREACH(QString memberName, memberNames) {
+            addPathToFileListWidget(
+                    Utils::Zip::memberPath(archivePath, memberName));
+        }
+
+    ui->statusBar->showMessage(
+            tr("Added %n file(s) from zip archive %1", "",
+               memberNames.count()).arg(archivePath), 4000);
+}
+
 /**
  * Loads the log file list from the server and calls
  * fillEzPublishRemoteFilesListWidget with the results
@@ -1436,11 +3757,19 @@ void MainWindow::fillEzPublishRemoteFilesListWidget(QJsonArray fileDataList)
     ui->eZPublishRemoteFilesTableWidget->setHorizontalHeaderItem(
             EzPublishRemoteFileListColumns::DownloadColumn, downloadHeader);
 
+    QTableWidgetItem *cachedHeader = new QTableWidgetItem(tr("Cached"));
+    ui->eZPublishRemoteFilesTableWidget->setHorizontalHeaderItem(
+            EzPublishRemoteFileListColumns::CachedColumn, cachedHeader);
+
     ui->eZPublishRemoteFilesTableWidget->horizontalHeader()
             ->setSectionResizeMode(
                     EzPublishRemoteFileListColumns::FileNameColumn,
                     QHeaderView::Interactive);
 
+    // the cache entries of all files are fetched at once
+    QMultiHash<QString, CachedLogFile> cachedLogFiles =
+            fetchCachedRemoteLogFiles();
+
     int i = 0;
     Q_FOREACH(QJsonValue jsonValue, fileDataList) {
             QJsonObject obj = jsonValue.toObject();
@@ -1484,6 +3813,22 @@ void MainWindow::fillEzPublishRemoteFilesListWidget(QJsonArray fileDataList)
                     i, EzPublishRemoteFileListColumns::DownloadColumn,
                     downloadItem);
 
+            // set the cached item
+            QTableWidgetItem *cachedItem = new QTableWidgetItem();
+            cachedItem->setData(Qt::UserRole, fileName);
+            cachedItem->setFlags(cachedItem->flags() & ~Qt::ItemIsSelectable);
+            CachedLogFile cachedLogFile = cachedRemoteLogFile(
+                    cachedLogFiles, fileName, fileSize, fileMTime);
+
+            if (cachedLogFile.localFileExists()) {
+                cachedItem->setText(tr("yes"));
+                cachedItem->setToolTip(cachedLogFile.getLocalPath());
+            }
+
+            ui->eZPublishRemoteFilesTableWidget->setItem(
+                    i, EzPublishRemoteFileListColumns::CachedColumn,
+                    cachedItem);
+
             i++;
         }
 
@@ -1541,6 +3886,77 @@ void MainWindow::updateEzPublishRemoteFileDownloadStatus(
     }
 }
 
+/**
+ * Updates the cache indicator of a downloaded log file
+ */
+void MainWindow::updateEzPublishRemoteFileCacheStatus(
+        QString fileName, QString localFilePath)
+{
+    for (int row = 0;
+         row < ui->eZPublishRemoteFilesTableWidget->rowCount();
+         row++) {
+        QTableWidgetItem *cachedItem =
+                ui->eZPublishRemoteFilesTableWidget->item(
+                        row, EzPublishRemoteFileListColumns::CachedColumn);
+
+        if (fileName != cachedItem->data(Qt::UserRole)) {
+            continue;
+        }
+
+        cachedItem->setText(tr("yes"));
+        cachedItem->setToolTip(localFilePath);
+        break;
+    }
+}
+
+/**
+ * Fetches the download cache entries of the remote files of the active log
+ * file source that were downloaded with the active ignore patterns, by their
+ * remote path
+ */
+QMultiHash<QString, CachedLogFile> MainWindow::fetchCachedRemoteLogFiles()
+{
+    LogFileSource logFileSource = LogFileSource::activeLogFileSource();
+    QString filterHash = EzPublishService::downloadFilterHash(
+            logFileSource, activeIgnorePatterns());
+    QMultiHash<QString, CachedLogFile> cachedLogFiles;
+
+    Q_FOREACH(CachedLogFile cachedLogFile,
+              CachedLogFile::fetchAllByLogFileSource(
+                      logFileSource.getId(), filterHash)) {
+            cachedLogFiles.insert(cachedLogFile.getRemotePath(),
+                                  cachedLogFile);
+        }
+
+    return cachedLogFiles;
+}
+
+/**
+ * Returns the download cache entry of a remote file if the file wasn't
+ * changed since it was downloaded
+ */
+CachedLogFile MainWindow::cachedRemoteLogFile(
+        const QMultiHash<QString, CachedLogFile> &cachedLogFiles,
+        QString fileName, qint64 fileSize, uint fileMTime)
+{
+    Q_FOREACH(CachedLogFile cachedLogFile, cachedLogFiles.values(fileName)) {
+            if (cachedLogFile.getRemoteSize() == fileSize &&
+                    cachedLogFile.getRemoteMTime() == fileMTime) {
+                return cachedLogFile;
+            }
+        }
+
+    return CachedLogFile();
+}
+
+/**
+ * Shows a message in the status bar
+ */
+void MainWindow::showStatusBarMessage(QString message, int timeout)
+{
+    ui->statusBar->showMessage(message, timeout);
+}
+
 /**
  * Downloads the selected log files from the eZ Publish server
  */
@@ -1555,14 +3971,41 @@ void MainWindow::on_logFileSourceRemoteDownloadButton_clicked()
         return;
     }
 
-    ui->statusBar->showMessage(
-            tr("Downloading %n log file(s) from remote server", "", listCount),
-            4000);
     EzPublishService *service = new EzPublishService(this);
+    QMultiHash<QString, CachedLogFile> cachedLogFiles =
+            fetchCachedRemoteLogFiles();
+    int downloadCount = 0;
 
     Q_FOREACH(QTableWidgetItem *item, list) {
-            service->downloadLogFile(this, item->text());
+            int row = item->row();
+            QString fileName = item->text();
+            qint64 fileSize = ui->eZPublishRemoteFilesTableWidget->item(
+                    row, EzPublishRemoteFileListColumns::SizeColumn)
+                    ->data(Qt::UserRole).toLongLong();
+            uint fileMTime = ui->eZPublishRemoteFilesTableWidget->item(
+                    row, EzPublishRemoteFileListColumns::MTimeColumn)
+                    ->data(Qt::UserRole).toUInt();
+
+            // skip files that didn't change since they were downloaded
+            if (cachedRemoteLogFile(cachedLogFiles, fileName, fileSize,
+                                    fileMTime).localFileExists()) {
+                qDebug() << __func__ << " - 'skipping cached file': "
+                         << fileName;
+                continue;
+            }
+
+            service->downloadLogFile(this, fileName, fileSize, fileMTime);
+            downloadCount++;
         }
+
+    if (downloadCount > 0) {
+        ui->statusBar->showMessage(
+                tr("Downloading %n log file(s) from remote server", "",
+                   downloadCount), 4000);
+    } else {
+        ui->statusBar->showMessage(
+                tr("The selected files are already cached locally"), 4000);
+    }
 }
 
 /**
@@ -1627,6 +4070,20 @@ void MainWindow::on_fileTextEdit_customContextMenuRequested(const QPoint &pos) {
     QAction *addIgnorePatternAction = menu->addAction(tr("Add as &ignore pattern"));
     QAction *addReportPatternAction = menu->addAction(tr("Add as &report pattern"));
 
+    // the lines of the collapsed file view can be expanded
+    QAction *toggleOccurrencesAction = NULL;
+    QAction *showInLogAction = NULL;
+    int blockNumber = ui->fileTextEdit->cursorForPosition(pos).blockNumber();
+    int entryIndex = _collapsedViewEntries.value(blockNumber, -1);
+
+    if (_collapseDuplicatesAction->isChecked() && entryIndex >= 0) {
+        menu->addSeparator();
+        toggleOccurrencesAction = menu->addAction(
+                _expandedDuplicateEntries.contains(entryIndex) ?
+                tr("&Collapse occurrences") : tr("&Expand occurrences"));
+        showInLogAction = menu->addAction(tr("&Show in the log"));
+    }
+
     QAction *selectedItem = menu->exec(globalPos);
 
     if (!selectedItem) {
@@ -1637,5 +4094,9 @@ void MainWindow::on_fileTextEdit_customContextMenuRequested(const QPoint &pos) {
         on_actionAdd_ignore_pattern_triggered();
     } else if (selectedItem == addReportPatternAction) {
         on_actionAdd_report_pattern_triggered();
+    } else if (selectedItem == toggleOccurrencesAction) {
+        toggleDuplicateOccurrences(entryIndex);
+    } else if (selectedItem == showInLogAction) {
+        showFileViewLine(_collapsedViewLines.value(blockNumber, 0));
     }
 }
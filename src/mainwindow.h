@@ -8,7 +8,33 @@
 #include <QFileSystemWatcher>
 #include <QJsonArray>
 #include <QTableWidgetItem>
+#include <QToolButton>
+#include <QLabel>
+#include <QToolBar>
+#include <QDateTimeEdit>
+#include <QLineEdit>
+#include <QSet>
+#include <QHash>
+#include <QProgressBar>
 #include <entities/logfilesource.h>
+#include <entities/cachedlogfile.h>
+#include <helpers/logstore.h>
+#include <helpers/timeindex.h>
+#include <helpers/logmerger.h>
+#include <helpers/logfileset.h>
+#include <helpers/logtable.h>
+#include <helpers/logtablemodel.h>
+#include <helpers/frequencysketch.h>
+#include <helpers/quantilesketch.h>
+#include <helpers/reportcube.h>
+#include <helpers/reportresult.h>
+#include <helpers/reportresultmodel.h>
+#include <helpers/documentprinter.h>
+#include <helpers/timehistogram.h>
+#include <helpers/duplicateindex.h>
+#include <helpers/logcorrelator.h>
+#include <entities/logfileindex.h>
+#include <services/logfilterservice.h>
 #include "qtexteditsearchwidget.h"
 
 namespace Ui {
@@ -27,14 +53,27 @@ public:
 
     enum ViewTabs {
         FileViewTab,
-        ReportViewTab
+        ReportViewTab,
+        TableViewTab
+    };
+
+    enum ReportPatternModes {
+        ExactReportPatternMode = 0,
+        SketchReportPatternMode,
+        NumericReportPatternMode
+    };
+
+    enum ReportDisplays {
+        ReportTableDisplay = 0,
+        ReportDocumentDisplay
     };
 
     enum EzPublishRemoteFileListColumns {
         FileNameColumn = 0,
         SizeColumn,
         MTimeColumn,
-        DownloadColumn
+        DownloadColumn,
+        CachedColumn
     };
 
     enum LocalFileListColumns {
@@ -54,6 +93,13 @@ public:
 
     void updateEzPublishRemoteFileDownloadStatus(QString fileName, double percent);
 
+    void updateEzPublishRemoteFileCacheStatus(QString fileName,
+                                              QString localFilePath);
+
+    QStringList activeIgnorePatterns();
+
+    void showStatusBarMessage(QString message, int timeout = 0);
+
 private slots:
     void dragEnterEvent(QDragEnterEvent *e);
     void dropEvent(QDropEvent *e);
@@ -131,6 +177,45 @@ private slots:
 
     void on_fileTextEdit_customContextMenuRequested(const QPoint &pos);
 
+    void showPreviousFileViewPage();
+
+    void showNextFileViewPage();
+
+    void filterTimeRange();
+
+    void jumpToTime();
+
+    void toggleMergeByTime(bool checked);
+
+    void filterExpression();
+
+    void toggleCollapseDuplicates(bool checked);
+
+    void updateLineSource();
+
+    void on_tableParseButton_clicked();
+
+    void on_tableGroupByButton_clicked();
+
+    void on_tableShowRowsButton_clicked();
+
+    void on_tableView_doubleClicked(const QModelIndex &index);
+
+    void on_reportPatternsListWidget_customContextMenuRequested(
+            const QPoint &pos);
+
+    void on_actionMine_log_templates_triggered();
+
+    void on_actionCorrelate_log_files_triggered();
+
+    void on_reportDisplayComboBox_currentIndexChanged(int index);
+
+    void on_reportExportButton_clicked();
+
+    void updatePrintProgress(int chunk, int chunkCount, int pageCount);
+
+    void documentPrinterFinished(bool completed, int pageCount);
+
 protected:
     void closeEvent(QCloseEvent *event);
 
@@ -142,7 +227,41 @@ private:
     QSplitter *_leftSplitter;
     QTextEditSearchWidget *_searchWidget;
     QLabel *_lineCountLabel;
+    QToolButton *_previousPageButton;
+    QToolButton *_nextPageButton;
+    QToolBar *_timeToolBar;
+    QDateTimeEdit *_timeFromDateTimeEdit;
+    QDateTimeEdit *_timeToDateTimeEdit;
+    QDateTimeEdit *_jumpToTimeDateTimeEdit;
+    QAction *_mergeByTimeAction;
+    QLineEdit *_filterExpressionLineEdit;
+    QAction *_collapseDuplicatesAction;
+    QLabel *_lineSourceLabel;
     QFileSystemWatcher *_localDirectoryWatcher;
+    LogStore _logStore;
+    LogFileSet _logFileSet;
+    TimeIndex _timeIndex;
+    QList<LineSourceRun> _lineSourceRuns;
+    LogTable _logTable;
+    LogTableModel *_logTableModel;
+    LogTableGroupModel *_logTableGroupModel;
+    qint64 _fileViewFirstLine;
+    DuplicateIndex _duplicateIndex;
+    QSet<int> _expandedDuplicateEntries;
+    int _collapsedViewFirstEntry;
+    // the line and the duplicate index entry of every line of the collapsed
+    // file view
+    QVector<qint64> _collapsedViewLines;
+    QVector<int> _collapsedViewEntries;
+    ReportResult _reportResult;
+    ReportResultModel *_reportResultModel;
+    // whether the report text edit shows the current report result
+    bool _reportDocumentCurrent;
+    DocumentPrinter *_documentPrinter;
+    // the file of the PDF export, empty when printing
+    QString _documentPrinterFileName;
+    QProgressBar *_printProgressBar;
+    QToolButton *_cancelPrintButton;
 
     void setupMainSplitter();
 
@@ -172,10 +291,77 @@ private:
 
     void loadLogFiles();
 
+    void reloadLogFiles();
+
+    void updateLogStore();
+
     void setupStatusBar();
 
+    void setupTimeToolBar();
+
+    void setupFilterToolBar();
+
+    void jumpToTimeRange(qint64 fromTimestamp, qint64 toTimestamp);
+
+    void setReportPatternMode(QListWidgetItem *item, int mode,
+                              bool normalized = false);
+
+    QString reportHtmlStart();
+
+    QString reportTitleHtml();
+
+    QString reportHtmlHead();
+
+    QStringList reportResultHtmlParts();
+
+    QString reportResultHtml();
+
+    void updateReportDocument();
+
+    void showReportHtml(QString html);
+
+    QString correlationReportHtml(QString pattern, QStringList sourceNames,
+                                  const LogCorrelator &correlator);
+
+    QString sketchReportHtml(QString pattern, const FrequencySketch &sketch);
+
+    QString timeHistogramHtml(const TimeHistogram &timeHistogram);
+
+    QString cubeReportHtml(QString pattern, const ReportCube &reportCube);
+
+    QString quantileReportHtml(QString pattern, const QuantileSketch &sketch,
+                               quint64 invalidCount);
+
+    void updateTimeIndex();
+
+    void logStoreChanged();
+
+    void setupTableView();
+
+    void setupDocumentPrinter();
+
     void updateLineCount();
 
+    void showFileViewPage(qint64 firstLine);
+
+    void showFileViewLine(qint64 line);
+
+    void updateDuplicateIndex();
+
+    void showCollapsedViewPage(int firstEntry);
+
+    void toggleDuplicateOccurrences(int entryIndex);
+
+    QList<QRegularExpression> ignorePatternExpressions();
+    QList<FieldRule> ignoreFieldRules();
+
+    static QBitArray ignorePatternLineBitmap(
+            LogFileSet::File &file,
+            const QList<QRegularExpression> &expressions);
+
+    static QBitArray buildPatternBitmap(
+            LogStore &logStore, const QRegularExpression &expression);
+
     void storeReportPatterns(QSettings *settings = 0);
 
     void loadReportPatterns(QSettings *settings = 0);
@@ -188,9 +374,9 @@ private:
 
     void findCurrentReportPattern();
 
-    void exportTextEditContentAsPDF(QTextEdit *textEdit);
+    void exportHtmlAsPDF(const QStringList &parts);
 
-    void printTextEditContent(QTextEdit *textEdit);
+    void printHtml(const QStringList &parts);
 
     void addReportPattern(QString text);
 
@@ -204,9 +390,17 @@ private:
 
     void addPathToFileListWidget(QString path);
 
+    void addZipArchiveToFileListWidget(QString archivePath);
+
     void setLocalDirectoryWatcherPath(QString path);
 
     bool removeLocalLogFiles();
+
+    QMultiHash<QString, CachedLogFile> fetchCachedRemoteLogFiles();
+
+    static CachedLogFile cachedRemoteLogFile(
+            const QMultiHash<QString, CachedLogFile> &cachedLogFiles,
+            QString fileName, qint64 fileSize, uint fileMTime);
 };
 
 
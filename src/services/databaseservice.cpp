@@ -120,6 +120,59 @@ bool DatabaseService::setupTables() {
         version = 2;
     }
 
+    if (version < 3) {
+        queryDisk.exec("ALTER TABLE logFileSource ADD "
+                               "server_side_filtering BOOLEAN;");
+        version = 3;
+    }
+
+    if (version < 4) {
+        queryDisk.exec("CREATE TABLE downloadCache ("
+                               "id INTEGER PRIMARY KEY,"
+                               "log_file_source_id INTEGER,"
+                               "remote_path VARCHAR(255),"
+                               "remote_size INTEGER,"
+                               "remote_mtime INTEGER,"
+                               "filter_hash VARCHAR(40) DEFAULT '',"
+                               "content_hash VARCHAR(40),"
+                               "local_path VARCHAR(255),"
+                               "created DATETIME DEFAULT CURRENT_TIMESTAMP)");
+        queryDisk.exec("CREATE INDEX idxDownloadCacheRemoteFile "
+                               "ON downloadCache (log_file_source_id, "
+                               "remote_path, remote_size, remote_mtime)");
+        queryDisk.exec("CREATE INDEX idxDownloadCacheContentHash "
+                               "ON downloadCache (content_hash)");
+        version = 4;
+    }
+
+    if (version < 5) {
+        queryDisk.exec("ALTER TABLE logFileSource ADD "
+                               "compress_downloads BOOLEAN;");
+        version = 5;
+    }
+
+    if (version < 6) {
+        queryDisk.exec("CREATE TABLE logFileIndex ("
+                               "id INTEGER PRIMARY KEY,"
+                               "file_path VARCHAR(255),"
+                               "file_size INTEGER,"
+                               "file_mtime INTEGER,"
+                               "content_hash VARCHAR(40),"
+                               "line_count INTEGER,"
+                               "created DATETIME DEFAULT CURRENT_TIMESTAMP)");
+        queryDisk.exec("CREATE UNIQUE INDEX idxLogFileIndexFilePath "
+                               "ON logFileIndex (file_path)");
+        queryDisk.exec("CREATE TABLE logFilePatternBitmap ("
+                               "id INTEGER PRIMARY KEY,"
+                               "log_file_index_id INTEGER,"
+                               "pattern TEXT,"
+                               "match_count INTEGER,"
+                               "bitmap BLOB)");
+        queryDisk.exec("CREATE INDEX idxLogFilePatternBitmapIndexId "
+                               "ON logFilePatternBitmap (log_file_index_id)");
+        version = 6;
+    }
+
     setAppData("database_version", QString::number(version));
 
     return true;
@@ -11,6 +11,8 @@
 #include <QDir>
 #include <utils/misc.h>
 #include <dialogs/settingsdialog.h>
+#include <entities/cachedlogfile.h>
+#include <helpers/gzipindex.h>
 #include "cryptoservice.h"
 
 const QString EzPublishService::rootPath =
@@ -101,53 +103,113 @@ void EzPublishService::slotReplyFinished(QNetworkReply *reply) {
             qDebug() << "Reply from log file download";
 //            qDebug() << data;
 
-            QString fileName = getHeaderValue(reply, "X-FILE-NAME");
+            QString remoteFileName = getHeaderValue(reply, "X-FILE-NAME");
+            QString fileName = remoteFileName;
+            QByteArray content = arr;
             mainWindow->updateEzPublishRemoteFileDownloadStatus(fileName, 100);
 
-            // decompress log file if it was compressed
+            // decompress log file if it was compressed and the server
+            // didn't already decompress it for filtering
             if (fileName.endsWith(".gz")) {
-                try {
-                    data = QString(Utils::Misc::gUncompress(arr));
-                } catch(std::exception const& e) {
-                    QMessageBox::critical(
-                            0, tr("Could not decompress file"),
-                            tr("Could not decompress file:\n%1").arg(e.what()));
-                    return;
+                if (getHeaderValue(reply, "X-FILE-DECOMPRESSED") != "1") {
+                    try {
+                        content = Utils::Misc::gUncompress(arr);
+                    } catch(std::exception const& e) {
+                        QMessageBox::critical(
+                                0, tr("Could not decompress file"),
+                                tr("Could not decompress file:\n%1")
+                                        .arg(e.what()));
+                        return;
+                    }
                 }
 
                 fileName = Utils::Misc::removeIfEndsWith(fileName, ".gz");
             }
 
-            // use a prefix if we have to
-            QString prefix = _logFileSource.getAddDownloadedFilePrefix() ?
-                             _logFileSource.getName() + " - " : "";
+            QString contentHash = CachedLogFile::hashContent(content);
 
-            // generate local log file path
-            QString localFilePath =
-                    _logFileSource.getLocalPath() + QDir::separator() +
-                            prefix + fileName;
+            // check if we already have a local file with the same content
+            CachedLogFile identicalCachedLogFile =
+                    CachedLogFile::fetchByContentHash(contentHash);
+            QString localFilePath;
 
-            // choose a proper suffix if the file already exists
-            localFilePath = chooseFileNameSuffix(localFilePath);
+            if (identicalCachedLogFile.isFetched()) {
+                localFilePath = identicalCachedLogFile.getLocalPath();
 
-            qDebug() << __func__ << " - 'localFilePath': " << localFilePath;
+                qDebug() << __func__ << " - 'identical local file': "
+                         << localFilePath;
 
-            QFile file(localFilePath);
-
-            // store local log file
-            if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-                QTextStream out(&file);
-                out << data;
-                file.flush();
-                file.close();
+                mainWindow->showStatusBarMessage(
+                        tr("The content of %1 is already stored in %2")
+                                .arg(remoteFileName, localFilePath), 4000);
             } else {
-                QMessageBox::critical(
-                        0, tr("Could not store to file"),
-                        tr("Could not store to file:\n%1\n\n%2\n\nIs your "
-                                   "local path writable?")
-                                .arg(localFilePath, file.errorString()));
+                // use a prefix if we have to
+                QString prefix = _logFileSource.getAddDownloadedFilePrefix() ?
+                                 _logFileSource.getName() + " - " : "";
+
+                // generate local log file path
+                localFilePath =
+                        _logFileSource.getLocalPath() + QDir::separator() +
+                                prefix + fileName;
+
+                // block compressed files are still valid gzip files
+                if (_logFileSource.getCompressDownloads()) {
+                    localFilePath += ".gz";
+                }
+
+                // choose a proper suffix if the file already exists
+                localFilePath = chooseFileNameSuffix(localFilePath);
+
+                qDebug() << __func__ << " - 'localFilePath': "
+                         << localFilePath;
+
+                QFile file(localFilePath);
+
+                // store local log file
+                if (_logFileSource.getCompressDownloads()) {
+                    try {
+                        GzipIndex::writeBlockCompressedFile(localFilePath,
+                                                            content);
+                    } catch (std::exception const &e) {
+                        QMessageBox::critical(
+                                0, tr("Could not store to file"),
+                                tr("Could not store to file:\n%1\n\n%2\n\n"
+                                           "Is your local path writable?")
+                                        .arg(localFilePath, e.what()));
+                        return;
+                    }
+                } else if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+                    file.write(content);
+                    file.flush();
+                    file.close();
+                } else {
+                    QMessageBox::critical(
+                            0, tr("Could not store to file"),
+                            tr("Could not store to file:\n%1\n\n%2\n\nIs "
+                                       "your local path writable?")
+                                    .arg(localFilePath, file.errorString()));
+                    return;
+                }
             }
 
+            // remember the state of the remote file, so it doesn't need to
+            // be downloaded again as long as it doesn't change
+            QPair<qint64, uint> remoteFileState =
+                    _remoteFileStates.take(remoteFileName);
+            CachedLogFile cachedLogFile;
+            cachedLogFile.setLogFileSourceId(_logFileSource.getId());
+            cachedLogFile.setRemotePath(remoteFileName);
+            cachedLogFile.setRemoteSize(remoteFileState.first);
+            cachedLogFile.setRemoteMTime(remoteFileState.second);
+            cachedLogFile.setFilterHash(
+                    _remoteFileFilterHashes.take(remoteFileName));
+            cachedLogFile.setContentHash(contentHash);
+            cachedLogFile.setLocalPath(localFilePath);
+            cachedLogFile.store();
+
+            mainWindow->updateEzPublishRemoteFileCacheStatus(
+                    remoteFileName, localFilePath);
+
             return;
         }
     } else {
@@ -206,10 +268,19 @@ void EzPublishService::loadLogFileList(MainWindow *mainWindow) {
 
 /**
  * Downloads a the log file from the active eZ Publish server
+ *
+ * The size and modification time of the remote file are used to remember
+ * the downloaded state of the file in the download cache
  */
 void EzPublishService::downloadLogFile(MainWindow *mainWindow,
-                                       QString fileName) {
+                                       QString fileName, qint64 fileSize,
+                                       uint fileMTime) {
     this->mainWindow = mainWindow;
+    _remoteFileStates.insert(fileName, qMakePair(fileSize, fileMTime));
+
+    // the ignore patterns may change until the download is finished
+    _remoteFileFilterHashes.insert(fileName, downloadFilterHash(
+            _logFileSource, mainWindow->activeIgnorePatterns()));
 
     if (!_logFileSource.isEzPublishTypeValid()) {
         showEzPublishServerErrorMessage();
@@ -221,6 +292,20 @@ void EzPublishService::downloadLogFile(MainWindow *mainWindow,
 
     QUrlQuery q;
     q.addQueryItem("file_name", fileName);
+
+    // let the server remove the lines that match the active ignore patterns
+    // (this needs a server that supports it, like the LogAnalyzer agent)
+    if (_logFileSource.getServerSideFiltering()) {
+        Q_FOREACH(QString pattern, mainWindow->activeIgnorePatterns()) {
+                // field rules are only applied locally
+                if (LogFilterService::isFieldRule(pattern)) {
+                    continue;
+                }
+
+                q.addQueryItem("ignore_pattern", pattern);
+            }
+    }
+
     url.setQuery(q);
 
     QNetworkRequest r(url);
@@ -297,6 +382,34 @@ void EzPublishService::showEzPublishServerErrorMessage(
     }
 }
 
+/**
+ * Returns a hash of the ignore patterns the server will filter a download
+ * with or an empty string if the server doesn't filter
+ *
+ * Downloads that were filtered with other patterns have a different content
+ * and can't be taken from the download cache
+ */
+QString EzPublishService::downloadFilterHash(LogFileSource logFileSource,
+                                             QStringList ignorePatterns) {
+    if (!logFileSource.getServerSideFiltering()) {
+        return "";
+    }
+
+    // field rules are only applied locally and aren't sent to the server
+    QStringList sentPatterns;
+    Q_FOREACH(QString pattern, ignorePatterns) {
+            if (!LogFilterService::isFieldRule(pattern)) {
+                sentPatterns << pattern;
+            }
+        }
+
+    if (sentPatterns.isEmpty()) {
+        return "";
+    }
+
+    return CachedLogFile::hashContent(sentPatterns.join("\n").toUtf8());
+}
+
 /**
  * Returns a filename with a proper suffix if the file already exists
  */
@@ -4,6 +4,7 @@
 #include <QAuthenticator>
 #include <QNetworkReply>
 #include <QObject>
+#include <QHash>
 #include <dialogs/settingsdialog.h>
 #include "mainwindow.h"
 
@@ -17,7 +18,11 @@ public:
 
     void loadLogFileList(MainWindow *mainWindow);
 
-    void downloadLogFile(MainWindow *mainWindow, QString fileName);
+    void downloadLogFile(MainWindow *mainWindow, QString fileName,
+                         qint64 fileSize = 0, uint fileMTime = 0);
+
+    static QString downloadFilterHash(LogFileSource logFileSource,
+                                      QStringList ignorePatterns);
 
     void settingsConnectionTest(SettingsDialog *dialog,
                                 LogFileSource logFileSource);
@@ -33,6 +38,8 @@ private:
     QString connectionTestPath;
     LogFileSource _logFileSource;
     SettingsDialog *_settingsDialog;
+    QHash<QString, QPair<qint64, uint> > _remoteFileStates;
+    QHash<QString, QString> _remoteFileFilterHashes;
 
     void addAuthHeader(QNetworkRequest *r);
 
@@ -0,0 +1,220 @@
+#include "services/logfilterservice.h"
+#include <QString>
+#include <QStringList>
+#include "utils/jsonlines.h"
+
+LogFilterService::LogFilterService() {
+}
+
+/**
+ * Removes all occurrences of the ignore pattern expressions and the empty
+ * lines from a block of lines
+ */
+QByteArray LogFilterService::removeIgnorePatterns(
+        const QByteArray &block,
+        const QList<QRegularExpression> &expressions) {
+    QString logText = QString::fromUtf8(block);
+
+    Q_FOREACH(QRegularExpression expression, expressions) {
+            logText.remove(expression);
+        }
+
+    // remove empty lines
+    logText = logText.split(QRegularExpression("\n|\r\n"),
+                            QString::SkipEmptyParts).join("\n");
+
+    QByteArray data = logText.toUtf8();
+    if (!data.isEmpty()) {
+        data.append('\n');
+    }
+
+    return data;
+}
+
+/**
+ * Removes the ignore pattern expressions like removeIgnorePatterns(), but
+ * only runs them on the lines that are marked as matched
+ *
+ * firstLine is the number of the first line of the block in markedLines, the
+ * other lines are only checked for being empty.
+ */
+QByteArray LogFilterService::removeMarkedIgnorePatterns(
+        const QByteArray &block, qint64 firstLine,
+        const QList<QRegularExpression> &expressions,
+        const QBitArray &markedLines) {
+    QByteArray result;
+    QByteArray markedData;
+    qint64 line = firstLine;
+    int pos = 0;
+
+    while (pos < block.size()) {
+        int end = block.indexOf('\n', pos);
+        end = end == -1 ? block.size() : end + 1;
+
+        bool isMarked = line < markedLines.size() &&
+                markedLines.testBit(static_cast<int>(line));
+
+        if (isMarked) {
+            // consecutive matched lines are filtered together, so matches
+            // over multiple lines are removed too
+            markedData.append(block.constData() + pos, end - pos);
+        } else {
+            if (!markedData.isEmpty()) {
+                result += removeIgnorePatterns(markedData, expressions);
+                markedData.clear();
+            }
+
+            int length = end - pos;
+
+            if (length > 0 && block.at(end - 1) == '\n') {
+                length--;
+
+                if (length > 0 && block.at(pos + length - 1) == '\r') {
+                    length--;
+                }
+            }
+
+            // skip empty lines
+            if (length > 0) {
+                result.append(block.constData() + pos, length);
+                result.append('\n');
+            }
+        }
+
+        pos = end;
+        line++;
+    }
+
+    if (!markedData.isEmpty()) {
+        result += removeIgnorePatterns(markedData, expressions);
+    }
+
+    return result;
+}
+
+/**
+ * Returns if a pattern is a field rule like "(?field:status)^5\d\d$"
+ */
+bool LogFilterService::isFieldRule(const QString &pattern) {
+    static const QRegularExpression re(
+            "^" + QRegularExpression::escape(LOG_FILTER_FIELD_RULE_PREFIX) +
+            "[\\w.-]+\\)");
+    return re.match(pattern).hasMatch();
+}
+
+/**
+ * Returns the field and the expression of a field rule
+ */
+FieldRule LogFilterService::fieldRule(const QString &pattern) {
+    FieldRule rule;
+    int prefixLength = QString(LOG_FILTER_FIELD_RULE_PREFIX).length();
+    int fieldEnd = pattern.indexOf(')', prefixLength);
+
+    rule.field = pattern.mid(prefixLength, fieldEnd - prefixLength).toUtf8();
+    rule.expression = QRegularExpression(pattern.mid(fieldEnd + 1));
+
+    return rule;
+}
+
+/**
+ * Removes the lines of a block that have a field that matches one of the
+ * rules
+ *
+ * The structure of a line is only scanned once for all rules and only the
+ * values of the fields of the rules are extracted, lines that aren't JSON
+ * are kept. The kept lines are copied unchanged with their line breaks.
+ */
+QByteArray LogFilterService::removeFieldRuleLines(
+        const QByteArray &block, const QList<FieldRule> &rules) {
+    QByteArray result;
+    QVector<int> structurals;
+    QByteArray value;
+    int pos = 0;
+
+    while (pos < block.size()) {
+        int end = block.indexOf('\n', pos);
+        end = end == -1 ? block.size() : end + 1;
+
+        const char *line = block.constData() + pos;
+        int length = end - pos;
+
+        if (length > 0 && line[length - 1] == '\n') {
+            length--;
+
+            if (length > 0 && line[length - 1] == '\r') {
+                length--;
+            }
+        }
+
+        bool isMatched = false;
+
+        if (length > 0 && Utils::JsonLines::buildStructuralIndex(
+                line, length, structurals)) {
+            Q_FOREACH(const FieldRule &rule, rules) {
+                    if (Utils::JsonLines::findField(
+                            line, structurals, rule.field, value) &&
+                            rule.expression.match(
+                                    QString::fromUtf8(value)).hasMatch()) {
+                        isMatched = true;
+                        break;
+                    }
+                }
+        }
+
+        if (!isMatched) {
+            result.append(line, end - pos);
+        }
+
+        pos = end;
+    }
+
+    return result;
+}
+
+/**
+ * Counts the matches of a field rule in the lines of a block by the first
+ * captured group of its expression or the whole value
+ *
+ * The matches are also counted at the time of their lines if a time
+ * histogram is passed.
+ */
+QHash<QString, int> LogFilterService::countFieldRuleMatches(
+        const QByteArray &block, const FieldRule &rule,
+        TimeHistogram *timeHistogram) {
+    QHash<QString, int> counts;
+    QVector<int> structurals;
+    QByteArray value;
+    int pos = 0;
+
+    while (pos < block.size()) {
+        int end = block.indexOf('\n', pos);
+        end = end == -1 ? block.size() : end + 1;
+
+        if (Utils::JsonLines::buildStructuralIndex(
+                block.constData() + pos, end - pos, structurals) &&
+                Utils::JsonLines::findField(block.constData() + pos,
+                                            structurals, rule.field, value)) {
+            QRegularExpressionMatch match =
+                    rule.expression.match(QString::fromUtf8(value));
+
+            if (match.hasMatch()) {
+                QString text = match.captured(1);
+
+                if (text.isEmpty()) {
+                    text = match.captured(0);
+                }
+
+                counts[text]++;
+
+                if (timeHistogram != NULL) {
+                    timeHistogram->addLine(block.constData() + pos,
+                                           end - pos);
+                }
+            }
+        }
+
+        pos = end;
+    }
+
+    return counts;
+}
@@ -0,0 +1,46 @@
+#ifndef LOGFILTERSERVICE_H
+#define LOGFILTERSERVICE_H
+
+#include <QByteArray>
+#include <QBitArray>
+#include <QList>
+#include <QRegularExpression>
+#include <QHash>
+#include <helpers/timehistogram.h>
+
+// prefix of the patterns that match the value of a field of JSON lines,
+// like "(?field:level)^error$", "(?f" isn't valid in a regular expression,
+// so no regular expression is taken for a field rule
+#define LOG_FILTER_FIELD_RULE_PREFIX "(?field:"
+
+/**
+ * A pattern that is matched against the value of a field of JSON lines
+ * instead of the text of the lines
+ */
+struct FieldRule {
+    QByteArray field;
+    QRegularExpression expression;
+};
+
+class LogFilterService
+{
+
+public:
+    LogFilterService();
+    static bool isFieldRule(const QString &pattern);
+    static FieldRule fieldRule(const QString &pattern);
+    static QByteArray removeFieldRuleLines(const QByteArray &block,
+                                           const QList<FieldRule> &rules);
+    static QHash<QString, int> countFieldRuleMatches(
+            const QByteArray &block, const FieldRule &rule,
+            TimeHistogram *timeHistogram = NULL);
+    static QByteArray removeIgnorePatterns(
+            const QByteArray &block,
+            const QList<QRegularExpression> &expressions);
+    static QByteArray removeMarkedIgnorePatterns(
+            const QByteArray &block, qint64 firstLine,
+            const QList<QRegularExpression> &expressions,
+            const QBitArray &markedLines);
+};
+
+#endif // LOGFILTERSERVICE_H
@@ -0,0 +1,292 @@
+#include "services/logloaderservice.h"
+#include <QFile>
+#include <QDebug>
+#include <QObject>
+#include <QtConcurrent>
+#include <stdexcept>
+#include <utils/gzip.h>
+#include <utils/zip.h>
+#include <helpers/gzipindex.h>
+
+LogLoaderService::LogLoaderService() {
+}
+
+/**
+ * Loads the log files on the global thread pool, one task per file
+ *
+ * The results of the future can be fetched in file order with resultAt()
+ * while the later files are still being loaded.
+ */
+QFuture<LoadedLogFile> LogLoaderService::loadLogFiles(QStringList filePaths) {
+    return QtConcurrent::mapped(filePaths, &LogLoaderService::loadLogFile);
+}
+
+/**
+ * Loads a log file and makes sure its index is current
+ *
+ * The index is rebuilt if the file changed, the bitmaps of the patterns are
+ * built when the file is filtered for the first time.
+ */
+LoadedLogFile LogLoaderService::loadIndexedLogFile(
+        QString filePath, LogFileIndex logFileIndex) {
+    LoadedLogFile loadedLogFile = loadLogFile(filePath);
+
+    if (!loadedLogFile.errorMessage.isEmpty()) {
+        return loadedLogFile;
+    }
+
+    if (!logFileIndex.isCurrent()) {
+        logFileIndex = LogFileIndex::build(
+                filePath, loadedLogFile.logStore->getLineCount());
+        loadedLogFile.indexChanged = true;
+    }
+
+    loadedLogFile.index = logFileIndex;
+
+    return loadedLogFile;
+}
+
+/**
+ * Reads a log file into a log store, gzipped log files are decompressed
+ *
+ * The file is compressed into the store chunk by chunk, so it is never held
+ * in memory uncompressed at once and can be larger than a QByteArray. The
+ * last line of the store always ends with a line break, so the lines of
+ * the next file start on their own line.
+ */
+LoadedLogFile LogLoaderService::loadLogFile(QString filePath) {
+    LoadedLogFile loadedLogFile;
+    loadedLogFile.filePath = filePath;
+
+    if (!Utils::Zip::isMemberPath(filePath) && !QFile::exists(filePath)) {
+        loadedLogFile.errorMessage =
+                QObject::tr("File '%1' does not exist!").arg(filePath);
+        return loadedLogFile;
+    }
+
+    qDebug() << __func__ << " - 'filePath': " << filePath;
+
+    LogStore *logStore = new LogStore();
+    bool lastLineTerminated = true;
+
+    bool success = readLogFileChunks(
+            filePath,
+            [&](const QByteArray &chunk) {
+                logStore->append(chunk);
+                lastLineTerminated = chunk.endsWith('\n');
+            },
+            &loadedLogFile.errorMessage);
+
+    if (!success) {
+        delete logStore;
+        return loadedLogFile;
+    }
+
+    if (!lastLineTerminated) {
+        logStore->append("\n");
+    }
+
+    logStore->flush();
+    loadedLogFile.logStore = logStore;
+
+    return loadedLogFile;
+}
+
+/**
+ * Reads a log file in chunks of about LOG_LOADER_CHUNK_SIZE that end at line
+ * breaks and calls a function with every chunk, so the file doesn't need to
+ * be held in memory at once
+ *
+ * The regions between the checkpoints of the index of gzipped log files are
+ * decompressed in parallel, gzipped files without index are decompressed
+ * once as stream while their index is built. Members of zip archives are read as one chunk.
+ * Lines that are longer than a chunk are split. Returns false and sets
+ * errorMessage if the file can't be read.
+ */
+bool LogLoaderService::readLogFileChunks(
+        QString filePath,
+        std::function<void(const QByteArray &chunk)> function,
+        QString *errorMessage) {
+    QString error;
+    QByteArray remainder;
+
+    // calls the function with the complete lines of data and keeps the
+    // incomplete last line for the next data, unless it gets longer than a
+    // chunk
+    auto addData = [&](const QByteArray &data) {
+        remainder += data;
+        int end = remainder.lastIndexOf('\n') + 1;
+
+        if (end == 0 && remainder.size() >= LOG_LOADER_CHUNK_SIZE) {
+            end = remainder.size();
+        }
+
+        if (end > 0) {
+            function(remainder.left(end));
+            remainder.remove(0, end);
+        }
+    };
+
+    if (Utils::Zip::isMemberPath(filePath)) {
+        LoadedLogFile loadedLogFile = loadZipArchiveMember(filePath);
+        error = loadedLogFile.errorMessage;
+
+        if (error.isEmpty()) {
+            addData(loadedLogFile.data);
+        }
+    } else {
+        QFile file(filePath);
+
+        if (!file.open(QIODevice::ReadOnly)) {
+            error = QObject::tr("File '%1' could not be read: %2")
+                    .arg(filePath, file.errorString());
+        } else if (Utils::Gzip::hasGzipHeader(file.peek(10))) {
+            file.close();
+
+            try {
+                // a checkpoint index is built on the first read, so later
+                // reads can decompress in parallel
+                QByteArray data;
+                GzipIndex::uncompressFile(
+                        filePath,
+                        [&](const char *buffer, int size) {
+                            data.append(buffer, size);
+
+                            if (data.size() >= LOG_LOADER_CHUNK_SIZE) {
+                                addData(data);
+                                data.clear();
+                            }
+                        });
+                addData(data);
+            } catch (std::exception const &e) {
+                error = QObject::tr("File '%1' could not be decompressed: %2")
+                        .arg(filePath, e.what());
+            }
+        } else {
+            while (!file.atEnd()) {
+                QByteArray data = file.read(LOG_LOADER_CHUNK_SIZE);
+
+                if (file.error() != QFileDevice::NoError) {
+                    error = QObject::tr("File '%1' could not be read: %2")
+                            .arg(filePath, file.errorString());
+                    break;
+                }
+
+                addData(data);
+            }
+
+            file.close();
+        }
+    }
+
+    if (!error.isEmpty()) {
+        if (errorMessage != NULL) {
+            *errorMessage = error;
+        }
+
+        return false;
+    }
+
+    // the last line doesn't need to end with a line break
+    if (!remainder.isEmpty()) {
+        function(remainder);
+    }
+
+    return true;
+}
+
+/**
+ * Inflates a member of a zip archive in memory, gzipped members are
+ * decompressed too
+ */
+LoadedLogFile LogLoaderService::loadZipArchiveMember(QString memberPath) {
+    LoadedLogFile loadedLogFile;
+    loadedLogFile.filePath = memberPath;
+
+    QString archivePath = Utils::Zip::archivePath(memberPath);
+
+    if (!QFile::exists(archivePath)) {
+        loadedLogFile.errorMessage =
+                QObject::tr("File '%1' does not exist!").arg(archivePath);
+        return loadedLogFile;
+    }
+
+    qDebug() << __func__ << " - 'memberPath': " << memberPath;
+
+    try {
+        loadedLogFile.data = Utils::Zip::readMember(
+                archivePath, Utils::Zip::memberName(memberPath));
+
+        if (Utils::Gzip::hasGzipHeader(loadedLogFile.data)) {
+            loadedLogFile.data = Utils::Gzip::uncompress(loadedLogFile.data);
+        }
+    } catch (std::exception const &e) {
+        loadedLogFile.data.clear();
+        loadedLogFile.errorMessage =
+                QObject::tr("File '%1' could not be read: %2")
+                        .arg(memberPath, e.what());
+    }
+
+    return loadedLogFile;
+}
+
+/**
+ * Starts loading the first files, at most prefetchCount files are loaded
+ * ahead of the file that is read with next()
+ *
+ * The indexes have to be fetched from the database before, because the
+ * database connection can't be used by the worker threads.
+ */
+LogFileLoadQueue::LogFileLoadQueue(QStringList filePaths,
+                                   QList<LogFileIndex> logFileIndexes,
+                                   int prefetchCount) {
+    this->filePaths = filePaths;
+    this->prefetchCount = qMax(1, prefetchCount);
+    nextIndex = 0;
+
+    Q_FOREACH(LogFileIndex logFileIndex, logFileIndexes) {
+            this->logFileIndexes[logFileIndex.getFilePath()] = logFileIndex;
+        }
+
+    while (futures.count() < this->prefetchCount &&
+            futures.count() < filePaths.count()) {
+        startNext();
+    }
+}
+
+/**
+ * Waits for all files that are still loading, so no worker thread uses the
+ * queue after it was destroyed, the files that weren't read are unloaded
+ */
+LogFileLoadQueue::~LogFileLoadQueue() {
+    Q_FOREACH(QFuture<LoadedLogFile> future, futures) {
+            delete future.result().logStore;
+        }
+}
+
+bool LogFileLoadQueue::hasNext() {
+    return nextIndex < filePaths.count();
+}
+
+/**
+ * Returns the next file in the order of the file paths, waits until it is
+ * loaded
+ */
+LoadedLogFile LogFileLoadQueue::next() {
+    QFuture<LoadedLogFile> future = futures.takeFirst();
+    nextIndex++;
+
+    if (nextIndex + futures.count() < filePaths.count()) {
+        startNext();
+    }
+
+    return future.result();
+}
+
+void LogFileLoadQueue::startNext() {
+    QString filePath = filePaths.at(nextIndex + futures.count());
+
+    futures.append(QtConcurrent::run(
+            &LogLoaderService::loadIndexedLogFile, filePath,
+            logFileIndexes.value(filePath)));
+}
@@ -0,0 +1,80 @@
+#ifndef LOGLOADERSERVICE_H
+#define LOGLOADERSERVICE_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QFuture>
+#include <QHash>
+#include <QThread>
+#include <functional>
+#include <entities/logfileindex.h>
+#include <helpers/logstore.h>
+
+// amount of data that is read at once if log files are read in chunks
+#define LOG_LOADER_CHUNK_SIZE (16 * 1024 * 1024)
+
+/**
+ * The lines of a loaded log file or the reason why it couldn't be loaded
+ *
+ * The reader takes the ownership of the log store. indexChanged is set if
+ * the index was built and needs to be stored.
+ */
+struct LoadedLogFile
+{
+    QString filePath;
+    LogStore *logStore = NULL;
+    QString errorMessage;
+    LogFileIndex index;
+    bool indexChanged = false;
+};
+
+class LogLoaderService
+{
+
+public:
+    LogLoaderService();
+    static QFuture<LoadedLogFile> loadLogFiles(QStringList filePaths);
+    static LoadedLogFile loadLogFile(QString filePath);
+    static LoadedLogFile loadIndexedLogFile(
+            QString filePath, LogFileIndex logFileIndex);
+    static bool readLogFileChunks(
+            QString filePath,
+            std::function<void(const QByteArray &chunk)> function,
+            QString *errorMessage = NULL);
+
+private:
+    static LoadedLogFile loadZipArchiveMember(QString memberPath);
+};
+
+/**
+ * Loads log files in the background in their order
+ *
+ * Only a few files are loaded ahead of the reader, so a long list of log
+ * files, like a family of rotated log files, doesn't need to be held in
+ * memory uncompressed at once.
+ */
+class LogFileLoadQueue
+{
+
+public:
+    LogFileLoadQueue(QStringList filePaths,
+                     QList<LogFileIndex> logFileIndexes,
+                     int prefetchCount = QThread::idealThreadCount());
+    ~LogFileLoadQueue();
+    bool hasNext();
+    LoadedLogFile next();
+
+private:
+    Q_DISABLE_COPY(LogFileLoadQueue)
+
+    QStringList filePaths;
+    QHash<QString, LogFileIndex> logFileIndexes;
+    int prefetchCount;
+    int nextIndex;
+    QList<QFuture<LoadedLogFile>> futures;
+
+    void startNext();
+};
+
+#endif // LOGLOADERSERVICE_H
@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+#include <stdexcept>
+#include <stdlib.h>
+#include "gzip.h"
+#include "libraries/miniz/miniz.h"
+
+// gzip header flags (see RFC 1952)
+#define GZIP_FLAG_HCRC 0x02
+#define GZIP_FLAG_EXTRA 0x04
+#define GZIP_FLAG_NAME 0x08
+#define GZIP_FLAG_COMMENT 0x10
+
+// size of the crc32 and isize trailer of every gzip member
+#define GZIP_TRAILER_SIZE 8
+
+/**
+ * Checks if the data starts with the gzip magic bytes
+ */
+bool Utils::Gzip::hasGzipHeader(const QByteArray &data) {
+    return data.size() >= 10 &&
+           static_cast<uchar>(data.at(0)) == 0x1f &&
+           static_cast<uchar>(data.at(1)) == 0x8b;
+}
+
+/**
+ * Returns the size of the header of the gzip member at offset or -1 if there
+ * is no valid gzip member header
+ *
+ * The optional extra field, file name, comment and header crc are skipped,
+ * the file name is for example set by logrotate
+ */
+int Utils::Gzip::memberHeaderSize(const QByteArray &data, int offset) {
+    const int size = data.size();
+
+    // the fixed part of the header is 10 bytes long and we only support the
+    // deflate compression method
+    if (size - offset < 10 ||
+            static_cast<uchar>(data.at(offset)) != 0x1f ||
+            static_cast<uchar>(data.at(offset + 1)) != 0x8b ||
+            data.at(offset + 2) != 8) {
+        return -1;
+    }
+
+    const uchar flags = static_cast<uchar>(data.at(offset + 3));
+    int pos = offset + 10;
+
+    if (flags & GZIP_FLAG_EXTRA) {
+        if (pos + 2 > size) {
+            return -1;
+        }
+
+        pos += 2 + (static_cast<uchar>(data.at(pos)) |
+                    (static_cast<uchar>(data.at(pos + 1)) << 8));
+    }
+
+    if (flags & GZIP_FLAG_NAME) {
+        pos = data.indexOf('\0', pos);
+
+        if (pos == -1) {
+            return -1;
+        }
+
+        pos++;
+    }
+
+    if (flags & GZIP_FLAG_COMMENT) {
+        pos = data.indexOf('\0', pos);
+
+        if (pos == -1) {
+            return -1;
+        }
+
+        pos++;
+    }
+
+    if (flags & GZIP_FLAG_HCRC) {
+        pos += 2;
+    }
+
+    return pos > size ? -1 : pos - offset;
+}
+
+/**
+ * Decompresses gzipped data with the help of miniz
+ *
+ * Concatenated gzip members (like produced by `cat a.gz b.gz`) are
+ * decompressed one after another. The function is reentrant, so it can be
+ * used from multiple threads at the same time.
+ */
+QByteArray Utils::Gzip::uncompress(const QByteArray &data) {
+    QByteArray result;
+    result.resize(qMax(data.size() * 4, TINFL_LZ_DICT_SIZE));
+
+    tinfl_decompressor inflator;
+    size_t outTotal = 0;
+    int offset = 0;
+
+    while (offset < data.size()) {
+        int headerSize = memberHeaderSize(data, offset);
+
+        if (headerSize < 0) {
+            // trailing garbage (like zero padding) after the first member
+            // is ignored, like gzip does
+            if (offset == 0) {
+                throw std::runtime_error("no valid gzip header found");
+            }
+
+            break;
+        }
+
+        const mz_uint8 *inPtr =
+                reinterpret_cast<const mz_uint8 *>(data.constData()) +
+                offset + headerSize;
+        size_t inAvail =
+                static_cast<size_t>(data.size() - offset - headerSize);
+        const size_t memberStart = outTotal;
+        tinfl_status status;
+
+        tinfl_init(&inflator);
+
+        do {
+            size_t inSize = inAvail;
+            size_t outSize = result.size() - outTotal;
+            mz_uint8 *outPtr = reinterpret_cast<mz_uint8 *>(result.data());
+
+            status = tinfl_decompress(
+                    &inflator,
+                    inPtr,
+                    &inSize,
+                    outPtr + memberStart,
+                    outPtr + outTotal,
+                    &outSize,
+                    TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF);
+
+            inPtr += inSize;
+            inAvail -= inSize;
+            outTotal += outSize;
+
+            if (status == TINFL_STATUS_HAS_MORE_OUTPUT) {
+                result.resize(2 * result.size());
+            } else if (status != TINFL_STATUS_DONE) {
+                throw std::runtime_error(
+                        "error decompressing gzipped content");
+            }
+        } while (status != TINFL_STATUS_DONE);
+
+        // tinfl reads ahead into its bit buffer, the whole bytes that are
+        // left there already belong to the trailer
+        inAvail += inflator.m_num_bits >> 3;
+
+        offset = data.size() - static_cast<int>(inAvail) + GZIP_TRAILER_SIZE;
+    }
+
+    result.resize(static_cast<int>(outTotal));
+    return result;
+}
+
+/**
+ * Compresses data to a single gzip member with the help of miniz
+ *
+ * Members can be concatenated to a valid gzip file, that way every member
+ * can be decompressed independently. Throws a std::runtime_error if the
+ * data can't be compressed.
+ */
+QByteArray Utils::Gzip::compress(const QByteArray &data, int level) {
+    // raw deflate data, the gzip header and trailer are added by us
+    int flags = static_cast<int>(tdefl_create_comp_flags_from_zip_params(
+            level, -MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY));
+
+    size_t deflatedSize = 0;
+    void *deflated = tdefl_compress_mem_to_heap(
+            data.constData(), static_cast<size_t>(data.size()),
+            &deflatedSize, flags);
+
+    if (deflated == NULL) {
+        throw std::runtime_error("error compressing content");
+    }
+
+    // header without file name and modification time, the operating system
+    // is set to "unknown"
+    static const char header[10] =
+            {'\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, '\xff'};
+
+    QByteArray result;
+    result.reserve(10 + static_cast<int>(deflatedSize) + GZIP_TRAILER_SIZE);
+    result.append(header, 10);
+    result.append(static_cast<const char *>(deflated),
+                  static_cast<int>(deflatedSize));
+    free(deflated);
+
+    // the trailer consists of the crc32 and the size of the data in
+    // little endian byte order
+    quint32 crc = static_cast<quint32>(mz_crc32(
+            MZ_CRC32_INIT,
+            reinterpret_cast<const unsigned char *>(data.constData()),
+            static_cast<size_t>(data.size())));
+    quint32 size = static_cast<quint32>(data.size());
+
+    for (int i = 0; i < 4; i++) {
+        result.append(static_cast<char>((crc >> (8 * i)) & 0xff));
+    }
+
+    for (int i = 0; i < 4; i++) {
+        result.append(static_cast<char>((size >> (8 * i)) & 0xff));
+    }
+
+    return result;
+}
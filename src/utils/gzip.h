@@ -0,0 +1,29 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+#pragma once
+
+#include <QByteArray>
+
+/*  Functions to handle gzip compressed data (without any GUI dependencies) */
+
+namespace Utils
+{
+    namespace Gzip {
+        bool hasGzipHeader(const QByteArray &data);
+        int memberHeaderSize(const QByteArray &data, int offset = 0);
+        QByteArray uncompress(const QByteArray &data);
+        QByteArray compress(const QByteArray &data, int level = 6);
+    }
+}
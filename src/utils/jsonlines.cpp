@@ -0,0 +1,326 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#include <string.h>
+#include "jsonlines.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+    inline int trailingZeros(quint64 value) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctzll(value);
+#endif
+    }
+
+    /**
+     * Returns a mask with the bits from every set bit up to the next set bit
+     * set, used to find the bytes inside of strings from their quotes
+     */
+    inline quint64 prefixXor(quint64 value) {
+        value ^= value << 1;
+        value ^= value << 2;
+        value ^= value << 4;
+        value ^= value << 8;
+        value ^= value << 16;
+        value ^= value << 32;
+        return value;
+    }
+
+    /**
+     * Removes the quotes of a string value and decodes its simple escapes,
+     * other values are returned as they are
+     */
+    QByteArray decodeValue(const char *start, const char *end) {
+        if (end - start < 2 || *start != '"') {
+            return QByteArray(start, static_cast<int>(end - start));
+        }
+
+        start++;
+        end--;
+
+        if (memchr(start, '\\', static_cast<size_t>(end - start)) == NULL) {
+            return QByteArray(start, static_cast<int>(end - start));
+        }
+
+        QByteArray result;
+        result.reserve(static_cast<int>(end - start));
+
+        for (const char *pos = start; pos < end; pos++) {
+            if (*pos != '\\' || pos + 1 >= end) {
+                result.append(*pos);
+                continue;
+            }
+
+            switch (*++pos) {
+                case 'n':
+                    result.append('\n');
+                    break;
+                case 't':
+                    result.append('\t');
+                    break;
+                case 'r':
+                    result.append('\r');
+                    break;
+                default:
+                    result.append(*pos);
+            }
+        }
+
+        return result;
+    }
+
+    /**
+     * Walks over the structural characters of the top level object and calls
+     * a function with the name and the value range of every field until it
+     * returns false
+     */
+    template <typename Function>
+    bool walkFields(const char *line, const QVector<int> &structurals,
+                    Function function) {
+        int count = structurals.count();
+
+        if (count < 2 || line[structurals.at(0)] != '{') {
+            return false;
+        }
+
+        // only spaces may come before the object
+        for (int pos = 0; pos < structurals.at(0); pos++) {
+            if (line[pos] != ' ' && line[pos] != '\t') {
+                return false;
+            }
+        }
+
+        int i = 1;
+
+        while (i < count) {
+            // the name of the field
+            if (line[structurals.at(i)] == '}') {
+                return true;
+            }
+
+            if (i + 2 >= count || line[structurals.at(i)] != '"' ||
+                    line[structurals.at(i + 1)] != '"' ||
+                    line[structurals.at(i + 2)] != ':') {
+                return false;
+            }
+
+            const char *nameStart = line + structurals.at(i) + 1;
+            const char *nameEnd = line + structurals.at(i + 1);
+            int colon = structurals.at(i + 2);
+            i += 3;
+
+            // the value ends before the next ',' or '}' of the top level
+            // object
+            int depth = 0;
+
+            while (i < count) {
+                char c = line[structurals.at(i)];
+
+                if (c == '{' || c == '[') {
+                    depth++;
+                } else if (c == ']' || (c == '}' && depth > 0)) {
+                    depth--;
+                } else if (depth == 0 && (c == ',' || c == '}')) {
+                    break;
+                }
+
+                i++;
+            }
+
+            if (i >= count) {
+                return false;
+            }
+
+            const char *valueStart = line + colon + 1;
+            const char *valueEnd = line + structurals.at(i);
+
+            while (valueStart < valueEnd &&
+                    (*valueStart == ' ' || *valueStart == '\t')) {
+                valueStart++;
+            }
+
+            while (valueEnd > valueStart &&
+                    (valueEnd[-1] == ' ' || valueEnd[-1] == '\t')) {
+                valueEnd--;
+            }
+
+            if (!function(nameStart, nameEnd, valueStart, valueEnd)) {
+                return true;
+            }
+
+            // skip the ','
+            if (line[structurals.at(i)] == ',') {
+                i++;
+            }
+        }
+
+        return false;
+    }
+}
+
+/**
+ * Finds the structural characters ({}[]:,) outside of strings and the
+ * quotes of the strings of a line
+ *
+ * Every 64 bytes get masks with a bit per byte for backslashes, quotes and
+ * structural characters. The quotes that aren't escaped are turned into a
+ * mask of the bytes inside of strings with a prefix xor, so the characters
+ * inside of strings are removed without looking at the bytes again.
+ */
+bool Utils::JsonLines::buildStructuralIndex(const char *line, int length,
+                                            QVector<int> &structurals) {
+    structurals.resize(0);
+
+    // if the previous chunk ended inside of a string or with an escape
+    quint64 inStringCarry = 0;
+    quint64 escapeCarry = 0;
+
+    for (int chunk = 0; chunk < length; chunk += 64) {
+        int chunkLength = qMin(64, length - chunk);
+        const char *data = line + chunk;
+        quint64 backslashes = 0;
+        quint64 quotes = 0;
+        quint64 operators = 0;
+
+        for (int i = 0; i < chunkLength; i++) {
+            quint64 bit = Q_UINT64_C(1) << i;
+
+            switch (data[i]) {
+                case '\\':
+                    backslashes |= bit;
+                    break;
+                case '"':
+                    quotes |= bit;
+                    break;
+                case '{':
+                case '}':
+                case '[':
+                case ']':
+                case ':':
+                case ',':
+                    operators |= bit;
+                    break;
+            }
+        }
+
+        // find the escaped characters, a backslash that isn't escaped
+        // escapes the next character
+        quint64 escaped = escapeCarry;
+        quint64 remainingBackslashes = backslashes & ~escapeCarry;
+        escapeCarry = 0;
+
+        while (remainingBackslashes != 0) {
+            int index = trailingZeros(remainingBackslashes);
+
+            if (index == 63) {
+                escapeCarry = 1;
+                break;
+            }
+
+            quint64 next = Q_UINT64_C(1) << (index + 1);
+            escaped |= next;
+            remainingBackslashes &= ~((next << 1) - 1);
+        }
+
+        quotes &= ~escaped;
+
+        quint64 inString = prefixXor(quotes) ^ inStringCarry;
+        inStringCarry = (inString >> 63) != 0 ? ~Q_UINT64_C(0) : 0;
+
+        // the closing quotes are outside of the string mask, the opening
+        // quotes inside, both are kept
+        quint64 mask = (operators & ~inString) | quotes;
+
+        while (mask != 0) {
+            structurals.append(chunk + trailingZeros(mask));
+            mask &= mask - 1;
+        }
+    }
+
+    // an unterminated string
+    return inStringCarry == 0;
+}
+
+/**
+ * Returns the value of a top level field, string values are returned
+ * without their quotes
+ */
+bool Utils::JsonLines::findField(const char *line,
+                                 const QVector<int> &structurals,
+                                 const QByteArray &name, QByteArray &value) {
+    bool found = false;
+
+    walkFields(line, structurals,
+               [&](const char *nameStart, const char *nameEnd,
+                   const char *valueStart, const char *valueEnd) {
+                   if (nameEnd - nameStart != name.size() ||
+                           memcmp(nameStart, name.constData(),
+                                  static_cast<size_t>(name.size())) != 0) {
+                       return true;
+                   }
+
+                   value = decodeValue(valueStart, valueEnd);
+                   found = true;
+                   return false;
+               });
+
+    return found;
+}
+
+/**
+ * Returns the names and values of all top level fields
+ */
+bool Utils::JsonLines::fields(const char *line,
+                              const QVector<int> &structurals,
+                              QVector<QByteArray> &names,
+                              QVector<QByteArray> &values) {
+    names.resize(0);
+    values.resize(0);
+
+    return walkFields(
+            line, structurals,
+            [&](const char *nameStart, const char *nameEnd,
+                const char *valueStart, const char *valueEnd) {
+                names.append(QByteArray(
+                        nameStart, static_cast<int>(nameEnd - nameStart)));
+                values.append(decodeValue(valueStart, valueEnd));
+                return true;
+            });
+}
+
+/**
+ * Returns the value of a top level field of a line
+ */
+QByteArray Utils::JsonLines::field(const char *line, int length,
+                                   const QByteArray &name, bool *ok) {
+    QVector<int> structurals;
+    QByteArray value;
+
+    bool found = buildStructuralIndex(line, length, structurals) &&
+            findField(line, structurals, name, value);
+
+    if (ok != NULL) {
+        *ok = found;
+    }
+
+    return value;
+}
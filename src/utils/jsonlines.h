@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#pragma once
+
+#include <QByteArray>
+#include <QVector>
+
+/*  Functions to extract fields from JSON lines without building a document
+ *  (without any GUI dependencies)
+ *
+ *  Like simdjson the work is split into two stages. The first stage finds
+ *  the positions of the structural characters of a line outside of
+ *  strings, 64 bytes at a time with bit masks. The second stage only walks
+ *  these positions to find the requested top level fields, values are
+ *  only copied for fields that are requested.
+ */
+
+namespace Utils
+{
+    namespace JsonLines {
+        bool buildStructuralIndex(const char *line, int length,
+                                  QVector<int> &structurals);
+        bool findField(const char *line, const QVector<int> &structurals,
+                       const QByteArray &name, QByteArray &value);
+        bool fields(const char *line, const QVector<int> &structurals,
+                    QVector<QByteArray> &names, QVector<QByteArray> &values);
+        QByteArray field(const char *line, int length,
+                         const QByteArray &name, bool *ok = NULL);
+    }
+}
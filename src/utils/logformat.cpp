@@ -0,0 +1,294 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#include <QObject>
+#include "logformat.h"
+#include "jsonlines.h"
+
+// number of lines that are used to detect the format
+#define LOG_FORMAT_DETECT_LINE_COUNT 20
+
+namespace {
+    /**
+     * A tokenizer that moves through a line without copying it
+     */
+    class Tokenizer {
+    public:
+        Tokenizer(const char *line, int length) {
+            pos = line;
+            end = line + length;
+
+            // the line break isn't part of the last field
+            while (end > pos && (end[-1] == '\n' || end[-1] == '\r')) {
+                end--;
+            }
+        }
+
+        bool atEnd() {
+            return pos >= end;
+        }
+
+        void skipSpaces() {
+            while (pos < end && *pos == ' ') {
+                pos++;
+            }
+        }
+
+        /**
+         * Returns the text up to the next space
+         */
+        QByteArray word() {
+            skipSpaces();
+            const char *start = pos;
+
+            while (pos < end && *pos != ' ') {
+                pos++;
+            }
+
+            return QByteArray(start, static_cast<int>(pos - start));
+        }
+
+        /**
+         * Returns the text up to a delimiter and skips the delimiter, false
+         * is returned if there is no delimiter
+         */
+        bool until(char delimiter, QByteArray &result) {
+            const char *start = pos;
+
+            while (pos < end && *pos != delimiter) {
+                // skip escaped characters in quoted text
+                if (*pos == '\\' && delimiter == '"' && pos + 1 < end) {
+                    pos++;
+                }
+
+                pos++;
+            }
+
+            if (pos >= end) {
+                return false;
+            }
+
+            result = QByteArray(start, static_cast<int>(pos - start));
+            pos++;
+            return true;
+        }
+
+        /**
+         * Returns the text that is enclosed by two characters
+         */
+        bool enclosed(char open, char close, QByteArray &result) {
+            skipSpaces();
+
+            if (pos >= end || *pos != open) {
+                return false;
+            }
+
+            pos++;
+            return until(close, result);
+        }
+
+        QByteArray rest() {
+            skipSpaces();
+            QByteArray result(pos, static_cast<int>(end - pos));
+            pos = end;
+            return result;
+        }
+
+        bool expect(char c) {
+            skipSpaces();
+
+            if (pos < end && *pos == c) {
+                pos++;
+                return true;
+            }
+
+            return false;
+        }
+
+        const char *pos;
+        const char *end;
+    };
+
+    /**
+     * Parses the combined log format of Apache and nginx
+     * host ident user [time] "method path protocol" status size "referer"
+     * "user agent"
+     */
+    bool parseCombined(Tokenizer &tokenizer, QVector<QByteArray> &values) {
+        values.resize(11);
+        values[0] = tokenizer.word();
+        values[1] = tokenizer.word();
+        values[2] = tokenizer.word();
+
+        QByteArray request;
+
+        if (!tokenizer.enclosed('[', ']', values[3]) ||
+                !tokenizer.enclosed('"', '"', request)) {
+            return false;
+        }
+
+        Tokenizer requestTokenizer(request.constData(), request.size());
+        values[4] = requestTokenizer.word();
+        values[5] = requestTokenizer.word();
+        values[6] = requestTokenizer.word();
+        values[7] = tokenizer.word();
+        values[8] = tokenizer.word();
+
+        // the referer and the user agent are missing in the common log
+        // format, the values of a previous line must not be kept
+        values[9].clear();
+        values[10].clear();
+        tokenizer.enclosed('"', '"', values[9]);
+        tokenizer.enclosed('"', '"', values[10]);
+
+        return !values[0].isEmpty() && values[7].size() == 3;
+    }
+
+    /**
+     * Parses "Jun 14 11:02:33 host program[pid]: message"
+     */
+    bool parseSyslog(Tokenizer &tokenizer, QVector<QByteArray> &values) {
+        values.resize(5);
+
+        if (tokenizer.end - tokenizer.pos < 16 || tokenizer.pos[3] != ' ' ||
+                tokenizer.pos[9] != ':' || tokenizer.pos[12] != ':') {
+            return false;
+        }
+
+        values[0] = QByteArray(tokenizer.pos, 15);
+        tokenizer.pos += 15;
+        values[1] = tokenizer.word();
+        tokenizer.skipSpaces();
+
+        const char *start = tokenizer.pos;
+
+        while (tokenizer.pos < tokenizer.end && *tokenizer.pos != '[' &&
+                *tokenizer.pos != ':' && *tokenizer.pos != ' ') {
+            tokenizer.pos++;
+        }
+
+        values[2] = QByteArray(start,
+                               static_cast<int>(tokenizer.pos - start));
+        values[3].clear();
+
+        if (tokenizer.pos < tokenizer.end && *tokenizer.pos == '[') {
+            tokenizer.pos++;
+            tokenizer.until(']', values[3]);
+        }
+
+        tokenizer.expect(':');
+        values[4] = tokenizer.rest();
+
+        return !values[1].isEmpty() && !values[2].isEmpty();
+    }
+}
+
+/**
+ * Returns the format most of the first lines of a sample can be parsed with
+ */
+Utils::LogFormat::Format Utils::LogFormat::detect(const QByteArray &sample) {
+    Format formats[] = {CombinedFormat, SyslogFormat, JsonLinesFormat};
+    Format bestFormat = UnknownFormat;
+    int bestCount = 0;
+    QVector<QByteArray> values;
+    QVector<QByteArray> names;
+
+    for (int i = 0; i < 3; i++) {
+        int count = 0;
+        int pos = 0;
+
+        for (int line = 0; line < LOG_FORMAT_DETECT_LINE_COUNT &&
+                pos < sample.size(); line++) {
+            int end = sample.indexOf('\n', pos);
+            end = end == -1 ? sample.size() : end + 1;
+
+            if (parseLine(formats[i], sample.constData() + pos, end - pos,
+                          values, names)) {
+                count++;
+            }
+
+            pos = end;
+        }
+
+        if (count > bestCount) {
+            bestCount = count;
+            bestFormat = formats[i];
+        }
+    }
+
+    return bestFormat;
+}
+
+QString Utils::LogFormat::formatName(Format format) {
+    switch (format) {
+        case CombinedFormat:
+            return QObject::tr("Apache / nginx combined log");
+        case SyslogFormat:
+            return QObject::tr("Syslog");
+        case JsonLinesFormat:
+            return QObject::tr("JSON lines");
+        default:
+            return QObject::tr("Unknown");
+    }
+}
+
+/**
+ * Returns the names of the fields of a format, the fields of JSON lines
+ * are named by the lines
+ */
+QStringList Utils::LogFormat::fieldNames(Format format) {
+    switch (format) {
+        case CombinedFormat:
+            return QStringList() << "host" << "ident" << "user" << "time" <<
+                    "method" << "path" << "protocol" << "status" <<
+                    "size" << "referer" << "user_agent";
+        case SyslogFormat:
+            return QStringList() << "time" << "host" << "program" <<
+                    "pid" << "message";
+        default:
+            return QStringList();
+    }
+}
+
+/**
+ * Splits a line into the values of its fields
+ *
+ * For JSON lines the names of the fields are returned too, false is
+ * returned if the line doesn't have the format.
+ */
+bool Utils::LogFormat::parseLine(Format format, const char *line,
+                                 int length, QVector<QByteArray> &values,
+                                 QVector<QByteArray> &names) {
+    Tokenizer tokenizer(line, length);
+
+    if (tokenizer.atEnd()) {
+        return false;
+    }
+
+    switch (format) {
+        case CombinedFormat:
+            return parseCombined(tokenizer, values);
+        case SyslogFormat:
+            return parseSyslog(tokenizer, values);
+        case JsonLinesFormat: {
+            QVector<int> structurals;
+            return Utils::JsonLines::buildStructuralIndex(
+                    line, length, structurals) &&
+                    Utils::JsonLines::fields(line, structurals, names, values);
+        }
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#pragma once
+
+#include <QByteArray>
+#include <QStringList>
+#include <QVector>
+
+/*  Functions to split the lines of common log formats into fields (without
+ *  any GUI dependencies)
+ */
+
+namespace Utils
+{
+    namespace LogFormat {
+        enum Format {
+            UnknownFormat = 0,
+            CombinedFormat,
+            SyslogFormat,
+            JsonLinesFormat
+        };
+
+        Format detect(const QByteArray &sample);
+        QString formatName(Format format);
+        QStringList fieldNames(Format format);
+        bool parseLine(Format format, const char *line, int length,
+                       QVector<QByteArray> &values,
+                       QVector<QByteArray> &names);
+    }
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#include <QDir>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QPair>
+#include <algorithm>
+#include "logrotation.h"
+
+namespace {
+    /**
+     * Matches the base name of the family, the rotation suffix like ".1",
+     * "-20160614" or "-2016-06-14" and the compression suffix
+     */
+    const QRegularExpression &rotationExpression() {
+        static const QRegularExpression expression(
+                "^(.+?)(?:[.-](\\d{4}-\\d{2}-\\d{2}|\\d+))?(\\.gz)?$");
+        return expression;
+    }
+
+    /**
+     * Returns a key to sort the members of a family from the oldest to the
+     * newest file
+     *
+     * Compressed files without rotation suffix are the oldest, because
+     * their age isn't known. They are followed by the dated files by date
+     * and the numbered files from the highest to the lowest number, the
+     * active log file is the newest.
+     */
+    QPair<int, qint64> rotationSortKey(const QString &fileName) {
+        QRegularExpressionMatch match =
+                rotationExpression().match(fileName);
+        QString suffix = match.captured(2);
+
+        if (suffix.isEmpty()) {
+            return match.captured(3).isEmpty() ?
+                   qMakePair(3, Q_INT64_C(0)) : qMakePair(0, Q_INT64_C(0));
+        }
+
+        // date suffixes like 20160614 or 2016-06-14
+        if (suffix.length() >= 8) {
+            return qMakePair(1, suffix.remove('-').toLongLong());
+        }
+
+        return qMakePair(2, -suffix.toLongLong());
+    }
+}
+
+/**
+ * Checks if a path addresses a family of rotated log files
+ */
+bool Utils::LogRotation::isFamilyPath(const QString &path) {
+    return path.endsWith("*");
+}
+
+/**
+ * Returns the path of the family of a log file
+ */
+QString Utils::LogRotation::familyPath(const QString &filePath) {
+    QFileInfo fileInfo(filePath);
+    return fileInfo.absolutePath() + QDir::separator() +
+           baseName(fileInfo.fileName()) + "*";
+}
+
+/**
+ * Returns the name of the active log file of a rotated log file, the file
+ * name itself if it has no rotation suffix
+ */
+QString Utils::LogRotation::baseName(const QString &fileName) {
+    return rotationExpression().match(fileName).captured(1);
+}
+
+/**
+ * Checks if a member of a family was rotated before another one
+ *
+ * Members with the same rotation suffix, like "error.log.1" and
+ * "error.log.1.gz", are ordered by their names, so the order is total.
+ */
+bool Utils::LogRotation::isOlder(const QString &fileName1,
+                                 const QString &fileName2) {
+    QPair<int, qint64> key1 = rotationSortKey(fileName1);
+    QPair<int, qint64> key2 = rotationSortKey(fileName2);
+
+    return key1 < key2 || (key1 == key2 && fileName1 < fileName2);
+}
+
+/**
+ * Groups file names by the base name of their family, the members are
+ * sorted from the oldest to the newest file
+ */
+QMap<QString, QStringList> Utils::LogRotation::families(
+        const QStringList &fileNames) {
+    QMap<QString, QStringList> result;
+
+    Q_FOREACH(QString fileName, fileNames) {
+            QString name = baseName(fileName);
+
+            if (!name.isEmpty()) {
+                result[name].append(fileName);
+            }
+        }
+
+    QMutableMapIterator<QString, QStringList> iterator(result);
+    while (iterator.hasNext()) {
+        iterator.next();
+        std::sort(iterator.value().begin(), iterator.value().end(), isOlder);
+    }
+
+    return result;
+}
+
+/**
+ * Returns the paths of the members of a family from the oldest to the
+ * newest file
+ */
+QStringList Utils::LogRotation::memberPaths(const QString &familyPath) {
+    QString path = familyPath;
+    path.chop(1);
+
+    QFileInfo fileInfo(path);
+    QDir dir = fileInfo.absoluteDir();
+    QString name = fileInfo.fileName();
+
+    QStringList fileNames = dir.entryList(
+            QStringList() << name + "*", QDir::Files, QDir::Name);
+    QStringList memberPaths;
+
+    Q_FOREACH(QString fileName, families(fileNames).value(name)) {
+            memberPaths.append(dir.absolutePath() + QDir::separator() +
+                               fileName);
+        }
+
+    return memberPaths;
+}
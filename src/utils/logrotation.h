@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QMap>
+
+/*  Functions to handle families of rotated log files like "error.log",
+ *  "error.log.1" and "error.log.2.gz" or "syslog" and "syslog-20160614"
+ *  (without any GUI dependencies)
+ *
+ *  A family is addressed by the path of its active log file with a "*"
+ *  appended, like "/var/log/apache2/error.log*".
+ */
+
+namespace Utils
+{
+    namespace LogRotation {
+        bool isFamilyPath(const QString &path);
+        QString familyPath(const QString &filePath);
+        QString baseName(const QString &fileName);
+        bool isOlder(const QString &fileName1, const QString &fileName2);
+        QMap<QString, QStringList> families(const QStringList &fileNames);
+        QStringList memberPaths(const QString &familyPath);
+    }
+}
@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+#include <string.h>
+#include "timestamp.h"
+
+// only the start of a line is searched for a timestamp
+#define TIMESTAMP_SEARCH_LENGTH 64
+
+namespace {
+    inline bool isDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    inline bool isAlphaNumeric(char c) {
+        return isDigit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    }
+
+    inline int digits(const char *p, int count) {
+        int value = 0;
+
+        for (int i = 0; i < count; i++) {
+            if (!isDigit(p[i])) {
+                return -1;
+            }
+
+            value = value * 10 + (p[i] - '0');
+        }
+
+        return value;
+    }
+
+    /**
+     * Returns the month (1-12) of an english three letter month name
+     */
+    int month(const char *p) {
+        static const char names[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+        for (int i = 0; i < 12; i++) {
+            if (memcmp(p, names + i * 3, 3) == 0) {
+                return i + 1;
+            }
+        }
+
+        return -1;
+    }
+
+    /**
+     * Returns the days since 1970-01-01 of a date of the proleptic
+     * gregorian calendar
+     */
+    qint64 daysFromCivil(int year, int month, int day) {
+        year -= month <= 2 ? 1 : 0;
+        const int era = (year >= 0 ? year : year - 399) / 400;
+        const int yearOfEra = year - era * 400;
+        const int dayOfYear =
+                (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        const int dayOfEra = yearOfEra * 365 + yearOfEra / 4 -
+                yearOfEra / 100 + dayOfYear;
+
+        return static_cast<qint64>(era) * 146097 + dayOfEra - 719468;
+    }
+
+    qint64 toTimestamp(int year, int month, int day, const char *time) {
+        int hour = digits(time, 2);
+        int minute = digits(time + 3, 2);
+        int second = digits(time + 6, 2);
+
+        if (year < 0 || month < 1 || month > 12 || day < 1 || day > 31 ||
+                time[2] != ':' || time[5] != ':' ||
+                hour < 0 || hour > 23 || minute < 0 || minute > 59 ||
+                second < 0 || second > 60) {
+            return Utils::Timestamp::Invalid;
+        }
+
+        return ((daysFromCivil(year, month, day) * 24 + hour) * 60 +
+                minute) * 60000 + second * 1000;
+    }
+
+    /**
+     * Returns the milliseconds of a fraction of a second like ".123"
+     */
+    int milliseconds(const char *p, int length) {
+        if (length < 2 || (p[0] != '.' && p[0] != ',') || !isDigit(p[1])) {
+            return 0;
+        }
+
+        int value = 0;
+        int factor = 100;
+
+        for (int i = 1; i < length && isDigit(p[i]) && factor > 0; i++) {
+            value += (p[i] - '0') * factor;
+            factor /= 10;
+        }
+
+        return value;
+    }
+
+    /**
+     * Parses "2016-06-14T11:02:33" or "2016-06-14 11:02:33"
+     */
+    qint64 parseIso(const char *p, int length) {
+        if (length < 19 || p[4] != '-' || p[7] != '-' ||
+                (p[10] != 'T' && p[10] != ' ')) {
+            return Utils::Timestamp::Invalid;
+        }
+
+        qint64 timestamp = toTimestamp(digits(p, 4), digits(p + 5, 2),
+                                       digits(p + 8, 2), p + 11);
+
+        return timestamp == Utils::Timestamp::Invalid ?
+               timestamp : timestamp + milliseconds(p + 19, length - 19);
+    }
+
+    /**
+     * Parses "14/Jun/2016:11:02:33" of the Apache and nginx access logs
+     */
+    qint64 parseApache(const char *p, int length) {
+        if (length < 20 || p[2] != '/' || p[6] != '/' || p[11] != ':') {
+            return Utils::Timestamp::Invalid;
+        }
+
+        return toTimestamp(digits(p + 7, 4), month(p + 3), digits(p, 2),
+                           p + 12);
+    }
+
+    /**
+     * Parses "Jun 14 2016 11:02:33" of eZ Publish logs and
+     * "Jun 14 11:02:33" of syslog, syslog lines get the current year
+     */
+    qint64 parseMonthName(const char *p, int length) {
+        if (length < 15 || p[3] != ' ' || p[6] != ' ') {
+            return Utils::Timestamp::Invalid;
+        }
+
+        int monthNumber = month(p);
+        int day = p[4] == ' ' ? digits(p + 5, 1) : digits(p + 4, 2);
+
+        if (length >= 20 && p[11] == ' ' && isDigit(p[7])) {
+            return toTimestamp(digits(p + 7, 4), monthNumber, day, p + 12);
+        }
+
+        static const int currentYear = QDate::currentDate().year();
+        return toTimestamp(currentYear, monthNumber, day, p + 7);
+    }
+}
+
+/**
+ * Returns the timestamp at the start of a log line
+ *
+ * ISO 8601 dates, the dates of Apache and nginx access logs, syslog dates
+ * and the "[ Jun 14 2016 11:02:33 ]" dates of eZ Publish are detected.
+ * Only the first bytes of the line are checked at word boundaries with fixed
+ * offset comparisons, so no regular expressions are needed.
+ */
+qint64 Utils::Timestamp::parse(const char *line, int length) {
+    int searchLength = qMin(length, TIMESTAMP_SEARCH_LENGTH);
+
+    for (int i = 0; i < searchLength; i++) {
+        char c = line[i];
+
+        if (c == '\n') {
+            break;
+        }
+
+        if (i > 0 && isAlphaNumeric(line[i - 1])) {
+            continue;
+        }
+
+        const char *p = line + i;
+        int remaining = length - i;
+        qint64 timestamp = Invalid;
+
+        if (isDigit(c)) {
+            timestamp = remaining > 2 && isDigit(p[1]) && p[2] == '/' ?
+                        parseApache(p, remaining) : parseIso(p, remaining);
+        } else if (c >= 'A' && c <= 'Z') {
+            timestamp = parseMonthName(p, remaining);
+        }
+
+        if (timestamp != Invalid) {
+            return timestamp;
+        }
+    }
+
+    return Invalid;
+}
+
+qint64 Utils::Timestamp::parse(const QByteArray &line) {
+    return parse(line.constData(), line.size());
+}
+
+QDateTime Utils::Timestamp::toDateTime(qint64 timestamp) {
+    if (timestamp == Invalid) {
+        return QDateTime();
+    }
+
+    return QDateTime::fromMSecsSinceEpoch(timestamp, Qt::UTC);
+}
+
+/**
+ * Returns the timestamp of the wall clock time of a date time
+ */
+qint64 Utils::Timestamp::fromDateTime(const QDateTime &dateTime) {
+    if (!dateTime.isValid()) {
+        return Invalid;
+    }
+
+    QDateTime wallClockTime(dateTime.date(), dateTime.time(), Qt::UTC);
+    return wallClockTime.toMSecsSinceEpoch();
+}
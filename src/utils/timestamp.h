@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QDateTime>
+
+/*  Functions to find the timestamps of log lines (without any GUI
+ *  dependencies)
+ *
+ *  Timestamps are the milliseconds of the wall clock time of the log line
+ *  since the epoch, time zone offsets are ignored.
+ */
+
+namespace Utils
+{
+    namespace Timestamp {
+        // returned if a line has no timestamp
+        const qint64 Invalid = -1;
+
+        qint64 parse(const char *line, int length);
+        qint64 parse(const QByteArray &line);
+        QDateTime toDateTime(qint64 timestamp);
+        qint64 fromDateTime(const QDateTime &dateTime);
+    }
+}
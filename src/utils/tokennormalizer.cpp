@@ -0,0 +1,292 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#include "tokennormalizer.h"
+
+namespace {
+    enum CharacterClass {
+        DigitClass = 1,
+        HexLetterClass = 2,
+        WordClass = 4
+    };
+
+    /**
+     * Returns a table of the classes of the ASCII characters
+     */
+    const unsigned char *characterClasses() {
+        static unsigned char classes[128];
+
+        for (int c = 0; c < 128; c++) {
+            unsigned char characterClass = 0;
+
+            if (c >= '0' && c <= '9') {
+                characterClass |= DigitClass | WordClass;
+            } else if ((c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F')) {
+                characterClass |= HexLetterClass | WordClass;
+            } else if ((c >= 'g' && c <= 'z') || (c >= 'G' && c <= 'Z') ||
+                    c == '_') {
+                characterClass |= WordClass;
+            }
+
+            classes[c] = characterClass;
+        }
+
+        return classes;
+    }
+
+    // the table is built at startup, before any worker threads use it
+    const unsigned char *classes = characterClasses();
+
+    inline ushort code(char c) {
+        return static_cast<uchar>(c);
+    }
+
+    inline ushort code(QChar c) {
+        return c.unicode();
+    }
+
+    template <typename Char>
+    inline bool hasClass(const Char *data, int length, int pos, int mask) {
+        if (pos >= length) {
+            return false;
+        }
+
+        ushort c = code(data[pos]);
+        return c < 128 && (classes[c] & mask) != 0;
+    }
+
+    /**
+     * Returns if a token ends at a position, letters and digits would
+     * continue it
+     */
+    template <typename Char>
+    inline bool isTokenEnd(const Char *data, int length, int pos) {
+        return !hasClass(data, length, pos, WordClass);
+    }
+
+    template <typename Char>
+    int matchDigits(const Char *data, int length, int pos, int maxCount) {
+        int end = pos;
+
+        while (end - pos < maxCount && hasClass(data, length, end, DigitClass)) {
+            end++;
+        }
+
+        return end - pos;
+    }
+
+    /**
+     * Returns the end of a UUID like 123e4567-e89b-12d3-a456-426614174000
+     * at a position or 0
+     */
+    template <typename Char>
+    int matchUuid(const Char *data, int length, int pos) {
+        static const int groupLengths[] = {8, 4, 4, 4, 12};
+
+        for (int group = 0; group < 5; group++) {
+            if (group > 0) {
+                if (pos >= length || code(data[pos]) != '-') {
+                    return 0;
+                }
+
+                pos++;
+            }
+
+            for (int i = 0; i < groupLengths[group]; i++, pos++) {
+                if (!hasClass(data, length, pos, DigitClass | HexLetterClass)) {
+                    return 0;
+                }
+            }
+        }
+
+        return isTokenEnd(data, length, pos) ? pos : 0;
+    }
+
+    /**
+     * Returns the end of an IPv4 address at a position or 0
+     */
+    template <typename Char>
+    int matchIpv4(const Char *data, int length, int pos) {
+        for (int part = 0; part < 4; part++) {
+            if (part > 0) {
+                if (pos >= length || code(data[pos]) != '.') {
+                    return 0;
+                }
+
+                pos++;
+            }
+
+            int count = matchDigits(data, length, pos, 3);
+
+            if (count == 0) {
+                return 0;
+            }
+
+            pos += count;
+        }
+
+        return isTokenEnd(data, length, pos) ? pos : 0;
+    }
+
+    /**
+     * Returns the end of a hex id at a position or 0, hex ids start with 0x
+     * or have at least 8 hex digits with digits and letters
+     */
+    template <typename Char>
+    int matchHex(const Char *data, int length, int pos) {
+        int end = pos;
+
+        if (pos + 2 < length && code(data[pos]) == '0' &&
+                (code(data[pos + 1]) == 'x' || code(data[pos + 1]) == 'X') &&
+                hasClass(data, length, pos + 2,
+                         DigitClass | HexLetterClass)) {
+            end = pos + 2;
+
+            while (hasClass(data, length, end, DigitClass | HexLetterClass)) {
+                end++;
+            }
+
+            return isTokenEnd(data, length, end) ? end : 0;
+        }
+
+        bool hasDigit = false;
+        bool hasLetter = false;
+
+        while (hasClass(data, length, end, DigitClass | HexLetterClass)) {
+            if (hasClass(data, length, end, DigitClass)) {
+                hasDigit = true;
+            } else {
+                hasLetter = true;
+            }
+
+            end++;
+        }
+
+        return end - pos >= 8 && hasDigit && hasLetter &&
+               isTokenEnd(data, length, end) ? end : 0;
+    }
+
+    /**
+     * Returns the end of a number with optional decimals at a position
+     */
+    template <typename Char>
+    int matchNumber(const Char *data, int length, int pos) {
+        int end = pos + matchDigits(data, length, pos, length);
+
+        while (end + 1 < length && code(data[end]) == '.' &&
+                hasClass(data, length, end + 1, DigitClass)) {
+            end += 1 + matchDigits(data, length, end + 1, length);
+        }
+
+        return end;
+    }
+
+    inline void appendRun(QByteArray &output, const char *data, int length) {
+        output.append(data, length);
+    }
+
+    inline void appendRun(QString &output, const QChar *data, int length) {
+        output.append(data, length);
+    }
+
+    inline void appendPlaceholder(QByteArray &output,
+                                  const char *placeholder) {
+        output.append(placeholder);
+    }
+
+    inline void appendPlaceholder(QString &output, const char *placeholder) {
+        output.append(QLatin1String(placeholder));
+    }
+
+    /**
+     * Replaces the volatile tokens of a text in a single pass
+     *
+     * Only digits and hex letters can start a token, the runs of the other
+     * characters are looked up in a table and copied at once.
+     */
+    template <typename Char, typename Output>
+    void normalizeText(const Char *data, int length, Output &output) {
+        int runStart = 0;
+        int pos = 0;
+
+        while (pos < length) {
+            if (!hasClass(data, length, pos, DigitClass | HexLetterClass)) {
+                pos++;
+                continue;
+            }
+
+            // UUIDs, IPs and hex ids only start at the start of a word
+            bool atWordStart = pos == 0 ||
+                    !hasClass(data, length, pos - 1, WordClass);
+            const char *placeholder = NULL;
+            int end = 0;
+
+            if (atWordStart) {
+                if ((end = matchUuid(data, length, pos)) > 0) {
+                    placeholder = "<uuid>";
+                } else if ((end = matchIpv4(data, length, pos)) > 0) {
+                    placeholder = "<ip>";
+                } else if ((end = matchHex(data, length, pos)) > 0) {
+                    placeholder = "<hex>";
+                }
+            }
+
+            // numbers are also replaced inside of words, like in "node12"
+            if (placeholder == NULL &&
+                    hasClass(data, length, pos, DigitClass)) {
+                end = matchNumber(data, length, pos);
+                placeholder = "<num>";
+            }
+
+            if (placeholder == NULL) {
+                // skip the rest of the word
+                while (hasClass(data, length, pos, HexLetterClass)) {
+                    pos++;
+                }
+
+                continue;
+            }
+
+            appendRun(output, data + runStart, pos - runStart);
+            appendPlaceholder(output, placeholder);
+            pos = end;
+            runStart = end;
+        }
+
+        appendRun(output, data + runStart, length - runStart);
+    }
+}
+
+/**
+ * Returns a text with its numbers, hex ids, UUIDs and IP addresses replaced
+ * by placeholders
+ */
+QString Utils::TokenNormalizer::normalize(const QString &text) {
+    QString result;
+    result.reserve(text.length());
+    normalizeText(text.constData(), text.length(), result);
+    return result;
+}
+
+QByteArray Utils::TokenNormalizer::normalize(const QByteArray &text) {
+    return normalize(text.constData(), text.size());
+}
+
+QByteArray Utils::TokenNormalizer::normalize(const char *text, int length) {
+    QByteArray result;
+    result.reserve(length);
+    normalizeText(text, length, result);
+    return result;
+}
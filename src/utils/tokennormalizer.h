@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+/*  Functions to replace volatile tokens like numbers, hex ids, UUIDs and IP
+ *  addresses with placeholders (without any GUI dependencies)
+ *
+ *  Texts that only differ by these tokens are equal after they were
+ *  normalized, like "user 1234 logged in from 10.0.0.1" and "user 99
+ *  logged in from 10.0.0.7" are both "user <num> logged in from <ip>".
+ */
+
+namespace Utils
+{
+    namespace TokenNormalizer {
+        QString normalize(const QString &text);
+        QByteArray normalize(const QByteArray &text);
+        QByteArray normalize(const char *text, int length);
+    }
+}
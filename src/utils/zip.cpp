@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+#include <stdexcept>
+#include <string.h>
+#include <climits>
+#include <QFile>
+#include <QFileInfo>
+#include "zip.h"
+#include "libraries/miniz/miniz.h"
+
+// separates the path of the archive from the name of the member
+#define ZIP_MEMBER_SEPARATOR "!/"
+
+// largest member that can be inflated into a QByteArray
+#define ZIP_MAX_MEMBER_SIZE (INT_MAX - 1024)
+
+namespace {
+    size_t readFromFile(void *opaque, mz_uint64 offset, void *buffer,
+                        size_t size) {
+        QFile *file = static_cast<QFile *>(opaque);
+
+        if (!file->seek(static_cast<qint64>(offset))) {
+            return 0;
+        }
+
+        qint64 readSize = file->read(static_cast<char *>(buffer),
+                                     static_cast<qint64>(size));
+        return readSize < 0 ? 0 : static_cast<size_t>(readSize);
+    }
+
+    size_t appendToByteArray(void *opaque, mz_uint64 offset,
+                             const void *buffer, size_t size) {
+        Q_UNUSED(offset);
+        QByteArray *data = static_cast<QByteArray *>(opaque);
+
+        // the size in the archive could be wrong, returning less than size
+        // stops the extraction
+        if (size > static_cast<size_t>(ZIP_MAX_MEMBER_SIZE - data->size())) {
+            return 0;
+        }
+
+        data->append(static_cast<const char *>(buffer),
+                     static_cast<int>(size));
+        return size;
+    }
+
+    /**
+     * Returns the position of the separator after the path of the archive
+     * in a member path or -1
+     *
+     * Only a separator after an existing file counts, so directories with
+     * "!/" in their name are no archives.
+     */
+    int memberSeparatorIndex(const QString &path) {
+        int index = path.indexOf(ZIP_MEMBER_SEPARATOR);
+
+        while (index != -1) {
+            if (index > 0 && QFileInfo(path.left(index)).isFile()) {
+                return index;
+            }
+
+            index = path.indexOf(ZIP_MEMBER_SEPARATOR, index + 1);
+        }
+
+        return -1;
+    }
+
+    /**
+     * Reads the central directory of an archive, only the parts of the file
+     * that are needed are read, it is never loaded as a whole
+     */
+    class ZipReader {
+    public:
+        explicit ZipReader(QString archivePath) : file(archivePath) {
+            memset(&archive, 0, sizeof(archive));
+
+            if (!file.open(QIODevice::ReadOnly)) {
+                throw std::runtime_error(file.errorString().toStdString());
+            }
+
+            archive.m_pRead = readFromFile;
+            archive.m_pIO_opaque = &file;
+
+            if (!mz_zip_reader_init(&archive,
+                                    static_cast<mz_uint64>(file.size()),
+                                    0)) {
+                throw std::runtime_error("no valid zip archive");
+            }
+        }
+
+        ~ZipReader() {
+            mz_zip_reader_end(&archive);
+        }
+
+        mz_zip_archive archive;
+
+    private:
+        QFile file;
+    };
+}
+
+/**
+ * Checks if a file starts with the magic bytes of a zip archive
+ */
+bool Utils::Zip::isZipFile(QString filePath) {
+    QFile file(filePath);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    return file.read(4) == QByteArray("PK\x03\x04", 4);
+}
+
+/**
+ * Checks if a path points to a member of an existing archive
+ */
+bool Utils::Zip::isMemberPath(QString path) {
+    return memberSeparatorIndex(path) != -1;
+}
+
+QString Utils::Zip::memberPath(QString archivePath, QString memberName) {
+    return archivePath + ZIP_MEMBER_SEPARATOR + memberName;
+}
+
+/**
+ * Returns the path of the archive of a member path or the path itself if it
+ * is no member path
+ */
+QString Utils::Zip::archivePath(QString path) {
+    int index = memberSeparatorIndex(path);
+    return index == -1 ? path : path.left(index);
+}
+
+QString Utils::Zip::memberName(QString path) {
+    int index = memberSeparatorIndex(path);
+    return index == -1 ?
+           QString() : path.mid(index + QString(ZIP_MEMBER_SEPARATOR).size());
+}
+
+/**
+ * Returns the names of all files in an archive
+ *
+ * Throws a std::runtime_error if the archive can't be read.
+ */
+QStringList Utils::Zip::memberNames(QString archivePath) {
+    ZipReader reader(archivePath);
+    QStringList names;
+    mz_uint count = mz_zip_reader_get_num_files(&reader.archive);
+
+    for (mz_uint i = 0; i < count; i++) {
+        mz_zip_archive_file_stat stat;
+
+        if (mz_zip_reader_is_file_a_directory(&reader.archive, i) ||
+                !mz_zip_reader_file_stat(&reader.archive, i, &stat)) {
+            continue;
+        }
+
+        names.append(QString::fromUtf8(stat.m_filename));
+    }
+
+    return names;
+}
+
+/**
+ * Inflates a member of an archive in memory
+ *
+ * The archive is opened separately for every call, so multiple members can
+ * be read in parallel. Throws a std::runtime_error if the member can't be
+ * read or is too large to be held in memory.
+ */
+QByteArray Utils::Zip::readMember(QString archivePath, QString memberName) {
+    ZipReader reader(archivePath);
+    int index = mz_zip_reader_locate_file(
+            &reader.archive, memberName.toUtf8().constData(), NULL,
+            MZ_ZIP_FLAG_CASE_SENSITIVE);
+
+    mz_zip_archive_file_stat stat;
+
+    if (index < 0 ||
+            !mz_zip_reader_file_stat(&reader.archive,
+                                     static_cast<mz_uint>(index), &stat)) {
+        throw std::runtime_error("member not found in zip archive");
+    }
+
+    if (stat.m_uncomp_size > static_cast<mz_uint64>(ZIP_MAX_MEMBER_SIZE)) {
+        throw std::runtime_error("zip archive member is too large");
+    }
+
+    QByteArray data;
+    data.reserve(static_cast<int>(stat.m_uncomp_size));
+
+    if (!mz_zip_reader_extract_to_callback(
+            &reader.archive, static_cast<mz_uint>(index), appendToByteArray,
+            &data, 0)) {
+        throw std::runtime_error("error inflating zip archive member");
+    }
+
+    return data;
+}
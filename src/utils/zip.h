@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2016 Patrizio Bekerle -- http://www.bekerle.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+/*  Functions to read zip archives (without any GUI dependencies)
+ *
+ *  A member of an archive is addressed with a path like
+ *  `/path/bundle.zip!/logs/error.log`
+ */
+
+namespace Utils
+{
+    namespace Zip {
+        bool isZipFile(QString filePath);
+        bool isMemberPath(QString path);
+        QString memberPath(QString archivePath, QString memberName);
+        QString archivePath(QString path);
+        QString memberName(QString path);
+        QStringList memberNames(QString archivePath);
+        QByteArray readMember(QString archivePath, QString memberName);
+    }
+}